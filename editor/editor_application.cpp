@@ -10,6 +10,7 @@
 #include "rootex/framework/systems/script_system.h"
 #include "rootex/framework/systems/physics_system.h"
 #include "rootex/framework/systems/audio_system.h"
+#include "rootex/framework/systems/spatial_audio_system.h"
 #include "rootex/framework/systems/input_system.h"
 #include "rootex/framework/systems/player_system.h"
 
@@ -61,6 +62,7 @@ void EditorApplication::setGameMode(bool enabled)
 {
 	PhysicsSystem::GetSingleton()->setActive(enabled);
 	AudioSystem::GetSingleton()->setActive(enabled);
+	SpatialAudioSystem::GetSingleton()->setActive(enabled);
 	ScriptSystem::GetSingleton()->setActive(enabled);
 	PlayerSystem::GetSingleton()->setActive(enabled);
 	RenderSystem::GetSingleton()->setIsEditorRenderPass(!enabled);
@@ -2,10 +2,15 @@
 
 #include "core/random.h"
 #include "core/renderer/rendering_device.h"
+#include "core/cooked_cache.h"
 #include "core/resource_loader.h"
 #include "core/resource_files/lua_text_resource_file.h"
+#include "core/resource_files/collision_model_resource_file.h"
 #include "core/input/input_manager.h"
+#include "os/pak_file.h"
 #include "framework/scene_loader.h"
+#include "framework/prefab_cache.h"
+#include "framework/scene_cooker.h"
 #include "framework/systems/render_system.h"
 #include "framework/systems/render_ui_system.h"
 #include "framework/systems/script_system.h"
@@ -32,6 +37,11 @@ EditorSystem::EditorSystem()
     , m_CurrExportDir("")
     , m_IsCopyFailed(false)
 {
+	// Any component can be edited from the inspector
+	declareWriteAll();
+	declareWriteResource("Lua");
+	declareWriteResource("Device");
+
 	m_Binder.bind(EditorEvents::EditorSaveBeforeQuit, this, &EditorSystem::saveBeforeQuit);
 	m_Binder.bind(EditorEvents::EditorSaveAll, this, &EditorSystem::saveAll);
 	m_Binder.bind(EditorEvents::EditorAutoSave, this, &EditorSystem::autoSave);
@@ -181,6 +191,11 @@ void EditorSystem::update(float deltaMilliseconds)
 
 	pushRegularFont();
 
+	if (!m_StreamingFiles.empty())
+	{
+		updateStreamingBenchmark();
+	}
+
 	drawDefaultUI(deltaMilliseconds);
 	m_Scene->draw(deltaMilliseconds);
 	m_Toolbar->draw(deltaMilliseconds);
@@ -386,6 +401,49 @@ void EditorSystem::drawDefaultUI(float deltaMilliseconds)
 					OS::Execute("start \"\" \"" + OS::GetAbsolutePath("build_fonts.bat").string() + "\"");
 					PRINT("Built fonts");
 				}
+				if (ImGui::MenuItem("Benchmark Pak Compression"))
+				{
+					Application::GetSingleton()->getThreadPool().submit({ std::make_shared<Task>([this]() { benchmarkPakCompression(); }) });
+				}
+				if (ImGui::MenuItem("Benchmark Async Streaming", nullptr, false, m_StreamingFiles.empty()))
+				{
+					benchmarkAsyncStreaming();
+				}
+				if (ImGui::MenuItem("Benchmark Scene Reading"))
+				{
+					Application::GetSingleton()->getThreadPool().submit({ std::make_shared<Task>([this]() { benchmarkSceneReading(); }) });
+				}
+				if (ImGui::MenuItem("Benchmark Scene Instantiation"))
+				{
+					benchmarkSceneInstantiation();
+				}
+				if (ImGui::MenuItem("Benchmark Prefab Spawning"))
+				{
+					benchmarkPrefabSpawning();
+				}
+				if (ImGui::MenuItem("Benchmark Collision Cooking"))
+				{
+					benchmarkCollisionCooking();
+				}
+				if (ImGui::MenuItem("Cook Scenes"))
+				{
+					Application::GetSingleton()->getThreadPool().submit({ std::make_shared<Task>([this]() { cookScenes(); }) });
+				}
+				if (ImGui::MenuItem("Dump Residency"))
+				{
+					ResourceLoader::DumpResidency();
+				}
+				if (ImGui::BeginMenu("Dependency Graph"))
+				{
+					const ResourceDependencyGraph::Statistics& graph = ResourceLoader::GetDependencyStatistics();
+					const ResourceLoader::ReimportStatistics& reimport = ResourceLoader::GetLastReimportStatistics();
+					ImGui::Text("Files: %zu", graph.nodeCount);
+					ImGui::Text("Dependencies: %zu", graph.edgeCount);
+					ImGui::Text("Memory: %.1f KB", graph.memoryBytes / 1024.0f);
+					ImGui::Separator();
+					ImGui::Text("Last reload: %d changed, %d reimported in %.2f ms", reimport.changedFiles, reimport.reimportedFiles, reimport.timeMs);
+					ImGui::EndMenu();
+				}
 				if (ImGui::BeginMenu("Resources"))
 				{
 					int id = 0;
@@ -400,20 +458,14 @@ void EditorSystem::drawDefaultUI(float deltaMilliseconds)
 							}
 
 							ImGui::PushID(id);
-							if (file->isDirty())
+							// Files changed on disk are reimported on their own, this reloads one by hand
+							if (ImGui::Button(ICON_ROOTEX_REFRESH "##Refresh Asset"))
 							{
-								if (ImGui::Button(ICON_ROOTEX_REFRESH "##Refresh Asset"))
-								{
-									file->reimport();
-								}
-								ImGui::SameLine();
-								ImGui::TextColored(getWarningColor(), "%s", file->getPath().generic_string().c_str());
-							}
-							else
-							{
-								ImGui::Text(file->getPath().generic_string().c_str());
+								file->reimport();
 							}
 							ImGui::SameLine();
+							ImGui::Text("%s", file->getPath().generic_string().c_str());
+							ImGui::SameLine();
 							ImGui::BulletText("%s", ResourceFile::s_TypeNames.at(file->getType()).c_str());
 							ImGui::PopID();
 							id++;
@@ -901,9 +953,21 @@ Variant EditorSystem::createNewFile(const Event* event)
 	return true;
 }
 
+/// Asset files read through the VirtualFileSystem, which exports pack instead of copying. Other assets are read
+/// straight from disk by the libraries loading them. Formats already compressed are stored as is.
+static const inline HashMap<String, Pair<PakEntryFlag, PakCodec>> PackedExtensions = {
+	{ ".png", { PakEntryFlag::None, PakCodec::None } },
+	{ ".jpg", { PakEntryFlag::None, PakCodec::None } },
+	{ ".jpeg", { PakEntryFlag::None, PakCodec::None } },
+	{ ".dds", { PakEntryFlag::None, PakCodec::Fast } },
+	{ ".json", { PakEntryFlag::NullTerminated, PakCodec::Fast } },
+	{ ".txt", { PakEntryFlag::NullTerminated, PakCodec::Dense } },
+	{ ".rmat", { PakEntryFlag::NullTerminated, PakCodec::Fast } },
+};
+
 int EditorSystem::exportScene(const String& sceneName, const String& sceneFilePath, Atomic<int>& progress)
 {
-	progress = 0;
+	progress = 0;
 
 	JSON::json exportTemplate = JSON::json::parse(ResourceLoader::CreateTextResourceFile("editor/export.template.json")->getString());
 
@@ -957,31 +1021,59 @@ int EditorSystem::exportScene(const String& sceneName, const String& sceneFilePa
 	assetFiles.insert(assetFiles.end(), rootexAssetFiles.begin(), rootexAssetFiles.end());
 	assetFiles.insert(assetFiles.end(), shaderFiles.begin(), shaderFiles.end());
 
+	Ref<PakWriter> assetPak(new PakWriter());
 	for (auto& file : assetFiles)
 	{
-		toCopy.push_back({ file.generic_string(), file.generic_string() });
+		auto&& packed = PackedExtensions.find(file.extension().generic_string());
+		if (packed != PackedExtensions.end())
+		{
+			assetPak->addFile(file.generic_string(), (unsigned int)packed->second.first, packed->second.second);
+		}
+		else
+		{
+			toCopy.push_back({ file.generic_string(), file.generic_string() });
+		}
+
+		// Scenes ship cooked outside the pak, where cooked files are trusted without their scene files on disk
+		if (file.extension() == ".json" && file.stem().extension() == ".scene")
+		{
+			const String sceneFile = file.generic_string();
+			SceneData sceneData;
+			const String cookedFile = CookedCache::GetCookedPath(sceneFile, SCENE_COOKED_EXTENSION).generic_string();
+			if (SceneCooker::Read(sceneFile, *ResourceLoader::CreateTextResourceFile(sceneFile), sceneData) && OS::IsExists(cookedFile))
+			{
+				toCopy.push_back({ cookedFile, cookedFile });
+			}
+			else
+			{
+				WARN("Could not cook scene for export, it will be read from its scene file: " + sceneFile);
+			}
+		}
 	}
 
 	Vector<Ref<Task>> tasks;
 	m_IsCopyFailed = false;
 
+	ThreadPool& threadPool = Application::GetSingleton()->getThreadPool();
+	tasks.push_back(std::make_shared<Task>([=, &progress, &threadPool]() {
+		if (!assetPak->save(OS::GetAbsolutePath(m_CurrExportDir + "assets" PAK_EXTENSION), &threadPool))
+		{
+			m_IsCopyFailed = true;
+		}
+		progress++;
+	}));
+
 	for (auto& filePair : toCopy)
 	{
 		tasks.push_back(std::make_shared<Task>([=, &progress]() {
-			progress++;
-			if (m_IsCopyFailed)
+			if (!m_IsCopyFailed)
 			{
-				return;
+				m_IsCopyFailed = !OS::RelativeCopyFile(filePair.first, m_CurrExportDir + filePair.second);
 			}
-			m_IsCopyFailed = !OS::RelativeCopyFile(filePair.first, m_CurrExportDir + filePair.second);
+			progress++;
 		}));
 	}
 
-	/// TODO: Fix the need for this dummy task (blocks the main thread while tasks are running)
-	tasks.push_back(std::make_shared<Task>([]() {}));
-	progress++;
-
-	ThreadPool& threadPool = Application::GetSingleton()->getThreadPool();
 	threadPool.submit(tasks);
 
 	PRINT("Exporting to " + m_CurrExportDir)
@@ -1003,6 +1095,443 @@ void EditorSystem::postExport()
 	m_IsCopyFailed = false;
 }
 
+/// Frames longer than this while streaming count as hitches.
+#define STREAMING_HITCH_MS 33.3f
+
+void EditorSystem::benchmarkAsyncStreaming()
+{
+	static const HashMap<String, ResourceFile::Type> streamedExtensions = {
+		{ ".png", ResourceFile::Type::Image },
+		{ ".jpg", ResourceFile::Type::Image },
+		{ ".jpeg", ResourceFile::Type::Image },
+		{ ".dds", ResourceFile::Type::Image },
+		{ ".obj", ResourceFile::Type::Model },
+		{ ".3ds", ResourceFile::Type::Model },
+		{ ".fbx", ResourceFile::Type::Model },
+		{ ".wav", ResourceFile::Type::Audio },
+	};
+
+	Vector<FilePath> assetFiles = OS::GetAllFilesInDirectory("game/assets/");
+	int cachedFiles = 0;
+	for (auto& file : assetFiles)
+	{
+		auto&& type = streamedExtensions.find(file.extension().generic_string());
+		if (type != streamedExtensions.end())
+		{
+			m_StreamingFiles.push_back(ResourceLoader::CreateResourceFileAsync(type->second, file.generic_string()));
+			cachedFiles += m_StreamingFiles.back().isLoaded() ? 1 : 0;
+		}
+	}
+
+	m_StreamingFrames = 0;
+	m_StreamingHitches = 0;
+	m_StreamingMaxFrameTime = 0.0f;
+	m_StreamingTime = 0.0f;
+	PRINT("Streaming " + std::to_string(m_StreamingFiles.size()) + " files, " + std::to_string(cachedFiles) + " were already loaded");
+}
+
+void EditorSystem::updateStreamingBenchmark()
+{
+	const float frameTime = Application::GetSingleton()->getAppFrameTimer().getLastFrameTime();
+	m_StreamingFrames++;
+	m_StreamingTime += frameTime;
+	m_StreamingMaxFrameTime = std::max(m_StreamingMaxFrameTime, frameTime);
+	if (frameTime > STREAMING_HITCH_MS)
+	{
+		m_StreamingHitches++;
+	}
+
+	for (auto& file : m_StreamingFiles)
+	{
+		if (!file.isLoaded())
+		{
+			return;
+		}
+	}
+
+	int failedFiles = 0;
+	for (auto& file : m_StreamingFiles)
+	{
+		failedFiles += file.isFailed() ? 1 : 0;
+	}
+	PRINT("Streamed " + std::to_string(m_StreamingFiles.size() - failedFiles) + " files (" + std::to_string(failedFiles) + " failed) in "
+	    + std::to_string(m_StreamingTime) + "ms over " + std::to_string(m_StreamingFrames) + " frames: average frame "
+	    + std::to_string(m_StreamingTime / m_StreamingFrames) + "ms, longest " + std::to_string(m_StreamingMaxFrameTime) + "ms, "
+	    + std::to_string(m_StreamingHitches) + " frames over " + std::to_string(STREAMING_HITCH_MS) + "ms");
+	m_StreamingFiles.clear();
+}
+
+/// Walk a scene tree the way scenes were created from JSON trees, copying the components of every entity.
+static size_t WalkSceneJSON(const JSON::json& sceneJSON)
+{
+	size_t components = 0;
+	if (sceneJSON.contains("entity") && sceneJSON["entity"].contains("components"))
+	{
+		JSON::json componentJSON = sceneJSON["entity"]["components"];
+		components += componentJSON.size();
+	}
+	if (sceneJSON.contains("children"))
+	{
+		for (auto& child : sceneJSON["children"])
+		{
+			components += WalkSceneJSON(child);
+		}
+	}
+	return components;
+}
+
+static size_t CountComponents(const SceneData& sceneData)
+{
+	size_t components = sceneData.entity.components.size();
+	for (auto& child : sceneData.children)
+	{
+		components += CountComponents(child);
+	}
+	return components;
+}
+
+/// Drop the JSON of components cooked as typed records, which read back without it.
+static void ClearRecordedComponents(SceneData& sceneData)
+{
+	for (auto& component : sceneData.entity.components)
+	{
+		auto&& found = ECSFactory::s_ComponentSets.find(component.name);
+		if (found != ECSFactory::s_ComponentSets.end() && found->second->hasRecords())
+		{
+			component.data = nullptr;
+		}
+	}
+	for (auto& child : sceneData.children)
+	{
+		ClearRecordedComponents(child);
+	}
+}
+
+#define SCENE_READING_BENCHMARK_RUNS 20
+
+void EditorSystem::benchmarkSceneReading()
+{
+	float totalTreeTime = 0.0f;
+	float totalReaderTime = 0.0f;
+	for (auto& file : OS::GetAllFilesInDirectory("game/assets/scenes/"))
+	{
+		const String text = ResourceLoader::CreateTextResourceFile(file.generic_string())->getString();
+
+		// Scene files used to be parsed once to preload and once more to load
+		size_t treeComponents = 0;
+		StopTimer treeTimer;
+		for (int run = 0; run < SCENE_READING_BENCHMARK_RUNS; run++)
+		{
+			const SceneSettings& settings = JSON::json::parse(text).value("settings", SceneSettings());
+			treeComponents = WalkSceneJSON(JSON::json::parse(text));
+		}
+		const float treeTime = treeTimer.getTimeMs() / SCENE_READING_BENCHMARK_RUNS;
+
+		size_t readerComponents = 0;
+		size_t resourceCount = 0;
+		StopTimer readerTimer;
+		for (int run = 0; run < SCENE_READING_BENCHMARK_RUNS; run++)
+		{
+			SceneData sceneData;
+			Vector<String> resourcePaths;
+			if (!SceneReader::Read(text, sceneData, &resourcePaths))
+			{
+				return;
+			}
+			readerComponents = CountComponents(sceneData);
+			resourceCount = resourcePaths.size();
+		}
+		const float readerTime = readerTimer.getTimeMs() / SCENE_READING_BENCHMARK_RUNS;
+
+		totalTreeTime += treeTime;
+		totalReaderTime += readerTime;
+		PRINT("Read " + file.filename().generic_string() + " (" + std::to_string(text.size() / 1024) + "KB, " + std::to_string(readerComponents) + "/"
+		    + std::to_string(treeComponents) + " components, " + std::to_string(resourceCount) + " resource references): " + std::to_string(treeTime)
+		    + "ms as JSON trees, " + std::to_string(readerTime) + "ms with SceneReader");
+	}
+	PRINT("Read all scenes in " + std::to_string(totalTreeTime) + "ms as JSON trees, " + std::to_string(totalReaderTime) + "ms with SceneReader");
+}
+
+void EditorSystem::cookScenes()
+{
+	int cookedScenes = 0;
+	int mismatchedScenes = 0;
+	for (auto& file : OS::GetAllFilesInDirectory("game/assets/scenes/"))
+	{
+		const String sceneFile = file.generic_string();
+		const String text = ResourceLoader::CreateTextResourceFile(sceneFile)->getString();
+
+		SceneData sceneData;
+		Vector<String> resourcePaths;
+		StopTimer readTimer;
+		if (!SceneReader::Read(text, sceneData, &resourcePaths))
+		{
+			continue;
+		}
+		const float readTime = readTimer.getTimeMs();
+		if (!SceneCooker::Cook(sceneFile, sceneData, resourcePaths))
+		{
+			WARN("Could not cook scene: " + sceneFile);
+			continue;
+		}
+
+		SceneData cookedData;
+		StopTimer loadTimer;
+		if (!SceneCooker::Load(sceneFile, cookedData))
+		{
+			WARN("Could not load cooked scene: " + sceneFile);
+			continue;
+		}
+		const float loadTime = loadTimer.getTimeMs();
+		cookedScenes++;
+
+		// Records are copied byte for byte, so only what stays JSON can read back differently
+		const JSON::json& readJSON = sceneData;
+		ClearRecordedComponents(sceneData);
+		if (JSON::json(cookedData) != JSON::json(sceneData))
+		{
+			WARN("Cooked scene does not match its scene file: " + sceneFile);
+			mismatchedScenes++;
+		}
+		else if (readJSON != JSON::json::parse(text))
+		{
+			PRINT(sceneFile + " has fields scenes do not read, they are left out of the cooked scene");
+		}
+
+		std::error_code error;
+		const unsigned long long cookedSize = std::filesystem::file_size(OS::GetAbsolutePath(CookedCache::GetCookedPath(sceneFile, SCENE_COOKED_EXTENSION).generic_string()), error);
+		PRINT("Cooked " + sceneFile + ": " + std::to_string(text.size() / 1024) + "KB to " + std::to_string(cookedSize / 1024) + "KB, read in "
+		    + std::to_string(readTime) + "ms, loaded cooked in " + std::to_string(loadTime) + "ms");
+	}
+	PRINT("Cooked " + std::to_string(cookedScenes) + " scenes, " + std::to_string(mismatchedScenes) + " did not read back the same");
+}
+
+/// Threads compared when creating scenes, including the calling thread.
+static const int SceneInstantiationThreads[] = { 1, 2, 4, 8 };
+
+void EditorSystem::benchmarkSceneInstantiation()
+{
+	Array<float, std::size(SceneInstantiationThreads)> totalTimes = {};
+	for (auto& file : OS::GetAllFilesInDirectory("game/assets/scenes/"))
+	{
+		const String sceneFile = file.generic_string();
+		SceneData sceneData;
+		if (!SceneCooker::Read(sceneFile, *ResourceLoader::CreateTextResourceFile(sceneFile), sceneData))
+		{
+			continue;
+		}
+
+		// Warm up resources loaded by components so every run only measures creating the scenes
+		Scene::Create(sceneData, true);
+
+		String report;
+		for (int i = 0; i < std::size(SceneInstantiationThreads); i++)
+		{
+			// The calling thread works on the tasks it waits on, so a pool of n - 1 workers runs n threads
+			Ptr<ThreadPool> pool;
+			if (SceneInstantiationThreads[i] > 1)
+			{
+				pool.reset(new ThreadPool(SceneInstantiationThreads[i] - 1));
+			}
+
+			StopTimer createTimer;
+			SceneBuilder builder(sceneData, true);
+			builder.stage(pool.get());
+			while (builder.createNext())
+			{
+			}
+			const float createTime = createTimer.getTimeMs();
+			totalTimes[i] += createTime;
+			report += ", " + std::to_string(SceneInstantiationThreads[i]) + " threads " + std::to_string(createTime) + "ms";
+		}
+		PRINT("Created " + sceneFile + " (" + std::to_string(CountComponents(sceneData)) + " components)" + report);
+	}
+
+	String report;
+	for (int i = 0; i < std::size(SceneInstantiationThreads); i++)
+	{
+		report += ", " + std::to_string(SceneInstantiationThreads[i]) + " threads " + std::to_string(totalTimes[i]) + "ms ("
+		    + std::to_string(totalTimes[i] > 0.0f ? totalTimes[0] / totalTimes[i] : 0.0f) + "x)";
+	}
+	PRINT("Created all scenes" + report);
+}
+
+/// Copies of each scene spawned by the prefab spawning benchmark.
+#define PREFAB_BENCHMARK_SPAWNS 100
+
+static String SpawnRate(float milliseconds)
+{
+	return std::to_string(milliseconds > 0.0f ? (int)(PREFAB_BENCHMARK_SPAWNS * 1000.0f / milliseconds) : 0) + " spawns/s";
+}
+
+void EditorSystem::benchmarkPrefabSpawning()
+{
+	Scene* parent = SceneLoader::GetSingleton()->getCurrentScene();
+	if (!parent)
+	{
+		WARN("Open a scene to spawn prefabs into");
+		return;
+	}
+	PRINT("Copies from templates and pools skip reading the scene file but still construct every component, from typed records "
+	    "for hot component types and from JSON for the rest, so the spawn rates mostly compare the skipped file reads");
+
+	for (auto& file : OS::GetAllFilesInDirectory("game/assets/scenes/"))
+	{
+		const String sceneFile = file.generic_string();
+
+		// Copies used to be created by reading their scene file every time
+		Vector<Scene*> created;
+		StopTimer fileTimer;
+		for (int i = 0; i < PREFAB_BENCHMARK_SPAWNS; i++)
+		{
+			Ptr<Scene> copy = Scene::CreateFromFile(sceneFile);
+			Scene* added = copy.get();
+			if (added && parent->addChild(copy))
+			{
+				added->onLoad();
+				created.push_back(added);
+			}
+		}
+		const float fileTime = fileTimer.getTimeMs();
+		for (auto& scene : created)
+		{
+			parent->removeChild(scene);
+		}
+
+		StopTimer templateTimer;
+		Vector<Scene*> spawned = PrefabCache::GetSingleton()->spawnMany(sceneFile, parent, PREFAB_BENCHMARK_SPAWNS);
+		const float templateTime = templateTimer.getTimeMs();
+		for (auto& scene : spawned)
+		{
+			PrefabCache::GetSingleton()->despawn(scene);
+		}
+		PrefabCache::GetSingleton()->despawnPending();
+
+		StopTimer pooledTimer;
+		spawned = PrefabCache::GetSingleton()->spawnMany(sceneFile, parent, PREFAB_BENCHMARK_SPAWNS);
+		const float pooledTime = pooledTimer.getTimeMs();
+		for (auto& scene : spawned)
+		{
+			parent->removeChild(scene);
+		}
+
+		PRINT("Spawned " + std::to_string(PREFAB_BENCHMARK_SPAWNS) + " copies of " + sceneFile + ": " + SpawnRate(fileTime) + " from the scene file, "
+		    + SpawnRate(templateTime) + " from the template, " + SpawnRate(pooledTime) + " from the pool");
+	}
+	PrefabCache::GetSingleton()->clearPools();
+}
+
+/// Loads of each collision model timed by the collision cooking benchmark.
+#define COLLISION_BENCHMARK_RUNS 5
+
+void EditorSystem::benchmarkCollisionCooking()
+{
+	const HashMap<ResourceFile::Type, Vector<Weak<ResourceFile>>>& resources = ResourceLoader::GetResources();
+	auto&& collisionModels = resources.find(ResourceFile::Type::CollisionModel);
+	if (collisionModels == resources.end())
+	{
+		WARN("Open a scene with static mesh colliders to load collision models");
+		return;
+	}
+
+	float totalRebuiltTime = 0.0f;
+	float totalCookedTime = 0.0f;
+	for (auto& weakFile : collisionModels->second)
+	{
+		Ref<CollisionModelResourceFile> file = std::static_pointer_cast<CollisionModelResourceFile>(weakFile.lock());
+		if (!file)
+		{
+			continue;
+		}
+
+		// Rebuilding also writes the cooked file again, as a first load does, so the cooked loads read it back
+		StopTimer rebuiltTimer;
+		for (int run = 0; run < COLLISION_BENCHMARK_RUNS; run++)
+		{
+			file->rebuild();
+		}
+		const float rebuiltTime = rebuiltTimer.getTimeMs() / COLLISION_BENCHMARK_RUNS;
+
+		StopTimer cookedTimer;
+		for (int run = 0; run < COLLISION_BENCHMARK_RUNS; run++)
+		{
+			file->reimport();
+		}
+		const float cookedTime = cookedTimer.getTimeMs() / COLLISION_BENCHMARK_RUNS;
+
+		totalRebuiltTime += rebuiltTime;
+		totalCookedTime += cookedTime;
+		PRINT("Loaded " + file->getPath().generic_string() + " in " + std::to_string(rebuiltTime) + "ms importing and building the BVH, "
+		    + std::to_string(cookedTime) + "ms from the cooked file");
+	}
+	PRINT("Loaded all collision models in " + std::to_string(totalRebuiltTime) + "ms importing and building their BVHs, " + std::to_string(totalCookedTime)
+	    + "ms from their cooked files (" + std::to_string(totalCookedTime > 0.0f ? totalRebuiltTime / totalCookedTime : 0.0f) + "x)");
+}
+
+void EditorSystem::benchmarkPakCompression()
+{
+	ThreadPool& threadPool = Application::GetSingleton()->getThreadPool();
+	Vector<FilePath> assetFiles = OS::GetAllFilesInDirectory("game/assets/");
+	Vector<FilePath> rootexAssetFiles = OS::GetAllFilesInDirectory("rootex/assets/");
+	assetFiles.insert(assetFiles.end(), rootexAssetFiles.begin(), rootexAssetFiles.end());
+
+	const Vector<Pair<String, PakCodec>> codecs = { { "raw", PakCodec::None }, { "fast", PakCodec::Fast }, { "dense", PakCodec::Dense } };
+	OS::CreateDirectoryName("cache/");
+	for (auto& [name, codec] : codecs)
+	{
+		PakWriter writer;
+		for (auto& file : assetFiles)
+		{
+			writer.addFile(file.generic_string(), (unsigned int)PakEntryFlag::None, codec);
+		}
+
+		const String pakPath = "cache/benchmark_" + name + PAK_EXTENSION;
+		StopTimer buildTimer;
+		if (!writer.save(OS::GetAbsolutePath(pakPath), &threadPool))
+		{
+			WARN("Pak compression benchmark failed to build " + pakPath);
+			return;
+		}
+		const float buildTime = buildTimer.getTimeMs();
+
+		PakFile pak;
+		if (!pak.open(OS::GetAbsolutePath(pakPath)))
+		{
+			return;
+		}
+
+		// Reads every entry the way the VirtualFileSystem does, touching the bytes of entries read in place
+		unsigned long long rawSize = 0;
+		unsigned long long checksum = 0;
+		StopTimer readTimer;
+		for (unsigned int i = 0; i < pak.getEntryCount(); i++)
+		{
+			const PakEntry& entry = pak.getEntries()[i];
+			rawSize += entry.size;
+			if (entry.isCompressed())
+			{
+				FileBuffer buffer(entry.size);
+				pak.decompress(entry, buffer.data(), &threadPool);
+				checksum += buffer.empty() ? 0 : buffer.back();
+			}
+			else
+			{
+				for (char ch : pak.getContents(entry))
+				{
+					checksum += ch;
+				}
+			}
+		}
+		const float readTime = readTimer.getTimeMs();
+
+		std::error_code error;
+		const unsigned long long pakSize = std::filesystem::file_size(OS::GetAbsolutePath(pakPath), error);
+		PRINT("Pak " + name + ": " + std::to_string(pakSize / 1024) + "KB for " + std::to_string(rawSize / 1024) + "KB of assets ("
+		    + std::to_string(rawSize ? 100.0f * pakSize / rawSize : 100.0f) + "%), built in " + std::to_string(buildTime) + "ms, read at "
+		    + std::to_string(rawSize / 1048576.0f / std::max(readTime * MS_TO_S, 0.001f)) + "MB/s (checksum " + std::to_string(checksum) + ")");
+	}
+}
+
 void EditorSystem::drawProgressBar(Atomic<int>& progress, float& currentProgress, int& totalProgress)
 {
 	float target = progress.load() / (float)totalProgress;
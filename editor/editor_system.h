@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/event_manager.h"
+#include "core/async_resource.h"
 #include "script/interpreter.h"
 #include "framework/system.h"
 #include "utility/imgui_helpers.h"
@@ -59,6 +60,13 @@ class EditorSystem : public System
 	Atomic<bool> m_IsCopyFailed;
 	String m_CurrExportDir;
 
+	/// Files streamed in by the asynchronous loading benchmark, and the frames measured while they load.
+	Vector<AsyncHandle<ResourceFile>> m_StreamingFiles;
+	int m_StreamingFrames = 0;
+	int m_StreamingHitches = 0;
+	float m_StreamingMaxFrameTime = 0.0f;
+	float m_StreamingTime = 0.0f;
+
 	EditorSystem();
 	EditorSystem(const EditorSystem&) = delete;
 	~EditorSystem();
@@ -75,6 +83,21 @@ class EditorSystem : public System
 	Variant createNewFile(const Event* event);
 	int exportScene(const String& sceneName, const String& sceneFilePath, Atomic<int>& progress);
 	void postExport();
+	/// Pack the assets once per codec and report pak sizes and read throughput.
+	void benchmarkPakCompression();
+	/// Request every asset asynchronously, then report frame times until all are loaded from updateStreamingBenchmark().
+	void benchmarkAsyncStreaming();
+	void updateStreamingBenchmark();
+	/// Read every scene in game/assets/scenes the way scenes used to be read into JSON trees and through SceneReader.
+	void benchmarkSceneReading();
+	/// Create every scene in game/assets/scenes on 1, 2, 4 and 8 threads and report the speedups.
+	void benchmarkSceneInstantiation();
+	/// Spawn copies of every scene in game/assets/scenes from their files, from prefab templates and from prefab pools.
+	void benchmarkPrefabSpawning();
+	/// Load every loaded collision model by importing it and building its BVH, and from its cooked file, and compare.
+	void benchmarkCollisionCooking();
+	/// Cook every scene in game/assets/scenes, check that each reads back the same as its scene file and compare load times.
+	void cookScenes();
 
 public:
 	static EditorSystem* GetSingleton();
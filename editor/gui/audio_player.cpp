@@ -71,16 +71,6 @@ void AudioPlayer::unload()
 void AudioPlayer::draw(float deltaMilliseconds)
 {
 	drawFileInfo();
-
-	if (m_OpenFile->isDirty())
-	{
-		ImGui::TextColored(EditorSystem::GetSingleton()->getWarningColor(), "File may be changed on disk");
-		ImGui::SameLine();
-		if (ImGui::Button("Reload"))
-		{
-			m_OpenFile->reimport();
-		}
-	}
 	ImGui::NewLine();
 	m_FractionProgress = m_Source->getElapsedTimeS() / m_Buffer->getAudioFile()->getDuration();
 	if (m_FractionProgress > 1.0f)
@@ -8,15 +8,6 @@
 void ImageViewer::draw(float deltaMilliseconds)
 {
 	drawFileInfo();
-	if (m_ImageResourceFile->isDirty())
-	{
-		ImGui::TextColored(EditorSystem::GetSingleton()->getWarningColor(), "File may be changed on disk");
-		ImGui::SameLine();
-		if (ImGui::Button("Reload"))
-		{
-			m_ImageResourceFile->reimport();
-		}
-	}
 	ImGui::Separator();
 	ImGui::SetNextItemWidth(ImGui::GetContentRegionAvailWidth());
 	ImGui::SliderFloat("##Zoom", &m_Zoom, m_MinZoom, m_MaxZoom, "Zoom %.3fx");
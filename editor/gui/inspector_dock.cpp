@@ -222,7 +222,7 @@ void InspectorDock::draw(float deltaMilliseconds)
 				if (ImGui::BeginTabBar("Components", ImGuiTabBarFlags_AutoSelectNewTabs | ImGuiTabBarFlags_NoCloseWithMiddleMouseButton | ImGuiTabBarFlags_FittingPolicyMask_))
 				{
 					ImGui::PushStyleColor(ImGuiCol_Text, (const ImVec4&)EditorSystem::GetSingleton()->getNormalColor());
-					for (auto& [componentID, component] : entity.getAllComponents())
+					for (auto& component : entity.getAllComponents())
 					{
 						if (ImGui::BeginTabItem(component->getName(), nullptr, ImGuiTabItemFlags_NoCloseWithMiddleMouseButton))
 						{
@@ -26,15 +26,6 @@ void TextViewer::unload()
 void TextViewer::draw(float deltaMilliseconds)
 {
 	drawFileInfo();
-	if (m_TextResourceFile->isDirty())
-	{
-		ImGui::TextColored(EditorSystem::GetSingleton()->getWarningColor(), "File may be changed on disk");
-		ImGui::SameLine();
-		if (ImGui::Button("Reload"))
-		{
-			m_TextResourceFile->reimport();
-		}
-	}
 	ImGui::Separator();
 	EditorSystem::GetSingleton()->pushMonospaceFont();
 	if (m_TextResourceFile->getSize() < TEXT_THRESHOLD_SIZE)
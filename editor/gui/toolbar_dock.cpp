@@ -127,6 +127,12 @@ void ToolbarDock::draw(float deltaMilliseconds)
 				ImGui::TreePop();
 			}
 
+			if (ImGui::TreeNodeEx("System Schedule"))
+			{
+				Application::GetSingleton()->getSystemScheduler().draw();
+				ImGui::TreePop();
+			}
+
 			for (auto& systems : System::GetSystems())
 			{
 				for (auto& system : systems)
@@ -10,6 +10,9 @@ function DialoguePlayer:initialize(entity)
 end
 
 function DialoguePlayer:begin(entity)
+	self.upEvent = RTX.EventType.new(self.exports.up)
+	self.downEvent = RTX.EventType.new(self.exports.down)
+	self.nextEvent = RTX.EventType.new(self.exports.next)
 	self.narrator = require("narrator/narrator")
 	local book = self.narrator.parseFile(self.exports.story)
 	self.story = self.narrator.initStory(book)
@@ -48,19 +51,19 @@ function DialoguePlayer:update(entity, delta)
 	end
 
 	if self.story:canChoose() then
-		if RTX.Input.WasPressed(self.exports.up) then
+		if RTX.Input.WasPressed(self.upEvent) then
 			self.currentChoice = self.currentChoice - 1
 			if self.currentChoice < 1 then self.currentChoice = self.maxChoices end
 			self:presentChoices(self.story:getChoices())
 		end
 		
-		if RTX.Input.WasPressed(self.exports.down) then
+		if RTX.Input.WasPressed(self.downEvent) then
 			self.currentChoice = self.currentChoice + 1
 			if self.currentChoice > self.maxChoices then self.currentChoice = 1 end
 			self:presentChoices(self.story:getChoices())
 		end
 		
-		if RTX.Input.WasPressed(self.exports.next) then
+		if RTX.Input.WasPressed(self.nextEvent) then
 			local choices = self.story:getChoices()
 			if choices[self.currentChoice].tags then
 				for _, tag in ipairs(choices[self.currentChoice].tags) do
@@ -1,5 +1,11 @@
 PlayerControl = class("PlayerControl")
 
+local Forward = RTX.EventType.new("Forward")
+local Left = RTX.EventType.new("Left")
+local Right = RTX.EventType.new("Right")
+local Backward = RTX.EventType.new("Backward")
+local Punch = RTX.EventType.new("Punch")
+
 function PlayerControl:initialize(entity)
     self.exports = {
         walkAnim = "",
@@ -22,46 +28,46 @@ end
 function PlayerControl:update(entity, delta)
     local changed = false
     
-    if RTX.Input.IsPressed("Forward") then
+    if RTX.Input.IsPressed(Forward) then
         self.anim:transition(self.exports.runAnim, 2.0)
         self.collider:translate(RTX.Vector3.new(0, 0, -self.exports.runSpeed * delta))
         self.angle = 0
         changed = true
     end
-    if RTX.Input.IsPressed("Left") then
+    if RTX.Input.IsPressed(Left) then
         self.anim:transition(self.exports.walkAnim, 2.0)
         self.collider:translate(RTX.Vector3.new(-self.exports.walkSpeed * delta, 0, 0))
         self.angle = math.pi / 2
         changed = true
     end
-    if RTX.Input.IsPressed("Right") then
+    if RTX.Input.IsPressed(Right) then
         self.anim:transition(self.exports.walkAnim, 2.0)
         self.collider:translate(RTX.Vector3.new(self.exports.walkSpeed * delta, 0, 0))
         self.angle = -math.pi / 2
         changed = true
     end
-    if RTX.Input.IsPressed("Backward") then
+    if RTX.Input.IsPressed(Backward) then
         self.anim:transition(self.exports.walkAnim, 2.0)
         self.collider:translate(RTX.Vector3.new(0, 0, self.exports.walkSpeed * delta))
         self.angle = math.pi
         changed = true
     end
-    if RTX.Input.IsPressed("Punch") then
+    if RTX.Input.IsPressed(Punch) then
         self.anim:transition(self.exports.jumpAnim, 2.0)
         self.collider:setVelocity(RTX.Vector3.new(0, 0, 0))
         changed = true
     end
 
-    if RTX.Input.IsPressed("Forward") and RTX.Input.IsPressed("Right") then
+    if RTX.Input.IsPressed(Forward) and RTX.Input.IsPressed(Right) then
         self.angle = -math.pi / 4.0
     end
-    if RTX.Input.IsPressed("Forward") and RTX.Input.IsPressed("Left") then
+    if RTX.Input.IsPressed(Forward) and RTX.Input.IsPressed(Left) then
         self.angle = math.pi / 4.0
     end
-    if RTX.Input.IsPressed("Backward") and RTX.Input.IsPressed("Right") then
+    if RTX.Input.IsPressed(Backward) and RTX.Input.IsPressed(Right) then
         self.angle = -math.pi * 3.0 / 4.0
     end
-    if RTX.Input.IsPressed("Backward") and RTX.Input.IsPressed("Left") then
+    if RTX.Input.IsPressed(Backward) and RTX.Input.IsPressed(Left) then
         self.angle = math.pi * 3.0 / 4.0
     end
 
@@ -13,6 +13,10 @@ DebugSystem::DebugSystem()
     : System("DebugSystem", System::UpdateOrder::GameRender, true)
 {
 	m_FPSRecords.resize(100);
+
+	// Any component can be edited from the scene tree
+	declareWriteAll();
+	declareWriteResource("Device");
 }
 
 DebugSystem* DebugSystem::GetSingleton()
@@ -49,7 +53,7 @@ void DebugSystem::drawSceneTree(Scene* scene)
 		{
 			Entity& entity = scene->getEntity();
 			entity.draw();
-			for (auto& [componentID, component] : entity.getAllComponents())
+			for (auto& component : entity.getAllComponents())
 			{
 				if (ImGui::TreeNodeEx(component->getName()))
 				{
@@ -5,6 +5,7 @@
 GameRenderSystem::GameRenderSystem()
     : System("GameRenderSystem", System::UpdateOrder::GameRender, true)
 {
+	declareWriteResource("Device");
 }
 
 GameRenderSystem* GameRenderSystem::GetSingleton()
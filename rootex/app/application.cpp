@@ -3,11 +3,14 @@
 #include "framework/scene_loader.h"
 #include "framework/ecs_factory.h"
 #include "core/resource_loader.h"
+#include "os/virtual_file_system.h"
 #include "core/resource_files/lua_text_resource_file.h"
 #include "core/input/input_manager.h"
 #include "script/interpreter.h"
 
 #include "systems/audio_system.h"
+#include "systems/spatial_audio_system.h"
+#include "systems/light_system.h"
 #include "systems/physics_system.h"
 #include "systems/input_system.h"
 #include "systems/ui_system.h"
@@ -50,6 +53,7 @@ Application::Application(const String& appTitle, const String& settingsFile)
 	{
 		ERR("Application OS was not initialized");
 	}
+	VirtualFileSystem::Initialize(&m_ThreadPool);
 
 	if (!OS::CreateDirectoryAbsoluteName(OS::GetAbsoluteSaveGameFolder(getAppTitle())))
 	{
@@ -90,6 +94,15 @@ Application::Application(const String& appTitle, const String& settingsFile)
 	InputSystem::GetSingleton()->initialize(inputSystemSettings);
 
 	ResourceLoader::Initialize();
+	ResourceLoader::LoadResidencyBudgets(m_ApplicationSettings->getJSON().value("resourceBudgetsMB", JSON::json::object()));
+
+	// Registered ahead of the systems running scripts, which wait on everything before them, so these two can overlap
+	TransformAnimationSystem::GetSingleton();
+	if (!AudioSystem::GetSingleton()->initialize(systemsSettings["AudioSystem"]))
+	{
+		ERR("Audio System was not initialized");
+	}
+
 	PhysicsSystem::GetSingleton()->initialize(systemsSettings["PhysicsSystem"]);
 	TriggerSystem::GetSingleton();
 
@@ -100,20 +113,18 @@ Application::Application(const String& appTitle, const String& settingsFile)
 
 	RenderUISystem::GetSingleton();
 	RenderSystem::GetSingleton();
+	LightSystem::GetSingleton();
 	ParticleSystem::GetSingleton()->initialize(systemsSettings["ParticleSystem"]);
 	PostProcessSystem::GetSingleton();
 
-	TransformAnimationSystem::GetSingleton();
 	AnimationSystem::GetSingleton();
 
 	ScriptSystem::GetSingleton();
 
-	if (!AudioSystem::GetSingleton()->initialize(systemsSettings["AudioSystem"]))
-	{
-		ERR("Audio System was not initialized");
-	}
-
 	PlayerSystem::GetSingleton();
+	SpatialAudioSystem::GetSingleton();
+
+	SceneLoader::GetSingleton()->setStreamingBudget(m_ApplicationSettings->getJSON().value("sceneStreamingBudgetMs", SCENE_STREAMING_BUDGET_MS));
 
 	auto&& postInitialize = m_ApplicationSettings->find("postInitialize");
 	if (postInitialize != m_ApplicationSettings->end())
@@ -145,16 +156,11 @@ void Application::run()
 	{
 		m_FrameTimer.reset();
 
-		for (auto& systems : System::GetSystems())
-		{
-			for (auto& system : systems)
-			{
-				if (system->isActive())
-				{
-					system->update(m_DeltaMultiplier * m_FrameTimer.getLastFrameTime());
-				}
-			}
-		}
+		ResourceLoader::ReimportChangedFiles();
+		ResourceLoader::UpdateResidency();
+
+		m_SystemScheduler.update(m_ThreadPool, m_DeltaMultiplier * m_FrameTimer.getLastFrameTime());
+		SceneLoader::GetSingleton()->updateStreams();
 
 		process(m_FrameTimer.getLastFrameTime());
 
@@ -5,6 +5,7 @@
 #include "core/event_manager.h"
 #include "os/timer.h"
 #include "os/thread.h"
+#include "framework/system_scheduler.h"
 #include "application_settings.h"
 
 /// Interface for a Rootex application.
@@ -17,6 +18,7 @@ protected:
 	Timer m_ApplicationTimer;
 	FrameTimer m_FrameTimer;
 	ThreadPool m_ThreadPool;
+	SystemScheduler m_SystemScheduler;
 	float m_DeltaMultiplier = 1.0f;
 	String m_ApplicationTitle;
 	int m_CurrentSaveSlot;
@@ -47,6 +49,7 @@ public:
 	const String& getAppTitle() const { return m_ApplicationTitle; };
 	const Timer& getAppTimer() const { return m_ApplicationTimer; };
 	ThreadPool& getThreadPool() { return m_ThreadPool; };
+	SystemScheduler& getSystemScheduler() { return m_SystemScheduler; }
 	const FrameTimer& getAppFrameTimer() const { return m_FrameTimer; }
 	Window* getWindow() { return m_Window.get(); };
 	ApplicationSettings* getSettings() { return m_ApplicationSettings.get(); }
@@ -1,9 +1,9 @@
 #pragma once
 
-// target Windows 7 or later
+// target Windows 8 or later
 #ifndef _WIN32_WINNT
-#define WINVER 0x0601
-#define _WIN32_WINNT 0x0601
+#define WINVER 0x0602
+#define _WIN32_WINNT 0x0602
 #endif // !_WIN32_WINNT
 #include <sdkddkver.h>
 
@@ -80,6 +80,11 @@ using Map = std::map<P, Q>;
 template <class P, class Q>
 using HashMap = std::unordered_map<P, Q>;
 
+#include <unordered_set>
+/// std::unordered_set
+template <class T>
+using HashSet = std::unordered_set<T>;
+
 #include <utility>
 /// std::tuple
 template <typename... P>
@@ -105,6 +110,11 @@ Vector<String> Split(const String& s, char delim);
 template <class T, int N>
 using Array = std::array<T, N>;
 
+#include <bitset>
+/// std::bitset
+template <size_t N>
+using Bitset = std::bitset<N>;
+
 #include <stack>
 /// std::stack
 template <class T>
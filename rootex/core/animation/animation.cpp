@@ -99,16 +99,44 @@ float BoneAnimation::getEndTime() const
 	return std::max(m_Translation.back().m_Time, std::max(m_Rotation.back().m_Time, m_Scaling.back().m_Time));
 }
 
-Matrix SkeletalAnimation::interpolate(const String& nodeName, float currentTime)
+void SkeletalAnimation::bindSkeleton(const Vector<SkeletonNode>& skeleton)
 {
-	if (m_BoneAnimations.find(nodeName) != m_BoneAnimations.end())
+	HashMap<String, int> channelIndices;
+	for (int i = 0; i < m_ChannelNames.size(); i++)
 	{
-		return m_BoneAnimations[nodeName].interpolate(currentTime);
+		channelIndices[m_ChannelNames[i]] = i;
 	}
-	else
+
+	m_NodeChannels.assign(skeleton.size(), -1);
+	for (int i = 0; i < skeleton.size(); i++)
+	{
+		auto&& found = channelIndices.find(skeleton[i].m_Name);
+		if (found != channelIndices.end())
+		{
+			m_NodeChannels[i] = found->second;
+		}
+	}
+}
+
+Matrix SkeletalAnimation::interpolate(int nodeIndex, float currentTime)
+{
+	if (nodeIndex < m_NodeChannels.size() && m_NodeChannels[nodeIndex] != -1)
+	{
+		return m_Channels[m_NodeChannels[nodeIndex]].interpolate(currentTime);
+	}
+	return Matrix::Identity;
+}
+
+void SkeletalAnimation::addBoneAnimation(const String& boneName, BoneAnimation& boneAnimation)
+{
+	auto&& found = std::find(m_ChannelNames.begin(), m_ChannelNames.end(), boneName);
+	if (found != m_ChannelNames.end())
 	{
-		return Matrix::Identity;
+		m_Channels[found - m_ChannelNames.begin()] = boneAnimation;
+		return;
 	}
+	m_ChannelNames.push_back(boneName);
+	m_Channels.push_back(boneAnimation);
 }
 
 float SkeletalAnimation::getStartTime() const
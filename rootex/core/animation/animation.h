@@ -20,11 +20,15 @@ struct ScalingKeyframe
 	Vector3 m_Scaling;
 };
 
+/// Node of a skeleton flattened in depth-first order. Parents always come before their children.
 struct SkeletonNode
 {
-	Vector<Ptr<SkeletonNode>> m_Children;
 	String m_Name;
 	Matrix m_LocalBindTransform;
+	/// Index of the parent node, -1 for the root.
+	int m_Parent;
+	/// Index of the bone driven by this node, -1 if the node does not drive any vertices.
+	int m_Bone;
 };
 
 class BoneAnimation
@@ -45,24 +49,42 @@ public:
 	void addRotationKeyframe(RotationKeyframe& keyframe) { m_Rotation.push_back(keyframe); }
 	void addScalingKeyframe(ScalingKeyframe& keyframe) { m_Scaling.push_back(keyframe); }
 
+	void setTranslationKeyframes(const TranslationKeyframe* keyframes, size_t count) { m_Translation.assign(keyframes, keyframes + count); }
+	void setRotationKeyframes(const RotationKeyframe* keyframes, size_t count) { m_Rotation.assign(keyframes, keyframes + count); }
+	void setScalingKeyframes(const ScalingKeyframe* keyframes, size_t count) { m_Scaling.assign(keyframes, keyframes + count); }
+
+	const Vector<TranslationKeyframe>& getTranslationKeyframes() const { return m_Translation; }
+	const Vector<RotationKeyframe>& getRotationKeyframes() const { return m_Rotation; }
+	const Vector<ScalingKeyframe>& getScalingKeyframes() const { return m_Scaling; }
+
 	Matrix interpolate(float time);
 };
 
 class SkeletalAnimation
 {
 	float m_Duration;
-	HashMap<String, BoneAnimation> m_BoneAnimations;
+	/// Name of the node animated by each channel.
+	Vector<String> m_ChannelNames;
+	Vector<BoneAnimation> m_Channels;
+	/// Channel animating each node of the bound skeleton, -1 if the node is not animated.
+	Vector<int> m_NodeChannels;
 
 public:
 	SkeletalAnimation() = default;
 	SkeletalAnimation(const SkeletalAnimation&) = default;
 	~SkeletalAnimation() = default;
 
-	Matrix interpolate(const String& nodeName, float currentTime);
+	/// Match channels to the nodes of skeleton by name, so they can be looked up by node index.
+	void bindSkeleton(const Vector<SkeletonNode>& skeleton);
+	/// Transform of the node at nodeIndex in the bound skeleton. Identity if the node is not animated.
+	Matrix interpolate(int nodeIndex, float currentTime);
 
 	float getStartTime() const;
 	float getEndTime() const;
 
 	void setDuration(float time) { m_Duration = time; }
-	void addBoneAnimation(String boneName, BoneAnimation& boneAnimation) { m_BoneAnimations[boneName] = boneAnimation; }
+	void addBoneAnimation(const String& boneName, BoneAnimation& boneAnimation);
+
+	const Vector<String>& getChannelNames() const { return m_ChannelNames; }
+	const Vector<BoneAnimation>& getChannels() const { return m_Channels; }
 };
@@ -0,0 +1,36 @@
+#include "async_resource.h"
+
+AsyncResourceState::AsyncResourceState(const Ref<ResourceFile>& resource, bool isLoaded)
+    : m_Resource(resource)
+    , m_IsLoaded(isLoaded)
+{
+}
+
+void AsyncResourceState::resolve(const Ref<ResourceFile>& file)
+{
+	if (file)
+	{
+		m_Resource = file;
+	}
+	else
+	{
+		m_IsFailed = true;
+	}
+	m_IsLoaded = true;
+
+	for (auto& callback : m_Callbacks)
+	{
+		callback(m_Resource);
+	}
+	m_Callbacks.clear();
+}
+
+void AsyncResourceState::onLoaded(const Function<void(const Ref<ResourceFile>&)>& callback)
+{
+	if (m_IsLoaded)
+	{
+		callback(m_Resource);
+		return;
+	}
+	m_Callbacks.push_back(callback);
+}
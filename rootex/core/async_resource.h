@@ -0,0 +1,57 @@
+#pragma once
+
+#include "common/common.h"
+
+#include "resource_file.h"
+
+/// Shared state of a file loaded in the background. Only read and resolved on the main thread.
+class AsyncResourceState
+{
+	Ref<ResourceFile> m_Resource;
+	bool m_IsLoaded;
+	bool m_IsFailed = false;
+	Vector<Function<void(const Ref<ResourceFile>&)>> m_Callbacks;
+
+	friend class ResourceLoader;
+
+	/// Swap the loaded file in and call back. The placeholder stays if file failed to load.
+	void resolve(const Ref<ResourceFile>& file);
+
+public:
+	AsyncResourceState(const Ref<ResourceFile>& resource, bool isLoaded);
+	AsyncResourceState(AsyncResourceState&) = delete;
+	~AsyncResourceState() = default;
+
+	const Ref<ResourceFile>& getResource() const { return m_Resource; }
+	bool isLoaded() const { return m_IsLoaded; }
+	bool isFailed() const { return m_IsFailed; }
+	void onLoaded(const Function<void(const Ref<ResourceFile>&)>& callback);
+};
+
+/// Handle to a file loaded on worker threads, holding a shared placeholder until the file is loaded.
+/// The file is swapped in while deferred events are dispatched at the end of a frame, so a frame never sees both.
+/// Use from the main thread only.
+template <class T>
+class AsyncHandle
+{
+	Ref<AsyncResourceState> m_State;
+
+public:
+	AsyncHandle() = default;
+	explicit AsyncHandle(const Ref<AsyncResourceState>& state)
+	    : m_State(state)
+	{
+	}
+
+	/// The loaded file, or the placeholder until then. nullptr while loading if the type has no placeholder.
+	Ref<T> get() const { return m_State ? std::dynamic_pointer_cast<T>(m_State->getResource()) : nullptr; }
+	/// True once loading finished, even if it failed.
+	bool isLoaded() const { return m_State && m_State->isLoaded(); }
+	/// True if the file could not be loaded, the placeholder is kept then.
+	bool isFailed() const { return m_State && m_State->isFailed(); }
+	/// Call callback with the file once loaded, from the deferred event queue. Called right away if already loaded.
+	void onLoaded(const Function<void(Ref<T>)>& callback)
+	{
+		m_State->onLoaded([callback](const Ref<ResourceFile>& file) { callback(std::dynamic_pointer_cast<T>(file)); });
+	}
+};
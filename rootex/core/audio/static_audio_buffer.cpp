@@ -7,12 +7,14 @@ void StaticAudioBuffer::initializeBuffers()
 	PANIC(m_AudioFile->getType() != ResourceFile::Type::Audio, "AudioSystem: Trying to load a non-WAV file in a sound buffer");
 
 	AL_CHECK(alGenBuffers(1, &m_BufferID));
-	AL_CHECK(alBufferData(
-	    m_BufferID,
-	    m_AudioFile->getFormat(),
-	    m_AudioFile->getAudioData(),
-	    m_AudioFile->getAudioDataSize(),
-	    m_AudioFile->getFrequency()));
+	m_AudioFile->readAudioData([this](const char* audioData, ALsizei audioDataSize) {
+		AL_CHECK(alBufferData(
+		    m_BufferID,
+		    m_AudioFile->getFormat(),
+		    audioData,
+		    audioDataSize,
+		    m_AudioFile->getFrequency()));
+	});
 }
 
 void StaticAudioBuffer::destroyBuffers()
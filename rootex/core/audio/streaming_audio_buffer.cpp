@@ -11,30 +11,31 @@ void StreamingAudioBuffer::initializeBuffers()
 
 	ALsizei blockAlign = m_AudioFile->getChannels() * (m_AudioFile->getBitDepth() / 8.0);
 
-	m_BufferSize = m_AudioFile->getAudioDataSize() / BUFFER_COUNT;
-	m_BufferSize -= (m_BufferSize % blockAlign);
-	m_BufferCursor = m_AudioFile->getAudioData();
-	m_BufferEnd = m_BufferCursor + m_AudioFile->getAudioDataSize();
-
-	int i = 0;
-	while (i < MAX_BUFFER_QUEUE_LENGTH)
-	{
-		if (m_BufferCursor > m_AudioFile->getAudioData() + m_AudioFile->getAudioDataSize())
+	m_AudioFile->readAudioData([this, blockAlign](const char* audioData, ALsizei audioDataSize) {
+		m_BufferSize = audioDataSize / BUFFER_COUNT;
+		m_BufferSize -= (m_BufferSize % blockAlign);
+		m_BufferCursor = 0;
+
+		int i = 0;
+		while (i < MAX_BUFFER_QUEUE_LENGTH)
 		{
-			break;
+			if (m_BufferCursor > audioDataSize)
+			{
+				break;
+			}
+			AL_CHECK(alBufferData(
+			    m_Buffers[i],
+			    m_AudioFile->getFormat(),
+			    (const ALvoid*)(audioData + m_BufferCursor),
+			    (ALsizei)m_BufferSize,
+			    m_AudioFile->getFrequency()));
+
+			m_BufferCursor += m_BufferSize;
+			i++;
 		}
-		AL_CHECK(alBufferData(
-		    m_Buffers[i],
-		    m_AudioFile->getFormat(),
-		    (const ALvoid*)m_BufferCursor,
-		    (ALsizei)m_BufferSize,
-		    m_AudioFile->getFrequency()));
-
-		m_BufferCursor += m_BufferSize;
-		i++;
-	}
-
-	m_BufferQueueLength = i;
+
+		m_BufferQueueLength = i;
+	});
 }
 
 void StreamingAudioBuffer::destroyBuffers()
@@ -44,47 +45,50 @@ void StreamingAudioBuffer::destroyBuffers()
 
 void StreamingAudioBuffer::loadNewBuffers(int count, bool isLooping)
 {
-	for (int i = 0; i < count; i++)
-	{
-		m_BufferEnd = m_BufferCursor + m_BufferSize;
+	// Read through the file every time, the data may have been reimported, and shortened, since the last call
+	m_AudioFile->readAudioData([this, count, isLooping](const char* audioData, ALsizei audioDataSize) {
+		m_BufferCursor = std::min(m_BufferCursor, audioDataSize);
 
-		if (m_BufferCursor == m_AudioFile->getAudioData() + m_AudioFile->getAudioDataSize()) // Data has exhausted
+		for (int i = 0; i < count; i++)
 		{
-			if (isLooping) // Re-queue if looping
-			{
-				m_BufferCursor = m_AudioFile->getAudioData();
-			}
-			else
+			if (m_BufferCursor == audioDataSize) // Data has exhausted
 			{
-				break;
+				if (isLooping) // Re-queue if looping
+				{
+					m_BufferCursor = 0;
+				}
+				else
+				{
+					break;
+				}
 			}
-		}
 
-		if (m_BufferEnd >= m_AudioFile->getAudioData() + m_AudioFile->getAudioDataSize()) // Data not left enough to entirely fill the next buffer
-		{
-			m_BufferEnd = m_AudioFile->getAudioData() + m_AudioFile->getAudioDataSize(); // Only take what you can
-		}
+			// Only take what is left if there is not enough to entirely fill the next buffer
+			const ALsizei bufferEnd = std::min(m_BufferCursor + m_BufferSize, audioDataSize);
 
-		AL_CHECK(alBufferData(
-		    m_Buffers[i],
-		    m_AudioFile->getFormat(),
-		    m_BufferCursor,
-		    m_BufferEnd - m_BufferCursor,
-		    m_AudioFile->getFrequency()));
+			AL_CHECK(alBufferData(
+			    m_Buffers[i],
+			    m_AudioFile->getFormat(),
+			    audioData + m_BufferCursor,
+			    bufferEnd - m_BufferCursor,
+			    m_AudioFile->getFrequency()));
 
-		m_BufferCursor = m_BufferEnd;
-	}
+			m_BufferCursor = bufferEnd;
+		}
+	});
 }
 
 StreamingAudioBuffer::StreamingAudioBuffer(Ref<AudioResourceFile> audioFile)
     : AudioBuffer(audioFile)
 {
+	m_AudioFile->pin();
 	initializeBuffers();
 }
 
 StreamingAudioBuffer::~StreamingAudioBuffer()
 {
 	destroyBuffers();
+	m_AudioFile->unpin();
 }
 
 ALuint* StreamingAudioBuffer::getBuffers()
@@ -14,9 +14,9 @@ class StreamingAudioBuffer : public AudioBuffer
 	ALuint m_Buffers[BUFFER_COUNT];
 	ALsizei m_BufferSize;
 
-	const char* m_BufferCursor;
+	/// Bytes of the audio data streamed so far. Kept as an offset since the data is replaced when the file is reimported.
+	ALsizei m_BufferCursor;
 	int m_BufferQueueLength;
-	const char* m_BufferEnd;
 
 	void initializeBuffers() override;
 	void destroyBuffers() override;
@@ -0,0 +1,197 @@
+#include "cooked_cache.h"
+
+void CookedWriter::align(size_t alignment)
+{
+	m_Buffer.resize((m_Buffer.size() + alignment - 1) / alignment * alignment, 0);
+}
+
+CookedReader::CookedReader(const char* data, size_t size)
+    : m_Data(data)
+    , m_Size(size)
+{
+}
+
+const char* CookedReader::advance(size_t size)
+{
+	if (!m_IsValid || size > m_Size - m_Offset)
+	{
+		m_IsValid = false;
+		return nullptr;
+	}
+	const char* data = m_Data + m_Offset;
+	m_Offset += size;
+	return data;
+}
+
+size_t CookedReader::readCount(size_t minimumSize)
+{
+	const size_t count = read<unsigned int>();
+	if (!m_IsValid || (minimumSize && count > (m_Size - m_Offset) / minimumSize))
+	{
+		m_IsValid = false;
+		return 0;
+	}
+	return count;
+}
+
+String CookedReader::readString()
+{
+	size_t size = 0;
+	const char* data = readArray<char>(size);
+	return data ? String(data, size) : String();
+}
+
+void CookedReader::align(size_t alignment)
+{
+	const size_t aligned = (m_Offset + alignment - 1) / alignment * alignment;
+	if (aligned > m_Size)
+	{
+		m_IsValid = false;
+		return;
+	}
+	m_Offset = aligned;
+}
+
+FilePath CookedCache::GetCookedPath(const FilePath& sourcePath, const String& extension)
+{
+	FilePath relativePath = sourcePath.is_absolute() ? OS::GetRootRelativePath(sourcePath.generic_string()) : sourcePath;
+	return FilePath(COOKED_CACHE_DIRECTORY) / (relativePath.generic_string() + extension);
+}
+
+unsigned long long CookedCache::HashBuffer(const char* data, size_t size)
+{
+	// FNV-1a over 8 byte words with a final avalanche, fast enough to hash large models on every cache check
+	unsigned long long hash = 14695981039346656037ull ^ size;
+	size_t i = 0;
+	for (; i + sizeof(unsigned long long) <= size; i += sizeof(unsigned long long))
+	{
+		unsigned long long word;
+		memcpy(&word, data + i, sizeof(word));
+		hash = (hash ^ word) * 1099511628211ull;
+	}
+	for (; i < size; i++)
+	{
+		hash = (hash ^ (unsigned char)data[i]) * 1099511628211ull;
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+static long long GetSourceTime(const FilePath& sourcePath)
+{
+	return OS::GetFileLastChangedTime(sourcePath.generic_string()).time_since_epoch().count();
+}
+
+/// Overwrite the header of a cooked file in place. Does nothing while another reader has the file mapped, leaving the
+/// header to a later check.
+static void RewriteHeader(const FilePath& cookedPath, const CookedHeader& header)
+{
+	InputOutputFileStream file(OS::GetAbsolutePath(cookedPath.generic_string()), std::ios::in | std::ios::out | std::ios::binary);
+	if (file)
+	{
+		file.write((const char*)&header, sizeof(CookedHeader));
+	}
+}
+
+Ref<MappedFile> CookedCache::Open(const FilePath& sourcePath, const String& extension, unsigned int magic, unsigned int version, unsigned long long flags)
+{
+	const FilePath cookedPath = GetCookedPath(sourcePath, extension);
+	if (!OS::IsExists(cookedPath.generic_string()))
+	{
+		return nullptr;
+	}
+
+	Ref<MappedFile> cookedFile = OS::MapFile(cookedPath.generic_string());
+	if (!cookedFile || cookedFile->getSize() < COOKED_HEADER_SIZE)
+	{
+		return nullptr;
+	}
+
+	CookedHeader header;
+	memcpy(&header, cookedFile->getData(), sizeof(CookedHeader));
+	if (header.magic != magic || header.version != version || header.flags != flags)
+	{
+		return nullptr;
+	}
+
+	if (!OS::IsExists(sourcePath.generic_string()))
+	{
+		return cookedFile;
+	}
+
+	// Matching size and write time are trusted, the contents are only hashed when the source has been touched
+	std::error_code error;
+	const unsigned long long sourceSize = std::filesystem::file_size(OS::GetAbsolutePath(sourcePath.generic_string()), error);
+	if (error || header.sourceSize != sourceSize)
+	{
+		return nullptr;
+	}
+	if (header.sourceTime == GetSourceTime(sourcePath))
+	{
+		return cookedFile;
+	}
+
+	Ref<MappedFile> sourceFile = OS::MapFile(sourcePath.generic_string());
+	if (!sourceFile || header.sourceHash != HashBuffer(sourceFile->getData(), sourceFile->getSize()))
+	{
+		return nullptr;
+	}
+
+	// The source was only touched, so its new time is recorded to skip hashing it again on the next check. The cooked
+	// file is mapped again since it cannot be written while mapped.
+	header.sourceTime = GetSourceTime(sourcePath);
+	cookedFile->close();
+	RewriteHeader(cookedPath, header);
+	return OS::MapFile(cookedPath.generic_string());
+}
+
+bool CookedCache::Save(const FilePath& sourcePath, const String& extension, unsigned int magic, unsigned int version, unsigned long long flags, const CookedWriter& writer)
+{
+	Ref<MappedFile> sourceFile = OS::MapFile(sourcePath.generic_string());
+	if (!sourceFile)
+	{
+		WARN("Could not read source file for cooking: " + sourcePath.generic_string());
+		return false;
+	}
+
+	CookedHeader header;
+	header.magic = magic;
+	header.version = version;
+	header.flags = flags;
+	header.sourceHash = HashBuffer(sourceFile->getData(), sourceFile->getSize());
+	header.sourceSize = sourceFile->getSize();
+	header.sourceTime = GetSourceTime(sourcePath);
+
+	FileBuffer buffer(COOKED_HEADER_SIZE, 0);
+	memcpy(buffer.data(), &header, sizeof(CookedHeader));
+	buffer.insert(buffer.end(), writer.getBuffer().begin(), writer.getBuffer().end());
+
+	const FilePath cookedPath = OS::GetAbsolutePath(GetCookedPath(sourcePath, extension).generic_string());
+	std::error_code error;
+	std::filesystem::create_directories(cookedPath.parent_path(), error);
+
+	// Written next to the final file and renamed, so readers never see a partially written file
+	FilePath temporaryPath = cookedPath;
+	temporaryPath += ".tmp";
+	if (!OS::SaveFileAbsolute(temporaryPath, buffer.data(), buffer.size()))
+	{
+		WARN("Could not write cooked file: " + cookedPath.generic_string());
+		return false;
+	}
+	std::filesystem::rename(temporaryPath, cookedPath, error);
+	if (error)
+	{
+		WARN("Could not write cooked file: " + cookedPath.generic_string() + ": " + error.message());
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+	return true;
+}
+
+CookedReader CookedCache::GetReader(const MappedFile& cookedFile)
+{
+	return CookedReader(cookedFile.getData() + COOKED_HEADER_SIZE, cookedFile.getSize() - COOKED_HEADER_SIZE);
+}
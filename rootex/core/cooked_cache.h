@@ -0,0 +1,132 @@
+#pragma once
+
+#include "common/common.h"
+
+/// Root relative directory holding cooked files, mirroring the paths of their source files.
+#define COOKED_CACHE_DIRECTORY "cache"
+/// Bytes reserved for the header, keeping the body aligned for in place use.
+#define COOKED_HEADER_SIZE 64
+
+/// Header at the start of every cooked file.
+struct CookedHeader
+{
+	/// Identifies the kind of cooked file.
+	unsigned int magic;
+	/// Bumped whenever the layout or the cooking of a kind of file changes.
+	unsigned int version;
+	/// Import settings the file was cooked with.
+	unsigned long long flags;
+	unsigned long long sourceHash;
+	unsigned long long sourceSize;
+	long long sourceTime;
+};
+static_assert(sizeof(CookedHeader) <= COOKED_HEADER_SIZE, "CookedHeader does not fit in COOKED_HEADER_SIZE");
+
+/// Range of a cooked mesh's index blob making up one LOD.
+struct CookedLOD
+{
+	float level;
+	unsigned int offset;
+	unsigned int count;
+};
+
+/// Builds the body of a cooked file. Arrays are aligned so they can be used in place once the file is mapped.
+class CookedWriter
+{
+	FileBuffer m_Buffer;
+
+public:
+	template <class T>
+	void write(const T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Cooked values should be trivially copyable");
+		const char* bytes = (const char*)&value;
+		m_Buffer.insert(m_Buffer.end(), bytes, bytes + sizeof(T));
+	}
+
+	/// Writes the element count followed by the elements.
+	template <class T>
+	void writeArray(const T* values, size_t count)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Cooked values should be trivially copyable");
+		write((unsigned long long)count);
+		align(alignof(T) < 16 ? 16 : alignof(T));
+		const char* bytes = (const char*)values;
+		m_Buffer.insert(m_Buffer.end(), bytes, bytes + sizeof(T) * count);
+	}
+
+	template <class T>
+	void writeArray(const Vector<T>& values) { writeArray(values.data(), values.size()); }
+
+	void writeString(const String& value) { writeArray(value.data(), value.size()); }
+	void align(size_t alignment);
+
+	const FileBuffer& getBuffer() const { return m_Buffer; }
+};
+
+/// Reads a cooked file body in place. Reading past the end marks the reader invalid and returns empty values.
+class CookedReader
+{
+	const char* m_Data;
+	size_t m_Size;
+	size_t m_Offset = 0;
+	bool m_IsValid = true;
+
+	const char* advance(size_t size);
+
+public:
+	CookedReader(const char* data, size_t size);
+
+	template <class T>
+	T read()
+	{
+		T value = {};
+		if (const char* bytes = advance(sizeof(T)))
+		{
+			memcpy(&value, bytes, sizeof(T));
+		}
+		return value;
+	}
+
+	/// Returns a pointer into the file, valid for as long as the file stays mapped.
+	template <class T>
+	const T* readArray(size_t& count)
+	{
+		count = read<unsigned long long>();
+		align(alignof(T) < 16 ? 16 : alignof(T));
+		if (count > (m_Size - m_Offset) / sizeof(T))
+		{
+			m_IsValid = false;
+			count = 0;
+			return nullptr;
+		}
+		return (const T*)advance(sizeof(T) * count);
+	}
+
+	/// Read an element count written as an unsigned int. Marks the reader invalid and returns 0 if that many elements of
+	/// at least minimumSize bytes each cannot fit in what is left.
+	size_t readCount(size_t minimumSize);
+	String readString();
+	void align(size_t alignment);
+
+	bool isValid() const { return m_IsValid; }
+};
+
+/// Stores processed versions of source assets so later loads can skip importing them. Cooked files are invalidated
+/// by the content hash of their source file and by the settings they were cooked with.
+class CookedCache
+{
+public:
+	CookedCache() = delete;
+
+	static FilePath GetCookedPath(const FilePath& sourcePath, const String& extension);
+	static unsigned long long HashBuffer(const char* data, size_t size);
+
+	/// Map the cooked file for sourcePath if it is up to date with it. Returns nullptr otherwise.
+	/// A cooked file without a source file is trusted as is, which lets builds ship without source assets.
+	static Ref<MappedFile> Open(const FilePath& sourcePath, const String& extension, unsigned int magic, unsigned int version, unsigned long long flags);
+	/// Write the cooked file for sourcePath with the body built by writer.
+	static bool Save(const FilePath& sourcePath, const String& extension, unsigned int magic, unsigned int version, unsigned long long flags, const CookedWriter& writer);
+	/// Body of a file returned by Open, past the header.
+	static CookedReader GetReader(const MappedFile& cookedFile);
+};
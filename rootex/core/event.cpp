@@ -1,5 +1,31 @@
 #include "event.h"
 
+const char* EventType::Intern(const String& name, unsigned int id)
+{
+	static Mutex internMutex;
+	static HashMap<unsigned int, String> internedNames;
+
+	const char* interned = nullptr;
+	bool isCollision = false;
+	{
+		std::lock_guard<Mutex> lock(internMutex);
+		auto [found, isInserted] = internedNames.try_emplace(id, name);
+		isCollision = !isInserted && found->second != name;
+		interned = found->second.c_str();
+	}
+	if (isCollision)
+	{
+		ERR("Event name hash collision between " + String(interned) + " and " + name);
+	}
+	return interned;
+}
+
+EventType::EventType(const String& name)
+    : m_ID(HashEventName(name.c_str()))
+    , m_Name(Intern(name, m_ID))
+{
+}
+
 Event::Event(const Type& type, const Variant& data)
     : m_Type(type)
     , m_Data(data)
@@ -2,14 +2,60 @@
 
 #include "common/common.h"
 
-#define DEFINE_EVENT(eventName, ...) const static inline Event::Type eventName = #eventName
+#define DEFINE_EVENT(eventName, ...) static constexpr Event::Type eventName = #eventName
+
+/// 32-bit FNV-1a hash of a null terminated string. Usable at compile time.
+constexpr unsigned int HashEventName(const char* name)
+{
+	unsigned int hash = 2166136261u;
+	while (*name)
+	{
+		hash = (hash ^ (unsigned char)*name++) * 16777619u;
+	}
+	return hash;
+}
+
+/// Interned event name. Compared and hashed through an integer ID derived from the name.
+class EventType
+{
+	unsigned int m_ID;
+	const char* m_Name;
+
+	/// Store name for the lifetime of the application and return the stored copy.
+	static const char* Intern(const String& name, unsigned int id);
+
+public:
+	/// Hashed at compile time when name is a literal. name should outlive the type.
+	constexpr EventType(const char* name)
+	    : m_ID(HashEventName(name))
+	    , m_Name(name)
+	{
+	}
+	/// Interns a copy of name.
+	EventType(const String& name);
+
+	unsigned int getID() const { return m_ID; }
+	const char* getName() const { return m_Name; }
+
+	bool operator==(const EventType& other) const { return m_ID == other.m_ID; }
+	bool operator!=(const EventType& other) const { return m_ID != other.m_ID; }
+};
+
+namespace std
+{
+template <>
+struct hash<EventType>
+{
+	size_t operator()(const EventType& type) const { return type.getID(); }
+};
+}
 
 /// An Event that is sent out by EventManager.
 class Event
 {
 public:
-	/// String defining the type of the event.
-	typedef String Type;
+	/// Interned name defining the type of the event.
+	typedef EventType Type;
 
 private:
 	Type m_Type;
@@ -36,6 +82,9 @@ struct RootexEvents
 	/// SceneLoader opened a new Scene
 	DEFINE_EVENT(OpenedScene);
 
+	/// SceneLoader finished streaming in the Scene* passed in
+	DEFINE_EVENT(SceneStreamed, Scene*);
+
 	/// A string was printed to output
 	DEFINE_EVENT(OSPrint, String);
 
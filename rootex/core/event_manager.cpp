@@ -11,82 +11,219 @@ EventManager* EventManager::GetSingleton()
 
 void EventManager::defer(Function<void()> function)
 {
-	m_DeferList.push_back(function);
+	std::lock_guard<Mutex> lock(m_DeferMutex);
+	m_DeferList.push_back(std::move(function));
 }
 
-void EventManager::addBinder(EventBinderBase* binder)
+void EventManager::subscribe(const Event::Type& eventType, EventBinderBase* binder)
 {
-	if (m_EventBinders.find(binder) == m_EventBinders.end())
+	auto [found, isInserted] = m_Subscribers.emplace(eventType, Subscribers { eventType.getName() });
+	if (!isInserted && strcmp(found->second.name, eventType.getName()) != 0)
 	{
-		m_EventBinders[binder] = true;
+		ERR("Event name hash collision between " + String(found->second.name) + " and " + String(eventType.getName()));
+	}
+
+	Vector<EventBinderBase*>& binders = found->second.binders;
+	if (std::find(binders.begin(), binders.end(), binder) == binders.end())
+	{
+		binders.push_back(binder);
+	}
+}
+
+void EventManager::unsubscribe(const Event::Type& eventType, EventBinderBase* binder)
+{
+	auto found = m_Subscribers.find(eventType);
+	if (found == m_Subscribers.end())
+	{
+		return;
+	}
+
+	Vector<EventBinderBase*>& binders = found->second.binders;
+	auto foundBinder = std::find(binders.begin(), binders.end(), binder);
+	if (foundBinder == binders.end())
+	{
+		return;
+	}
+
+	// Erasing would shift the binders under a running dispatch
+	if (m_DispatchDepth > 0)
+	{
+		*foundBinder = nullptr;
+		m_HasRemovedSubscribers = true;
+	}
+	else
+	{
+		binders.erase(foundBinder);
 	}
 }
 
-void EventManager::removeBinder(EventBinderBase* binder)
+void EventManager::removeStaleSubscribers()
 {
-	if (m_EventBinders.find(binder) != m_EventBinders.end())
+	for (auto& [eventType, subscribers] : m_Subscribers)
 	{
-		m_EventBinders.erase(binder);
+		Vector<EventBinderBase*>& binders = subscribers.binders;
+		binders.erase(std::remove(binders.begin(), binders.end(), nullptr), binders.end());
 	}
+	m_HasRemovedSubscribers = false;
 }
 
-Variant EventManager::returnCall(const Event& event) const
+Variant EventManager::returnCall(const Event& event)
 {
-	for (auto& [binder, value] : m_EventBinders)
+	auto found = m_Subscribers.find(event.getType());
+	if (found == m_Subscribers.end())
 	{
-		if (binder->hasBinding(event.getType()))
+		return false;
+	}
+
+	m_DispatchDepth++;
+	Variant result = false;
+	const Vector<EventBinderBase*>& binders = found->second.binders;
+	for (int i = 0; i < binders.size(); i++)
+	{
+		if (binders[i])
 		{
-			return binder->handle(event);
+			result = binders[i]->handle(event);
+			break;
 		}
 	}
-	return false;
+	m_DispatchDepth--;
+
+	if (m_DispatchDepth == 0 && m_HasRemovedSubscribers)
+	{
+		removeStaleSubscribers();
+	}
+	return result;
 }
 
-void EventManager::call(const Event& event) const
+void EventManager::call(const Event& event)
 {
-	for (auto& [binder, value] : m_EventBinders)
+	// Binder lists and the dispatch depth are only touched on the main thread
+	if (std::this_thread::get_id() != m_MainThread)
+	{
+		deferredCall(event.getType(), event.getData());
+		return;
+	}
+
+	auto found = m_Subscribers.find(event.getType());
+	if (found == m_Subscribers.end())
+	{
+		return;
+	}
+
+	m_DispatchDepth++;
+	// Indexed since handlers may subscribe more binders while the loop runs
+	const Vector<EventBinderBase*>& binders = found->second.binders;
+	for (int i = 0; i < binders.size(); i++)
 	{
-		if (binder->hasBinding(event.getType()))
+		if (binders[i])
 		{
-			binder->handle(event);
+			binders[i]->handle(event);
 		}
 	}
+	m_DispatchDepth--;
+
+	if (m_DispatchDepth == 0 && m_HasRemovedSubscribers)
+	{
+		removeStaleSubscribers();
+	}
 }
 
-Variant EventManager::returnCall(const Event::Type& eventType, const Variant& data) const
+Variant EventManager::returnCall(const Event::Type& eventType, const Variant& data)
 {
 	Event event(eventType, data);
 	return returnCall(event);
 }
 
-void EventManager::call(const Event::Type& eventType, const Variant& data) const
+void EventManager::call(const Event::Type& eventType, const Variant& data)
 {
 	Event event(eventType, data);
 	call(event);
 }
 
+EventManager::DeferredEvent::DeferredEvent(const Event::Type& type, const Variant& data)
+    : event(type, data)
+{
+}
+
 void EventManager::deferredCall(Ref<Event> event)
 {
-	m_DeferredCalls.push_back(event);
+	deferredCall(event->getType(), event->getData());
 }
 
 void EventManager::deferredCall(const Event::Type& eventType, const Variant& data)
 {
-	Ref<Event> event(new Event(eventType, data));
-	deferredCall(event);
+	while (true)
+	{
+		const int index = m_CurrentDeferredQueue.load();
+		DeferredQueue& queue = m_DeferredQueues[index];
+		queue.producers.fetch_add(1);
+		// The queues may have been swapped before this thread registered itself as a producer
+		if (m_CurrentDeferredQueue.load() != index)
+		{
+			queue.producers.fetch_sub(1);
+			continue;
+		}
+
+		void* memory = queue.arena.allocate(sizeof(DeferredEvent), alignof(DeferredEvent));
+		DeferredEvent* deferredEvent = new (memory) DeferredEvent(eventType, data);
+		deferredEvent->next = queue.head.load(std::memory_order_relaxed);
+		while (!queue.head.compare_exchange_weak(deferredEvent->next, deferredEvent, std::memory_order_release, std::memory_order_relaxed))
+		{
+		}
+
+		queue.producers.fetch_sub(1, std::memory_order_release);
+		return;
+	}
 }
 
 void EventManager::dispatchDeferred()
 {
-	for (auto& function : m_DeferList)
+	// Taken out under the lock and run without it, so deferred functions can defer more
+	Vector<Function<void()>> deferList;
+	{
+		std::lock_guard<Mutex> lock(m_DeferMutex);
+		deferList.swap(m_DeferList);
+	}
+	for (auto& function : deferList)
 	{
 		function();
 	}
-	m_DeferList.clear();
 
-	for (auto& deferredEvent : m_DeferredCalls)
+	const int index = m_CurrentDeferredQueue.load();
+	m_CurrentDeferredQueue.store(1 - index);
+	DeferredQueue& queue = m_DeferredQueues[index];
+	while (queue.producers.load(std::memory_order_acquire) != 0)
+	{
+		std::this_thread::yield();
+	}
+
+	// The stack holds the latest event first, reverse it to dispatch in the order the events were deferred
+	DeferredEvent* reversed = nullptr;
+	DeferredEvent* deferredEvent = queue.head.exchange(nullptr, std::memory_order_acquire);
+	while (deferredEvent)
+	{
+		DeferredEvent* next = deferredEvent->next;
+		deferredEvent->next = reversed;
+		reversed = deferredEvent;
+		deferredEvent = next;
+	}
+
+	while (reversed)
+	{
+		DeferredEvent* next = reversed->next;
+		call(reversed->event);
+		reversed->~DeferredEvent();
+		reversed = next;
+	}
+	queue.arena.reset();
+}
+
+int EventManager::getSubscriberCount(const Event::Type& eventType) const
+{
+	auto found = m_Subscribers.find(eventType);
+	if (found == m_Subscribers.end())
 	{
-		call(*deferredEvent);
+		return 0;
 	}
-	m_DeferredCalls.clear();
+	return found->second.binders.size() - std::count(found->second.binders.begin(), found->second.binders.end(), nullptr);
 }
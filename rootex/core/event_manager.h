@@ -2,6 +2,10 @@
 
 #include "common/common.h"
 #include "event.h"
+#include "os/thread.h"
+
+/// Size of the blocks the deferred event queues carve events out of.
+#define DEFERRED_EVENT_BLOCK_SIZE (64 * 1024)
 
 class EventBinderBase
 {
@@ -11,6 +15,82 @@ public:
 	virtual Variant handle(const Event& event) = 0;
 };
 
+/// An Event dispatcher and registrar that also allows looking up registered events.
+class EventManager
+{
+	struct Subscribers
+	{
+		/// Name the event was first subscribed with, used to detect hash collisions.
+		const char* name;
+		/// Removed binders are left as nullptr while a dispatch is running.
+		Vector<EventBinderBase*> binders;
+	};
+
+	HashMap<Event::Type, Subscribers> m_Subscribers;
+	/// Thread the singleton was made on. Subscribers are only dispatched to on it.
+	std::thread::id m_MainThread = std::this_thread::get_id();
+	/// Number of dispatches running on the main thread, nested through handlers publishing events.
+	int m_DispatchDepth = 0;
+	bool m_HasRemovedSubscribers = false;
+	/// Guards m_DeferList, which is added to from worker threads.
+	Mutex m_DeferMutex;
+	Vector<Function<void()>> m_DeferList;
+
+	struct DeferredEvent
+	{
+		Event event;
+		DeferredEvent* next = nullptr;
+
+		DeferredEvent(const Event::Type& type, const Variant& data);
+	};
+
+	/// Lock-free stack of deferred events pushed by any thread, with the arena their storage comes from.
+	struct DeferredQueue
+	{
+		FrameArena arena { DEFERRED_EVENT_BLOCK_SIZE };
+		Atomic<DeferredEvent*> head = nullptr;
+		/// Threads currently pushing into this queue.
+		Atomic<int> producers = 0;
+	};
+
+	/// Producers push into the current queue while the other one is being dispatched.
+	DeferredQueue m_DeferredQueues[2];
+	Atomic<int> m_CurrentDeferredQueue = 0;
+
+	void removeStaleSubscribers();
+
+public:
+	static EventManager* GetSingleton();
+
+	/// Defer a singular function till the end of the frame. Safe to call from any thread.
+	/// Functions deferred while deferred functions are being run are run at the end of the next frame.
+	void defer(Function<void()> function);
+
+	/// Make binder handle events of eventType. Does not need to be called externally.
+	void subscribe(const Event::Type& eventType, EventBinderBase* binder);
+	void unsubscribe(const Event::Type& eventType, EventBinderBase* binder);
+
+	/// Publish an event. Returns the result of the first event handled. Only to be called from the main thread.
+	Variant returnCall(const Event& event);
+	Variant returnCall(const Event::Type& eventType, const Variant& data = 0);
+
+	/// Publish an event. Called from other threads, such as when logging from workers, the event is deferred to the
+	/// end of the frame instead.
+	void call(const Event& event);
+	void call(const Event::Type& eventType, const Variant& data = 0);
+
+	/// Publish an event that gets evaluated the end of the current frame. Safe to call from any thread.
+	/// Events deferred while deferred events are being dispatched are evaluated at the end of the next frame.
+	void deferredCall(Ref<Event> event);
+	void deferredCall(const Event::Type& eventType, const Variant& data = 0);
+
+	/// Dispatch deferred events collected so far. Only to be called from the main thread.
+	void dispatchDeferred();
+
+	/// Number of binders handling eventType.
+	int getSubscriberCount(const Event::Type& eventType) const;
+};
+
 template <class T>
 class EventBinder : public EventBinderBase
 {
@@ -19,34 +99,41 @@ class EventBinder : public EventBinderBase
 	HashMap<Event::Type, EventFunction> m_Bindings;
 
 public:
-	EventBinder()
-	{
-		EventManager::GetSingleton()->addBinder(this);
-	}
+	EventBinder() = default;
 
 	~EventBinder()
 	{
-		EventManager::GetSingleton()->removeBinder(this);
+		unbindAll();
 	}
 
 	/// Duplicate bindings will override the previous ones
 	void bind(const Event::Type& event, T* self, Variant (T::*eventFunction)(const Event*))
 	{
-		m_Bindings.emplace(event, [self, eventFunction](const Event* e) { return (self->*eventFunction)(e); });
+		bind(event, [self, eventFunction](const Event* e) { return (self->*eventFunction)(e); });
 	}
 
 	void bind(const Event::Type& event, EventFunction function)
 	{
-		m_Bindings.emplace(event, function);
+		if (m_Bindings.emplace(event, function).second)
+		{
+			EventManager::GetSingleton()->subscribe(event, this);
+		}
 	}
 
 	void unbind(const Event::Type& event)
 	{
-		m_Bindings.erase(event);
+		if (m_Bindings.erase(event))
+		{
+			EventManager::GetSingleton()->unsubscribe(event, this);
+		}
 	}
 
 	void unbindAll()
 	{
+		for (auto& [event, function] : m_Bindings)
+		{
+			EventManager::GetSingleton()->unsubscribe(event, this);
+		}
 		m_Bindings.clear();
 	}
 
@@ -60,37 +147,3 @@ public:
 		return m_Bindings.at(event.getType())(&event);
 	}
 };
-
-/// An Event dispatcher and registrar that also allows looking up registered events.
-class EventManager
-{
-	HashMap<EventBinderBase*, bool> m_EventBinders;
-	Vector<Function<void()>> m_DeferList;
-	Vector<Ref<Event>> m_DeferredCalls;
-
-public:
-	static EventManager* GetSingleton();
-
-	/// Defer a singular function till the end of the frame.
-	void defer(Function<void()> function);
-
-	/// Add an event binder which binds to several events per object. Does not need to be called externally.
-	void addBinder(EventBinderBase* binder);
-	void removeBinder(EventBinderBase* binder);
-
-	/// Publish an event. Returns the result of the first event handled.
-	Variant returnCall(const Event& event) const;
-	Variant returnCall(const Event::Type& eventType, const Variant& data = 0) const;
-
-	void call(const Event& event) const;
-	void call(const Event::Type& eventType, const Variant& data = 0) const;
-
-	/// Publish an event that gets evaluated the end of the current frame.
-	void deferredCall(Ref<Event> event);
-	void deferredCall(const Event::Type& eventType, const Variant& data = 0);
-
-	/// Dispatch deferred events collected so far.
-	void dispatchDeferred();
-
-	const HashMap<EventBinderBase*, bool>& getBinders() const { return m_EventBinders; }
-};
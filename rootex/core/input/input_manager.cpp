@@ -125,20 +125,20 @@ void InputManager::pushScheme(const String& name)
 void InputManager::mapBool(const Event::Type& action, Device device, DeviceButtonID button)
 {
 	m_InputEventNameIDs[action] = getNextID((int)device, (int)button);
-	m_InputEventIDNames[m_InputEventNameIDs[action]] = action;
+	m_InputEventIDNames.insert_or_assign(m_InputEventNameIDs[action], action);
 	if (!m_GainputMap.MapBool((gainput::UserButtonId)m_InputEventNameIDs[action], DeviceIDs[device], button))
 	{
-		WARN("Bool mapping could not done: " + action);
+		WARN("Bool mapping could not done: " + String(action.getName()));
 	}
 }
 
 void InputManager::mapFloat(const Event::Type& action, Device device, DeviceButtonID button)
 {
 	m_InputEventNameIDs[action] = getNextID((int)device, (int)button);
-	m_InputEventIDNames[m_InputEventNameIDs[action]] = action;
+	m_InputEventIDNames.insert_or_assign(m_InputEventNameIDs[action], action);
 	if (!m_GainputMap.MapFloat((gainput::UserButtonId)m_InputEventNameIDs[action], DeviceIDs[device], button))
 	{
-		WARN("Float mapping could not done: " + action);
+		WARN("Float mapping could not done: " + String(action.getName()));
 	}
 }
 
@@ -30,7 +30,7 @@ struct InputDescription
 {
 	Device device;
 	DeviceButtonID button;
-	Event::Type inputEvent;
+	String inputEvent;
 };
 
 void to_json(JSON::json& j, const InputDescription& s);
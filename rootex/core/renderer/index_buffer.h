@@ -20,5 +20,6 @@ public:
 
 	void bind() const;
 	unsigned int getCount() const;
+	DXGI_FORMAT getFormat() const { return m_Format; }
 	ID3D11Buffer* getBuffer() { return m_IndexBuffer.Get(); }
 };
@@ -13,6 +13,16 @@ void Mesh::addLOD(Ref<IndexBuffer> ib, float lodLevel)
 	});
 }
 
+size_t Mesh::getGPUMemory() const
+{
+	size_t bytes = m_VertexBuffer ? (size_t)m_VertexBuffer->getCount() * m_VertexBuffer->getStride() : 0;
+	for (auto& [meshLOD, meshLODLevel] : m_LODs)
+	{
+		bytes += (size_t)meshLOD->getCount() * (meshLOD->getFormat() == DXGI_FORMAT_R16_UINT ? 2 : 4);
+	}
+	return bytes;
+}
+
 Ref<IndexBuffer> Mesh::getLOD(float lodLevel) const
 {
 	for (auto& [meshLOD, meshLODLevel] : m_LODs)
@@ -22,4 +22,6 @@ struct Mesh
 
 	/// LOD level can range from 0.0f to 1.0f, returns the appropriate LOD
 	Ref<IndexBuffer> getLOD(float lodLevel) const;
+	/// Bytes taken by the vertex buffer and the index buffers of every LOD.
+	size_t getGPUMemory() const;
 };
@@ -0,0 +1,150 @@
+#include "resource_cache.h"
+
+ResourceCache::~ResourceCache()
+{
+	for (auto& shard : m_Shards)
+	{
+		for (auto& bucket : shard.m_Buckets)
+		{
+			Entry* entry = bucket.load(std::memory_order_relaxed);
+			while (entry)
+			{
+				Entry* next = entry->m_Next.load(std::memory_order_relaxed);
+				delete entry;
+				entry = next;
+			}
+		}
+		for (auto& entry : shard.m_Retired)
+		{
+			delete entry;
+		}
+	}
+}
+
+String ResourceCache::NormalizePath(const FilePath& path)
+{
+	return path.lexically_normal().generic_string();
+}
+
+size_t ResourceCache::Hash(ResourceFile::Type type, const String& path)
+{
+	size_t hash = std::hash<String>()(path);
+	hash ^= (size_t)type + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	return hash;
+}
+
+Ref<ResourceFile> ResourceCache::find(Shard& shard, size_t hash, ResourceFile::Type type, const String& path)
+{
+	// Announces this reader before loading any entry, pairs with the check in reclaim
+	shard.m_Readers.fetch_add(1, std::memory_order_seq_cst);
+
+	Ref<ResourceFile> file;
+	for (Entry* entry = getBucket(shard, hash).load(std::memory_order_seq_cst); entry; entry = entry->m_Next.load(std::memory_order_seq_cst))
+	{
+		if (entry->m_Hash == hash && entry->m_Type == type && entry->m_Path == path)
+		{
+			// Dead entries stay in the bucket until purged, keep looking past them
+			file = entry->m_File.lock();
+			if (file)
+			{
+				break;
+			}
+		}
+	}
+
+	shard.m_Readers.fetch_sub(1, std::memory_order_release);
+	return file;
+}
+
+Ref<ResourceFile> ResourceCache::find(ResourceFile::Type type, const String& path)
+{
+	const size_t hash = Hash(type, path);
+	return find(getShard(hash), hash, type, path);
+}
+
+void ResourceCache::purge(Shard& shard, Atomic<Entry*>& bucket)
+{
+	Atomic<Entry*>* link = &bucket;
+	while (Entry* entry = link->load(std::memory_order_relaxed))
+	{
+		if (entry->m_File.expired())
+		{
+			// Readers already past the link may still be on the entry, so it is only retired here
+			link->store(entry->m_Next.load(std::memory_order_relaxed), std::memory_order_seq_cst);
+			shard.m_Retired.push_back(entry);
+		}
+		else
+		{
+			link = &entry->m_Next;
+		}
+	}
+}
+
+void ResourceCache::reclaim(Shard& shard)
+{
+	if (shard.m_Retired.empty() || shard.m_Readers.load(std::memory_order_seq_cst) != 0)
+	{
+		return;
+	}
+
+	// No reader was walking the shard after the entries were unlinked, and new readers cannot reach them
+	for (auto& entry : shard.m_Retired)
+	{
+		delete entry;
+	}
+	shard.m_Retired.clear();
+}
+
+Ref<ResourceFile> ResourceCache::insert(ResourceFile::Type type, const String& path, const Ref<ResourceFile>& file)
+{
+	const size_t hash = Hash(type, path);
+	Shard& shard = getShard(hash);
+	std::lock_guard<Mutex> lock(shard.m_Mutex);
+
+	// Another thread may have loaded the same file meanwhile
+	if (Ref<ResourceFile> cached = find(shard, hash, type, path))
+	{
+		return cached;
+	}
+
+	Atomic<Entry*>& bucket = getBucket(shard, hash);
+	purge(shard, bucket);
+	for (int i = 0; i < RESOURCE_CACHE_PURGE_STEP; i++)
+	{
+		purge(shard, shard.m_Buckets[shard.m_PurgeCursor]);
+		shard.m_PurgeCursor = (shard.m_PurgeCursor + 1) % RESOURCE_CACHE_BUCKETS;
+	}
+
+	Entry* entry = new Entry { hash, type, path, file };
+	entry->m_Next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	bucket.store(entry, std::memory_order_seq_cst);
+
+	reclaim(shard);
+	return file;
+}
+
+void ResourceCache::forEach(const Function<void(const Ref<ResourceFile>&)>& onFile)
+{
+	Vector<Ref<ResourceFile>> files;
+	for (auto& shard : m_Shards)
+	{
+		shard.m_Readers.fetch_add(1, std::memory_order_seq_cst);
+		for (auto& bucket : shard.m_Buckets)
+		{
+			for (Entry* entry = bucket.load(std::memory_order_seq_cst); entry; entry = entry->m_Next.load(std::memory_order_seq_cst))
+			{
+				if (Ref<ResourceFile> file = entry->m_File.lock())
+				{
+					files.push_back(file);
+				}
+			}
+		}
+		shard.m_Readers.fetch_sub(1, std::memory_order_release);
+	}
+
+	// Called outside of the walk so onFile is free to load more files
+	for (auto& file : files)
+	{
+		onFile(file);
+	}
+}
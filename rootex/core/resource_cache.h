@@ -0,0 +1,65 @@
+#pragma once
+
+#include "common/common.h"
+
+#include "resource_file.h"
+
+/// Number of independently locked shards in the resource cache.
+#define RESOURCE_CACHE_SHARDS 64
+/// Fixed number of hash buckets in each shard, so readers never see the bucket array move.
+#define RESOURCE_CACHE_BUCKETS 256
+/// Buckets checked for dead entries on every insertion into a shard.
+#define RESOURCE_CACHE_PURGE_STEP 4
+
+/// Cache of loaded resource files keyed by resource type and normalized path.
+/// Lookups are lock free. Insertions lock one of many shards picked by the path hash, and remove dead entries of the
+/// shard a few buckets at a time, so no global sweep is ever needed.
+class ResourceCache
+{
+	struct Entry
+	{
+		size_t m_Hash;
+		ResourceFile::Type m_Type;
+		String m_Path;
+		Weak<ResourceFile> m_File;
+		Atomic<Entry*> m_Next = nullptr;
+	};
+
+	struct Shard
+	{
+		Mutex m_Mutex;
+		Atomic<Entry*> m_Buckets[RESOURCE_CACHE_BUCKETS] = {};
+		/// Readers currently walking the buckets. Unlinked entries are only deleted once none are.
+		Atomic<int> m_Readers = 0;
+		Vector<Entry*> m_Retired;
+		int m_PurgeCursor = 0;
+	};
+
+	Shard m_Shards[RESOURCE_CACHE_SHARDS];
+
+	static size_t Hash(ResourceFile::Type type, const String& path);
+
+	Shard& getShard(size_t hash) { return m_Shards[hash % RESOURCE_CACHE_SHARDS]; }
+	Atomic<Entry*>& getBucket(Shard& shard, size_t hash) { return shard.m_Buckets[(hash / RESOURCE_CACHE_SHARDS) % RESOURCE_CACHE_BUCKETS]; }
+	Ref<ResourceFile> find(Shard& shard, size_t hash, ResourceFile::Type type, const String& path);
+	/// Unlink dead entries of a bucket. Expects the shard to be locked.
+	void purge(Shard& shard, Atomic<Entry*>& bucket);
+	/// Delete unlinked entries if no reader can still be walking over them. Expects the shard to be locked.
+	void reclaim(Shard& shard);
+
+public:
+	/// Path used as the cache key, and as the path of the files loaded through the cache.
+	static String NormalizePath(const FilePath& path);
+
+	ResourceCache() = default;
+	ResourceCache(ResourceCache&) = delete;
+	~ResourceCache();
+
+	/// Returns the live file cached for the normalized path, or nullptr.
+	Ref<ResourceFile> find(ResourceFile::Type type, const String& path);
+	/// Cache file unless a live file for the same path was cached first, in which case that file is returned instead.
+	Ref<ResourceFile> insert(ResourceFile::Type type, const String& path, const Ref<ResourceFile>& file);
+
+	/// Calls onFile on every live cached file.
+	void forEach(const Function<void(const Ref<ResourceFile>&)>& onFile);
+};
@@ -0,0 +1,121 @@
+#include "resource_dependency_graph.h"
+
+unsigned int ResourceDependencyGraph::getNode(const ResourceKey& key)
+{
+	auto&& found = m_NodeIndices.find(key);
+	if (found != m_NodeIndices.end())
+	{
+		return found->second;
+	}
+
+	m_Nodes.push_back({ key });
+	m_NodeIndices[key] = m_Nodes.size() - 1;
+	return m_Nodes.size() - 1;
+}
+
+void ResourceDependencyGraph::addDependency(const ResourceKey& dependent, const ResourceKey& dependency)
+{
+	std::lock_guard<Mutex> lock(m_Mutex);
+	const unsigned int from = getNode(dependent);
+	const unsigned int to = getNode(dependency);
+	if (from == to)
+	{
+		return;
+	}
+
+	// Files depend on a handful of others, a linear search beats hashing here
+	Vector<unsigned int>& dependencies = m_Nodes[from].m_Dependencies;
+	if (std::find(dependencies.begin(), dependencies.end(), to) != dependencies.end())
+	{
+		return;
+	}
+	dependencies.push_back(to);
+	m_Nodes[to].m_Dependents.push_back(from);
+	m_EdgeCount++;
+}
+
+void ResourceDependencyGraph::clearDependencies(const ResourceKey& dependent)
+{
+	std::lock_guard<Mutex> lock(m_Mutex);
+	auto&& found = m_NodeIndices.find(dependent);
+	if (found == m_NodeIndices.end())
+	{
+		return;
+	}
+
+	const unsigned int from = found->second;
+	for (unsigned int to : m_Nodes[from].m_Dependencies)
+	{
+		Vector<unsigned int>& dependents = m_Nodes[to].m_Dependents;
+		dependents.erase(std::find(dependents.begin(), dependents.end(), from));
+	}
+	m_EdgeCount -= m_Nodes[from].m_Dependencies.size();
+	m_Nodes[from].m_Dependencies.clear();
+}
+
+void ResourceDependencyGraph::visitDependents(unsigned int node, Vector<char>& visited, Vector<unsigned int>& postOrder) const
+{
+	visited[node] = true;
+	for (unsigned int dependent : m_Nodes[node].m_Dependents)
+	{
+		if (!visited[dependent])
+		{
+			visitDependents(dependent, visited, postOrder);
+		}
+	}
+	postOrder.push_back(node);
+}
+
+Vector<ResourceKey> ResourceDependencyGraph::getDependentsInOrder(const Vector<ResourceKey>& changed) const
+{
+	std::lock_guard<Mutex> lock(m_Mutex);
+	Vector<char> visited(m_Nodes.size(), false);
+	Vector<unsigned int> postOrder;
+	Vector<ResourceKey> ordered;
+	for (auto& key : changed)
+	{
+		auto&& found = m_NodeIndices.find(key);
+		if (found == m_NodeIndices.end())
+		{
+			// Not part of the graph, nothing depends on it
+			if (std::find(ordered.begin(), ordered.end(), key) == ordered.end())
+			{
+				ordered.push_back(key);
+			}
+		}
+		else if (!visited[found->second])
+		{
+			visitDependents(found->second, visited, postOrder);
+		}
+	}
+
+	// A file finishes after everything depending on it, so the reversed post order puts dependencies first
+	for (auto node = postOrder.rbegin(); node != postOrder.rend(); node++)
+	{
+		ordered.push_back(m_Nodes[*node].m_Key);
+	}
+	return ordered;
+}
+
+ResourceDependencyGraph::Statistics ResourceDependencyGraph::getStatistics() const
+{
+	std::lock_guard<Mutex> lock(m_Mutex);
+	Statistics statistics;
+	statistics.nodeCount = m_Nodes.size();
+	statistics.edgeCount = m_EdgeCount;
+
+	size_t memoryBytes = m_Nodes.capacity() * sizeof(Node);
+	for (auto& node : m_Nodes)
+	{
+		memoryBytes += node.m_Key.second.capacity();
+		memoryBytes += (node.m_Dependencies.capacity() + node.m_Dependents.capacity()) * sizeof(unsigned int);
+	}
+	// Each index entry is a heap node holding the key, the index and a link
+	for (auto& [key, index] : m_NodeIndices)
+	{
+		memoryBytes += sizeof(ResourceKey) + sizeof(unsigned int) + sizeof(void*) + key.second.capacity();
+	}
+	memoryBytes += m_NodeIndices.bucket_count() * sizeof(void*);
+	statistics.memoryBytes = memoryBytes;
+	return statistics;
+}
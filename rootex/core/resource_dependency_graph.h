@@ -0,0 +1,58 @@
+#pragma once
+
+#include "common/common.h"
+
+#include "resource_file.h"
+
+/// Identifies a file in the dependency graph. Files that are not resource files, like shaders, use Type::None.
+typedef Pair<ResourceFile::Type, String> ResourceKey;
+
+struct ResourceKeyHash
+{
+	size_t operator()(const ResourceKey& key) const { return std::hash<String>()(key.second) ^ ((size_t)key.first * 0x9e3779b9); }
+};
+
+/// Records which files were loaded by which other files, in both directions, so a change to a file can be
+/// propagated to exactly the files depending on it. Internally synchronised.
+class ResourceDependencyGraph
+{
+	struct Node
+	{
+		ResourceKey m_Key;
+		/// Files this file loaded.
+		Vector<unsigned int> m_Dependencies;
+		/// Files that loaded this file.
+		Vector<unsigned int> m_Dependents;
+	};
+
+	mutable Mutex m_Mutex;
+	Vector<Node> m_Nodes;
+	HashMap<ResourceKey, unsigned int, ResourceKeyHash> m_NodeIndices;
+	size_t m_EdgeCount = 0;
+
+	unsigned int getNode(const ResourceKey& key);
+	void visitDependents(unsigned int node, Vector<char>& visited, Vector<unsigned int>& postOrder) const;
+
+public:
+	struct Statistics
+	{
+		size_t nodeCount;
+		size_t edgeCount;
+		/// Approximate heap memory used by the graph.
+		size_t memoryBytes;
+	};
+
+	ResourceDependencyGraph() = default;
+	ResourceDependencyGraph(ResourceDependencyGraph&) = delete;
+	~ResourceDependencyGraph() = default;
+
+	/// Record that dependent loaded dependency.
+	void addDependency(const ResourceKey& dependent, const ResourceKey& dependency);
+	/// Forget the files dependent loaded, before it loads them again.
+	void clearDependencies(const ResourceKey& dependent);
+	/// Returns the changed files and everything depending on them transitively, each once, ordered so every file
+	/// comes after the files it depends on. Cycles are broken arbitrarily.
+	Vector<ResourceKey> getDependentsInOrder(const Vector<ResourceKey>& changed) const;
+
+	Statistics getStatistics() const;
+};
@@ -1,11 +1,19 @@
 #include "resource_file.h"
 
+#include "os/virtual_file_system.h"
+
 ResourceFile::ResourceFile(const Type& type, const FilePath& path)
     : m_Type(type)
     , m_Path(path.generic_string())
+    , m_LastUsedTime(GetUsedTimeNow())
 {
 	m_LastReadTime = OS::s_FileSystemClock.now();
-	m_LastChangedTime = OS::GetFileLastChangedTime(m_Path.generic_string());
+	m_LastChangedTime = VirtualFileSystem::GetFileLastChangedTime(m_Path.generic_string());
+}
+
+long long ResourceFile::GetUsedTimeNow()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
 FilePath ResourceFile::getPath() const
@@ -20,14 +28,14 @@ ResourceFile::Type ResourceFile::getType() const
 
 const FileTimePoint& ResourceFile::getLastChangedTime()
 {
-	m_LastChangedTime = OS::GetFileLastChangedTime(m_Path.generic_string());
+	m_LastChangedTime = VirtualFileSystem::GetFileLastChangedTime(m_Path.generic_string());
 	return m_LastChangedTime;
 }
 
 void ResourceFile::reimport()
 {
 	m_LastReadTime = OS::s_FileSystemClock.now();
-	m_LastChangedTime = OS::GetFileLastChangedTime(m_Path.generic_string());
+	m_LastChangedTime = VirtualFileSystem::GetFileLastChangedTime(m_Path.generic_string());
 }
 
 bool ResourceFile::save()
@@ -39,11 +47,6 @@ void ResourceFile::draw()
 {
 }
 
-bool ResourceFile::isDirty()
-{
-	return getLastReadTime() < getLastChangedTime();
-}
-
 void to_json(JSON::json& j, const ResourceFile::Type& t)
 {
 	j = (int)t;
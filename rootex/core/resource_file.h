@@ -52,6 +52,8 @@ public:
 	FilePath m_Path;
 	FileTimePoint m_LastReadTime;
 	FileTimePoint m_LastChangedTime;
+	/// Milliseconds on a steady clock when the file was last requested from ResourceLoader.
+	Atomic<long long> m_LastUsedTime;
 
 protected:
 	explicit ResourceFile(const Type& type, const FilePath& path);
@@ -63,13 +65,26 @@ public:
 	explicit ResourceFile(const ResourceFile&&) = delete;
 	virtual ~ResourceFile() = default;
 
-	/// Reload the file buffer from disk.
+	/// Reload the file buffer from disk. ResourceLoader calls this on its own when the file changes on disk.
 	virtual void reimport();
+	/// Write the file to disk. The write is reported like any other change, so the file and the files depending on it
+	/// are reimported at the start of the next frame.
 	virtual bool save();
 	virtual void draw();
 
-	/// If the file has been changed on disk.
-	bool isDirty();
+	/// Bytes of file data held in system memory.
+	virtual size_t getCPUMemory() const { return 0; }
+	/// Approximate bytes of file data uploaded to the GPU.
+	virtual size_t getGPUMemory() const { return 0; }
+	/// Release the system memory copy of data already uploaded, to be loaded again when next needed.
+	/// Returns false if the file keeps no such copy or it is in use.
+	virtual bool demote() { return false; }
+	virtual bool isDemoted() const { return false; }
+
+	static long long GetUsedTimeNow();
+	/// Mark the file as just used, for least recently used eviction.
+	void touch() { m_LastUsedTime = GetUsedTimeNow(); }
+	long long getLastUsedTime() const { return m_LastUsedTime; }
 
 	FilePath getPath() const;
 	Type getType() const;
@@ -6,6 +6,7 @@
 #include "renderer/vertex_buffer.h"
 #include "renderer/index_buffer.h"
 #include "utility/maths.h"
+#include "cooked_cache.h"
 
 #include "assimp/Importer.hpp"
 #include "assimp/postprocess.h"
@@ -14,6 +15,31 @@
 
 #include "Tracy/Tracy.hpp"
 
+/// Assimp post processing applied to animated models, also part of the key of cooked animated models.
+#define ANIMATED_MODEL_IMPORT_FLAGS (aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SplitLargeMeshes | aiProcess_GenBoundingBoxes | aiProcess_OptimizeMeshes | aiProcess_CalcTangentSpace | aiProcess_ValidateDataStructure | aiProcess_ConvertToLeftHanded)
+#define ANIMATED_MODEL_COOKED_EXTENSION ".ranim"
+#define ANIMATED_MODEL_COOKED_MAGIC 0x4d4e4152 // "RANM"
+/// Bump when the cooked layout, the vertex format or the LOD generation changes.
+#define ANIMATED_MODEL_COOKED_VERSION 1
+
+struct CookedSkeletonNode
+{
+	Matrix localBindTransform;
+	int parent;
+	int bone;
+};
+
+/// Ranges of an animation's keyframe arrays belonging to one animated node.
+struct CookedChannel
+{
+	unsigned int translationOffset;
+	unsigned int translationCount;
+	unsigned int rotationOffset;
+	unsigned int rotationCount;
+	unsigned int scalingOffset;
+	unsigned int scalingCount;
+};
+
 AnimatedModelResourceFile::AnimatedModelResourceFile(const FilePath& path)
     : ResourceFile(Type::AnimatedModel, path)
 {
@@ -50,16 +76,21 @@ float AnimatedModelResourceFile::getAnimationEndTime(const String& animationName
 	return m_Animations.at(animationName).getEndTime();
 }
 
-void AnimatedModelResourceFile::setNodeHierarchy(aiNode* currentAiNode, Ptr<SkeletonNode>& currentNode)
+void AnimatedModelResourceFile::setNodeHierarchy(const aiNode* currentAiNode, int parent, const HashMap<String, unsigned int>& boneMapping)
 {
-	currentNode->m_Name = String(currentAiNode->mName.C_Str());
-	currentNode->m_LocalBindTransform = AiMatrixToMatrix(currentAiNode->mTransformation);
+	const int index = m_Skeleton.size();
+
+	SkeletonNode node;
+	node.m_Name = String(currentAiNode->mName.C_Str());
+	node.m_LocalBindTransform = AiMatrixToMatrix(currentAiNode->mTransformation);
+	node.m_Parent = parent;
+	auto bone = boneMapping.find(node.m_Name);
+	node.m_Bone = bone == boneMapping.end() ? -1 : bone->second;
+	m_Skeleton.push_back(node);
 
-	currentNode->m_Children.resize(currentAiNode->mNumChildren);
 	for (int i = 0; i < currentAiNode->mNumChildren; i++)
 	{
-		currentNode->m_Children[i] = std::make_unique<SkeletonNode>(SkeletonNode());
-		setNodeHierarchy(currentAiNode->mChildren[i], currentNode->m_Children[i]);
+		setNodeHierarchy(currentAiNode->mChildren[i], index, boneMapping);
 	}
 }
 
@@ -67,8 +98,7 @@ void AnimatedModelResourceFile::getFinalTransforms(Vector<Matrix>& transforms, c
 {
 	ZoneScoped;
 
-	bool rootFoundFlag = false;
-	setAnimationTransforms(m_RootNode, currentTime, animationName, Matrix::Identity, transitionTightness, rootExclusion, rootFoundFlag);
+	setAnimationTransforms(currentTime, animationName, transitionTightness, rootExclusion);
 
 	for (unsigned int i = 0; i < getBoneCount(); i++)
 	{
@@ -77,57 +107,289 @@ void AnimatedModelResourceFile::getFinalTransforms(Vector<Matrix>& transforms, c
 	}
 }
 
-void AnimatedModelResourceFile::setAnimationTransforms(Ptr<SkeletonNode>& node, float currentTime, const String& animationName, const Matrix& parentModelTransform, float transitionTightness, RootExclusion rootExclusion, bool isRootFound)
+void AnimatedModelResourceFile::setAnimationTransforms(float currentTime, const String& animationName, float transitionTightness, RootExclusion rootExclusion)
+{
+	SkeletalAnimation& animation = m_Animations[animationName];
+
+	// Depth-first order guarantees the parent transform is ready before its children
+	for (int i = 0; i < m_Skeleton.size(); i++)
+	{
+		const SkeletonNode& node = m_Skeleton[i];
+
+		Matrix boneSpaceTransform = animation.interpolate(i, currentTime);
+		if (boneSpaceTransform == Matrix::Identity)
+		{
+			boneSpaceTransform = node.m_LocalBindTransform;
+		}
+
+		const bool hasParent = node.m_Parent != -1;
+		Matrix& currentModelTransform = m_NodeTransforms[i];
+		currentModelTransform = hasParent ? boneSpaceTransform * m_NodeTransforms[node.m_Parent] : boneSpaceTransform;
+
+		bool isRootFound = hasParent && m_IsRootFound[node.m_Parent];
+		if (node.m_Bone != -1)
+		{
+			if (!isRootFound)
+			{
+				switch (rootExclusion)
+				{
+				case RootExclusion::None:
+					m_RootInverseTransform = Matrix::Identity;
+					break;
+				case RootExclusion::Translation:
+					m_RootInverseTransform = Matrix::CreateTranslation(-currentModelTransform.Translation());
+					break;
+				case RootExclusion::All:
+					m_RootInverseTransform = currentModelTransform.Invert();
+					break;
+				default:
+					WARN("Unknown root exclusion setting found");
+					break;
+				}
+
+				isRootFound = true;
+			}
+
+			Matrix& animationMatrix = m_AnimationTransforms[node.m_Bone];
+			animationMatrix = Interpolate(animationMatrix, currentModelTransform, transitionTightness);
+		}
+		m_IsRootFound[i] = isRootFound;
+	}
+}
+
+void AnimatedModelResourceFile::reimport()
+{
+	ResourceFile::reimport();
+
+	if (!loadCooked())
+	{
+		importModel();
+	}
+	m_NodeTransforms.resize(m_Skeleton.size());
+	m_IsRootFound.resize(m_Skeleton.size());
+}
+
+size_t AnimatedModelResourceFile::getCPUMemory() const
 {
-	Matrix boneSpaceTransform = m_Animations[animationName].interpolate(node->m_Name.c_str(), currentTime);
-	if (boneSpaceTransform == Matrix::Identity)
+	size_t bytes = (m_BoneOffsets.capacity() + m_AnimationTransforms.capacity() + m_NodeTransforms.capacity()) * sizeof(Matrix);
+	bytes += m_IsRootFound.capacity() / 8;
+	for (auto& node : m_Skeleton)
 	{
-		boneSpaceTransform = node->m_LocalBindTransform;
+		bytes += sizeof(SkeletonNode) + node.m_Name.capacity();
+	}
+	for (auto& [name, animation] : m_Animations)
+	{
+		for (auto& boneAnimation : animation.getChannels())
+		{
+			bytes += boneAnimation.getTranslationKeyframes().capacity() * sizeof(TranslationKeyframe);
+			bytes += boneAnimation.getRotationKeyframes().capacity() * sizeof(RotationKeyframe);
+			bytes += boneAnimation.getScalingKeyframes().capacity() * sizeof(ScalingKeyframe);
+		}
+	}
+	return bytes;
+}
+
+size_t AnimatedModelResourceFile::getGPUMemory() const
+{
+	size_t bytes = 0;
+	for (auto& [material, meshes] : m_Meshes)
+	{
+		for (auto& mesh : meshes)
+		{
+			bytes += mesh.getGPUMemory();
+		}
+	}
+	return bytes;
+}
+
+void AnimatedModelResourceFile::addMesh(const Ref<AnimatedBasicMaterialResourceFile>& material, const Mesh& mesh)
+{
+	for (auto& materialModels : getMeshes())
+	{
+		if (materialModels.first == material)
+		{
+			materialModels.second.push_back(mesh);
+			return;
+		}
+	}
+
+	if (material)
+	{
+		getMeshes().push_back(Pair<Ref<AnimatedBasicMaterialResourceFile>, Vector<Mesh>>(material, { mesh }));
+	}
+}
+
+bool AnimatedModelResourceFile::loadCooked()
+{
+	ZoneScoped;
+	Ref<MappedFile> cookedFile = CookedCache::Open(getPath(), ANIMATED_MODEL_COOKED_EXTENSION, ANIMATED_MODEL_COOKED_MAGIC, ANIMATED_MODEL_COOKED_VERSION, ANIMATED_MODEL_IMPORT_FLAGS);
+	if (!cookedFile)
+	{
+		return false;
+	}
+
+	struct CookedMesh
+	{
+		String materialPath;
+		BoundingBox boundingBox;
+		const AnimatedVertexData* vertices;
+		size_t vertexCount;
+		const unsigned int* indices;
+		size_t indexCount;
+		const CookedLOD* lods;
+		size_t lodCount;
+	};
+
+	// Read everything before touching the loaded data so a stale or damaged file can fall back to importing
+	CookedReader reader = CookedCache::GetReader(*cookedFile);
+	// Counts are bounded by what is left of the file, each mesh holds at least its bounding box and each string its length
+	Vector<CookedMesh> cookedMeshes(reader.readCount(sizeof(BoundingBox)));
+	for (auto& cookedMesh : cookedMeshes)
+	{
+		cookedMesh.materialPath = reader.readString();
+		cookedMesh.boundingBox = reader.read<BoundingBox>();
+		cookedMesh.vertices = reader.readArray<AnimatedVertexData>(cookedMesh.vertexCount);
+		cookedMesh.indices = reader.readArray<unsigned int>(cookedMesh.indexCount);
+		cookedMesh.lods = reader.readArray<CookedLOD>(cookedMesh.lodCount);
+
+		if (!reader.isValid())
+		{
+			break;
+		}
+		for (size_t i = 0; i < cookedMesh.lodCount; i++)
+		{
+			if ((size_t)cookedMesh.lods[i].offset + cookedMesh.lods[i].count > cookedMesh.indexCount)
+			{
+				WARN("Cooked animated model is damaged, reimporting: " + getPath().generic_string());
+				return false;
+			}
+		}
+		if (!OS::IsExists(cookedMesh.materialPath))
+		{
+			return false;
+		}
 	}
 
-	Matrix currentModelTransform = boneSpaceTransform * parentModelTransform;
+	size_t boneCount = 0;
+	const Matrix* boneOffsets = reader.readArray<Matrix>(boneCount);
 
-	if (m_BoneMapping.find(node->m_Name.c_str()) != m_BoneMapping.end())
+	Vector<String> nodeNames(reader.readCount(sizeof(unsigned long long)));
+	for (auto& nodeName : nodeNames)
 	{
-		if (!isRootFound)
+		nodeName = reader.readString();
+	}
+	size_t nodeCount = 0;
+	const CookedSkeletonNode* nodes = reader.readArray<CookedSkeletonNode>(nodeCount);
+	if (nodeCount != nodeNames.size())
+	{
+		WARN("Cooked animated model is damaged, reimporting: " + getPath().generic_string());
+		return false;
+	}
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		if (nodes[i].parent < -1 || nodes[i].parent >= (int)i || nodes[i].bone < -1 || nodes[i].bone >= (int)boneCount)
 		{
-			switch (rootExclusion)
+			WARN("Cooked animated model is damaged, reimporting: " + getPath().generic_string());
+			return false;
+		}
+	}
+
+	HashMap<String, SkeletalAnimation> animations;
+	const size_t animationCount = reader.readCount(sizeof(unsigned long long));
+	for (size_t i = 0; i < animationCount && reader.isValid(); i++)
+	{
+		const String animationName = reader.readString();
+		const float duration = reader.read<float>();
+
+		Vector<String> channelNames(reader.readCount(sizeof(unsigned long long)));
+		for (auto& channelName : channelNames)
+		{
+			channelName = reader.readString();
+		}
+
+		size_t channelCount = 0;
+		size_t translationCount = 0;
+		size_t rotationCount = 0;
+		size_t scalingCount = 0;
+		const CookedChannel* channels = reader.readArray<CookedChannel>(channelCount);
+		const TranslationKeyframe* translations = reader.readArray<TranslationKeyframe>(translationCount);
+		const RotationKeyframe* rotations = reader.readArray<RotationKeyframe>(rotationCount);
+		const ScalingKeyframe* scalings = reader.readArray<ScalingKeyframe>(scalingCount);
+		if (!reader.isValid() || channelCount != channelNames.size())
+		{
+			break;
+		}
+
+		SkeletalAnimation animation;
+		animation.setDuration(duration);
+		for (size_t j = 0; j < channelCount; j++)
+		{
+			const CookedChannel& channel = channels[j];
+			if ((size_t)channel.translationOffset + channel.translationCount > translationCount
+			    || (size_t)channel.rotationOffset + channel.rotationCount > rotationCount
+			    || (size_t)channel.scalingOffset + channel.scalingCount > scalingCount)
 			{
-			case RootExclusion::None:
-				m_RootInverseTransform = Matrix::Identity;
-				break;
-			case RootExclusion::Translation:
-				m_RootInverseTransform = Matrix::CreateTranslation(-currentModelTransform.Translation());
-				break;
-			case RootExclusion::All:
-				m_RootInverseTransform = currentModelTransform.Invert();
-				break;
-			default:
-				WARN("Unknown root exclusion setting found");
-				break;
+				WARN("Cooked animated model is damaged, reimporting: " + getPath().generic_string());
+				return false;
 			}
 
-			isRootFound = true;
+			BoneAnimation boneAnims;
+			boneAnims.setTranslationKeyframes(translations + channel.translationOffset, channel.translationCount);
+			boneAnims.setRotationKeyframes(rotations + channel.rotationOffset, channel.rotationCount);
+			boneAnims.setScalingKeyframes(scalings + channel.scalingOffset, channel.scalingCount);
+			animation.addBoneAnimation(channelNames[j], boneAnims);
 		}
+		animations[animationName] = animation;
+	}
 
-		Matrix& animationMatrix = m_AnimationTransforms[m_BoneMapping[node->m_Name]];
-		animationMatrix = Interpolate(animationMatrix, currentModelTransform, transitionTightness);
+	if (!reader.isValid())
+	{
+		WARN("Cooked animated model is damaged, reimporting: " + getPath().generic_string());
+		return false;
 	}
 
-	for (auto& child : node->m_Children)
+	m_Meshes.clear();
+	for (auto& cookedMesh : cookedMeshes)
 	{
-		setAnimationTransforms(child, currentTime, animationName, currentModelTransform, transitionTightness, rootExclusion, isRootFound);
+		Mesh extractedMesh;
+		extractedMesh.m_VertexBuffer.reset(new VertexBuffer((const char*)cookedMesh.vertices, cookedMesh.vertexCount, sizeof(AnimatedVertexData), D3D11_USAGE_IMMUTABLE, 0));
+		for (size_t i = 0; i < cookedMesh.lodCount; i++)
+		{
+			const CookedLOD& lod = cookedMesh.lods[i];
+			extractedMesh.addLOD(std::make_shared<IndexBuffer>((const int*)cookedMesh.indices + lod.offset, lod.count), lod.level);
+		}
+		extractedMesh.m_BoundingBox = cookedMesh.boundingBox;
+
+		addMesh(ResourceLoader::CreateAnimatedBasicMaterialResourceFile(cookedMesh.materialPath), extractedMesh);
 	}
+
+	m_BoneOffsets.assign(boneOffsets, boneOffsets + boneCount);
+	m_AnimationTransforms.clear();
+	m_AnimationTransforms.resize(boneCount);
+	m_RootInverseTransform = Matrix::Identity;
+
+	m_Skeleton.resize(nodeCount);
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		m_Skeleton[i].m_Name = nodeNames[i];
+		m_Skeleton[i].m_LocalBindTransform = nodes[i].localBindTransform;
+		m_Skeleton[i].m_Parent = nodes[i].parent;
+		m_Skeleton[i].m_Bone = nodes[i].bone;
+	}
+
+	m_Animations = std::move(animations);
+	for (auto& [name, animation] : m_Animations)
+	{
+		animation.bindSkeleton(m_Skeleton);
+	}
+	return true;
 }
 
-void AnimatedModelResourceFile::reimport()
+void AnimatedModelResourceFile::importModel()
 {
-	ResourceFile::reimport();
-
+	ZoneScoped;
 	Assimp::Importer animatedModelLoader;
-	const aiScene* scene = animatedModelLoader.ReadFile(
-	    getPath().generic_string(),
-	    aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SplitLargeMeshes | aiProcess_GenBoundingBoxes | aiProcess_OptimizeMeshes | aiProcess_CalcTangentSpace | aiProcess_ValidateDataStructure | aiProcess_ConvertToLeftHanded);
+	const aiScene* scene = animatedModelLoader.ReadFile(getPath().generic_string(), ANIMATED_MODEL_IMPORT_FLAGS);
 
 	if (!scene)
 	{
@@ -141,12 +403,16 @@ void AnimatedModelResourceFile::reimport()
 		return;
 	}
 
+	CookedWriter writer;
+	writer.write(scene->mNumMeshes);
+
 	unsigned int boneCount = 0;
+	HashMap<String, unsigned int> boneMapping;
 	m_Meshes.clear();
-	m_BoneMapping.clear();
 	m_BoneOffsets.clear();
 	m_AnimationTransforms.clear();
 	m_RootInverseTransform = Matrix::Identity;
+	m_Skeleton.clear();
 	m_Animations.clear();
 
 	for (int i = 0; i < scene->mNumMeshes; i++)
@@ -355,19 +621,19 @@ void AnimatedModelResourceFile::reimport()
 			unsigned int boneIndex = 0;
 			const aiBone* bone = mesh->mBones[j];
 
-			if (m_BoneMapping.find(bone->mName.C_Str()) == m_BoneMapping.end())
+			if (boneMapping.find(bone->mName.C_Str()) == boneMapping.end())
 			{
 				boneIndex = boneCount;
 				boneCount++;
 
-				m_BoneMapping[bone->mName.C_Str()] = boneIndex;
+				boneMapping[bone->mName.C_Str()] = boneIndex;
 
 				Matrix offsetMatrix = AiMatrixToMatrix(bone->mOffsetMatrix);
 				m_BoneOffsets.push_back(offsetMatrix);
 			}
 			else
 			{
-				boneIndex = m_BoneMapping[bone->mName.C_Str()];
+				boneIndex = boneMapping[bone->mName.C_Str()];
 			}
 
 			for (int weightIndex = 0; weightIndex < bone->mNumWeights; weightIndex++)
@@ -398,11 +664,17 @@ void AnimatedModelResourceFile::reimport()
 		Mesh extractedMesh;
 		extractedMesh.m_VertexBuffer.reset(new VertexBuffer((const char*)vertices.data(), vertices.size(), sizeof(AnimatedVertexData), D3D11_USAGE_IMMUTABLE, 0));
 		extractedMesh.addLOD(std::make_shared<IndexBuffer>(indices), 1.0f);
+
+		Vector<CookedLOD> cookedLODs = { { 1.0f, 0, (unsigned int)indices.size() } };
+		Vector<unsigned int> cookedIndices = indices;
 		for (int i = 0; i < MAX_LOD_COUNT - 1; i++)
 		{
 			if (!lods[i].empty())
 			{
 				extractedMesh.addLOD(std::make_shared<IndexBuffer>(lods[i]), lodLevels[i]);
+
+				cookedLODs.push_back({ lodLevels[i], (unsigned int)cookedIndices.size(), (unsigned int)lods[i].size() });
+				cookedIndices.insert(cookedIndices.end(), lods[i].begin(), lods[i].end());
 			}
 		}
 		Vector3 max = { mesh->mAABB.mMax.x, mesh->mAABB.mMax.y, mesh->mAABB.mMax.z };
@@ -419,25 +691,16 @@ void AnimatedModelResourceFile::reimport()
 		extractedMesh.m_BoundingBox.Extents.y = abs(extractedMesh.m_BoundingBox.Extents.y);
 		extractedMesh.m_BoundingBox.Extents.z = abs(extractedMesh.m_BoundingBox.Extents.z);
 
-		bool found = false;
-		for (auto& materialModels : getMeshes())
-		{
-			if (materialModels.first == extractedMaterial)
-			{
-				found = true;
-				materialModels.second.push_back(extractedMesh);
-				break;
-			}
-		}
+		writer.writeString(materialPath);
+		writer.write(extractedMesh.m_BoundingBox);
+		writer.writeArray(vertices);
+		writer.writeArray(cookedIndices);
+		writer.writeArray(cookedLODs);
 
-		if (!found && extractedMaterial)
-		{
-			getMeshes().push_back(Pair<Ref<AnimatedBasicMaterialResourceFile>, Vector<Mesh>>(extractedMaterial, { extractedMesh }));
-		}
+		addMesh(extractedMaterial, extractedMesh);
 	}
 
-	m_RootNode = std::make_unique<SkeletonNode>(SkeletonNode());
-	setNodeHierarchy(scene->mRootNode, m_RootNode);
+	setNodeHierarchy(scene->mRootNode, -1, boneMapping);
 
 	m_AnimationTransforms.resize(boneCount);
 
@@ -499,6 +762,52 @@ void AnimatedModelResourceFile::reimport()
 			}
 			animation.addBoneAnimation(nodeAnim->mNodeName.C_Str(), boneAnims);
 		}
+		animation.bindSkeleton(m_Skeleton);
 		m_Animations[anim->mName.C_Str()] = animation;
 	}
+
+	writer.writeArray(m_BoneOffsets);
+	Vector<CookedSkeletonNode> cookedNodes;
+	writer.write((unsigned int)m_Skeleton.size());
+	for (auto& node : m_Skeleton)
+	{
+		writer.writeString(node.m_Name);
+		cookedNodes.push_back({ node.m_LocalBindTransform, node.m_Parent, node.m_Bone });
+	}
+	writer.writeArray(cookedNodes);
+
+	writer.write((unsigned int)m_Animations.size());
+	for (auto& [animationName, animation] : m_Animations)
+	{
+		writer.writeString(animationName);
+		writer.write(animation.getEndTime());
+
+		Vector<CookedChannel> channels;
+		Vector<TranslationKeyframe> translations;
+		Vector<RotationKeyframe> rotations;
+		Vector<ScalingKeyframe> scalings;
+		const Vector<String>& channelNames = animation.getChannelNames();
+		writer.write((unsigned int)channelNames.size());
+		for (int j = 0; j < channelNames.size(); j++)
+		{
+			const BoneAnimation& boneAnimation = animation.getChannels()[j];
+			writer.writeString(channelNames[j]);
+
+			const Vector<TranslationKeyframe>& nodeTranslations = boneAnimation.getTranslationKeyframes();
+			const Vector<RotationKeyframe>& nodeRotations = boneAnimation.getRotationKeyframes();
+			const Vector<ScalingKeyframe>& nodeScalings = boneAnimation.getScalingKeyframes();
+			channels.push_back({ (unsigned int)translations.size(), (unsigned int)nodeTranslations.size(),
+			    (unsigned int)rotations.size(), (unsigned int)nodeRotations.size(),
+			    (unsigned int)scalings.size(), (unsigned int)nodeScalings.size() });
+			translations.insert(translations.end(), nodeTranslations.begin(), nodeTranslations.end());
+			rotations.insert(rotations.end(), nodeRotations.begin(), nodeRotations.end());
+			scalings.insert(scalings.end(), nodeScalings.begin(), nodeScalings.end());
+		}
+		writer.writeArray(channels);
+		writer.writeArray(translations);
+		writer.writeArray(rotations);
+		writer.writeArray(scalings);
+	}
+
+	CookedCache::Save(getPath(), ANIMATED_MODEL_COOKED_EXTENSION, ANIMATED_MODEL_COOKED_MAGIC, ANIMATED_MODEL_COOKED_VERSION, ANIMATED_MODEL_IMPORT_FLAGS, writer);
 }
@@ -22,14 +22,24 @@ private:
 
 	Vector<Pair<Ref<AnimatedBasicMaterialResourceFile>, Vector<Mesh>>> m_Meshes;
 
-	HashMap<String, unsigned int> m_BoneMapping;
 	Vector<Matrix> m_BoneOffsets;
 	Vector<Matrix> m_AnimationTransforms;
 	Matrix m_RootInverseTransform;
 
-	Ptr<SkeletonNode> m_RootNode;
+	Vector<SkeletonNode> m_Skeleton;
+	/// Model space transform of each skeleton node in the last evaluated pose.
+	Vector<Matrix> m_NodeTransforms;
+	/// Whether a bone has been found on the path from the root to each skeleton node in the last evaluated pose.
+	Vector<bool> m_IsRootFound;
 	HashMap<String, SkeletalAnimation> m_Animations;
 
+	/// Load meshes, skeleton and animations from the cooked .ranim file. Returns false if there is no up to date cooked file.
+	bool loadCooked();
+	/// Load through Assimp and cook the result for the next load.
+	void importModel();
+	void addMesh(const Ref<AnimatedBasicMaterialResourceFile>& material, const Mesh& mesh);
+	void setNodeHierarchy(const aiNode* currentAiNode, int parent, const HashMap<String, unsigned int>& boneMapping);
+
 	friend class ResourceLoader;
 
 public:
@@ -40,13 +50,15 @@ public:
 	~AnimatedModelResourceFile() = default;
 
 	void reimport() override;
+	/// Skeleton and pose data, vertices and indices are only kept on the GPU.
+	size_t getCPUMemory() const override;
+	size_t getGPUMemory() const override;
 
 	Vector<Pair<Ref<AnimatedBasicMaterialResourceFile>, Vector<Mesh>>>& getMeshes() { return m_Meshes; }
 	HashMap<String, SkeletalAnimation>& getAnimations() { return m_Animations; }
 	size_t getBoneCount() const { return m_BoneOffsets.size(); }
 
-	void setNodeHierarchy(aiNode* currentAiNode, Ptr<SkeletonNode>& currentNode);
-	void setAnimationTransforms(Ptr<SkeletonNode>& node, float currentTime, const String& animationName, const Matrix& parentModelTransform, float transitionTightness, RootExclusion rootExclusion, bool isRootFound);
+	void setAnimationTransforms(float currentTime, const String& animationName, float transitionTightness, RootExclusion rootExclusion);
 
 	Vector<String> getAnimationNames();
 	float getAnimationStartTime(const String& animationName) const;
@@ -32,7 +32,55 @@ void AudioResourceFile::reimport()
 {
 	ResourceFile::reimport();
 
+	std::lock_guard<Mutex> lock(m_DataMutex);
+	loadBuffer();
+}
+
+size_t AudioResourceFile::getCPUMemory() const
+{
+	std::lock_guard<Mutex> lock(m_DataMutex);
+	return m_DecompressedAudioBuffer ? m_AudioDataSize : 0;
+}
+
+bool AudioResourceFile::demote()
+{
+	// Not worth waiting for, the data is busy if it is being loaded or read
+	std::unique_lock<Mutex> lock(m_DataMutex, std::try_to_lock);
+	if (!lock.owns_lock() || m_PinCount > 0 || !m_DecompressedAudioBuffer)
+	{
+		return false;
+	}
+	resetBuffer();
+	m_IsDemoted = true;
+	return true;
+}
+
+void AudioResourceFile::pin()
+{
+	std::lock_guard<Mutex> lock(m_DataMutex);
+	m_PinCount++;
+}
+
+void AudioResourceFile::unpin()
+{
+	std::lock_guard<Mutex> lock(m_DataMutex);
+	m_PinCount--;
+}
+
+void AudioResourceFile::readAudioData(const Function<void(const char* data, ALsizei size)>& read)
+{
+	std::lock_guard<Mutex> lock(m_DataMutex);
+	if (m_IsDemoted)
+	{
+		loadBuffer();
+	}
+	read(m_DecompressedAudioBuffer, m_AudioDataSize);
+}
+
+void AudioResourceFile::loadBuffer()
+{
 	resetBuffer();
+	m_IsDemoted = false;
 
 	const char* audioBuffer;
 	int format;
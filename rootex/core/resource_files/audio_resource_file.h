@@ -16,12 +16,20 @@ class AudioResourceFile : public ResourceFile
 
 	const char* m_DecompressedAudioBuffer;
 	ALsizei m_AudioDataSize;
+	/// Users reading the data as it plays, the data is not demoted while there are any.
+	int m_PinCount = 0;
+	Atomic<bool> m_IsDemoted = false;
+	/// Held while the data is loaded, freed or read, and for pin counting. Files are demoted from the main thread
+	/// while audio is streamed from workers.
+	mutable Mutex m_DataMutex;
 
 	explicit AudioResourceFile(const FilePath& path);
 
 	friend class ResourceLoader;
 
+	/// Expect m_DataMutex to be locked.
 	void resetBuffer();
+	void loadBuffer();
 
 public:
 	explicit AudioResourceFile(AudioResourceFile&) = delete;
@@ -30,7 +38,18 @@ public:
 
 	void reimport() override;
 
-	const char* getAudioData() const { return m_DecompressedAudioBuffer; }
+	size_t getCPUMemory() const override;
+	/// Frees the decompressed data unless it is pinned, or being loaded or read. Static buffers keep their own copy in
+	/// OpenAL.
+	bool demote() override;
+	bool isDemoted() const override { return m_IsDemoted; }
+	/// Keep the data resident while it is being streamed.
+	void pin();
+	void unpin();
+
+	/// Call read with the decompressed data and its size, loading the data again if it was demoted. The data is not
+	/// freed or replaced until read returns.
+	void readAudioData(const Function<void(const char* data, ALsizei size)>& read);
 	/// Get size of decompressed audio data.
 	ALsizei getAudioDataSize() const { return m_AudioDataSize; }
 	/// Returns the same enum value that OpenAL uses.
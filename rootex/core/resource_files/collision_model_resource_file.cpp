@@ -1,23 +1,164 @@
 #include "collision_model_resource_file.h"
 
+#include "cooked_cache.h"
+#include "os/timer.h"
+
 #include "assimp/Importer.hpp"
 #include "assimp/postprocess.h"
 #include "assimp/scene.h"
 
+#include "Tracy/Tracy.hpp"
+
+/// Assimp post processing applied to collision models, also part of the key of cooked collision models.
+#define COLLISION_MODEL_IMPORT_FLAGS (aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_OptimizeMeshes | aiProcess_OptimizeGraph | aiProcess_RemoveComponent)
+#define COLLISION_MODEL_COOKED_EXTENSION ".rcol"
+#define COLLISION_MODEL_COOKED_MAGIC 0x4c4f4352 // "RCOL"
+/// Bump when the cooked layout changes. The serialized BVH also depends on the Bullet version it was written by.
+#define COLLISION_MODEL_COOKED_VERSION 1
+
 CollisionModelResourceFile::CollisionModelResourceFile(const FilePath& path)
     : ResourceFile(Type::CollisionModel, path)
 {
 	reimport();
 }
 
+CollisionMesh::~CollisionMesh()
+{
+	// The BVH is deserialized in place, its arrays point into the buffer it lives in and own no memory
+	if (m_BvhBuffer)
+	{
+		btAlignedFree(m_BvhBuffer);
+	}
+}
+
+size_t CollisionMesh::getCPUMemory() const
+{
+	size_t bytes = m_Vertices.capacity() * sizeof(Vector3) + m_ShortIndices.capacity() * sizeof(unsigned short) + m_Indices.capacity() * sizeof(unsigned int);
+	if (m_OptimizedBvh)
+	{
+		bytes += m_OptimizedBvh->calculateSerializeBufferSize();
+	}
+	return bytes;
+}
+
 void CollisionModelResourceFile::reimport()
 {
 	ResourceFile::reimport();
 
+	// Built aside so colliders still using the previous mesh are unaffected
+	Ref<CollisionMesh> mesh(new CollisionMesh());
+	if (!loadCooked(*mesh))
+	{
+		mesh.reset(new CollisionMesh());
+		importModel(*mesh);
+	}
+	m_Mesh = mesh;
+}
+
+void CollisionModelResourceFile::rebuild()
+{
+	Ref<CollisionMesh> mesh(new CollisionMesh());
+	importModel(*mesh);
+	m_Mesh = mesh;
+}
+
+size_t CollisionModelResourceFile::getCPUMemory() const
+{
+	return m_Mesh ? m_Mesh->getCPUMemory() : 0;
+}
+
+void CollisionModelResourceFile::setMeshes(CollisionMesh& mesh, const MeshRange* ranges, size_t rangeCount, const Vector3* vertices, const unsigned char* indices, PHY_ScalarType indexType)
+{
+	const size_t indexSize = indexType == PHY_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+	for (size_t i = 0; i < rangeCount; i++)
+	{
+		btIndexedMesh indexedMesh;
+		indexedMesh.m_numTriangles = ranges[i].triangleCount;
+		indexedMesh.m_triangleIndexBase = indices + ranges[i].indexOffset * indexSize;
+		indexedMesh.m_triangleIndexStride = 3 * indexSize;
+		indexedMesh.m_numVertices = ranges[i].vertexCount;
+		indexedMesh.m_vertexBase = (const unsigned char*)(vertices + ranges[i].vertexOffset);
+		indexedMesh.m_vertexStride = sizeof(Vector3);
+		mesh.m_TriangleMesh.addIndexedMesh(indexedMesh, indexType);
+	}
+}
+
+bool CollisionModelResourceFile::loadCooked(CollisionMesh& mesh)
+{
+	ZoneScoped;
+	StopTimer loadTimer;
+	Ref<MappedFile> cookedFile = CookedCache::Open(getPath(), COLLISION_MODEL_COOKED_EXTENSION, COLLISION_MODEL_COOKED_MAGIC, COLLISION_MODEL_COOKED_VERSION, COLLISION_MODEL_IMPORT_FLAGS);
+	if (!cookedFile)
+	{
+		return false;
+	}
+
+	CookedReader reader = CookedCache::GetReader(*cookedFile);
+	const PHY_ScalarType indexType = (PHY_ScalarType)reader.read<int>();
+	const Vector3 aabbMin = reader.read<Vector3>();
+	const Vector3 aabbMax = reader.read<Vector3>();
+	const float buildTime = reader.read<float>();
+
+	size_t vertexCount = 0;
+	const Vector3* vertices = reader.readArray<Vector3>(vertexCount);
+	size_t indexCount = 0;
+	const unsigned char* indices = nullptr;
+	if (indexType == PHY_SHORT)
+	{
+		indices = (const unsigned char*)reader.readArray<unsigned short>(indexCount);
+	}
+	else if (indexType == PHY_INTEGER)
+	{
+		indices = (const unsigned char*)reader.readArray<unsigned int>(indexCount);
+	}
+	size_t rangeCount = 0;
+	const MeshRange* ranges = reader.readArray<MeshRange>(rangeCount);
+	size_t bvhSize = 0;
+	const char* bvhData = reader.readArray<char>(bvhSize);
+
+	bool isValid = reader.isValid() && (indexType == PHY_SHORT || indexType == PHY_INTEGER);
+	for (size_t i = 0; isValid && i < rangeCount; i++)
+	{
+		isValid = (size_t)ranges[i].vertexOffset + ranges[i].vertexCount <= vertexCount
+		    && (size_t)ranges[i].indexOffset + ranges[i].triangleCount * 3ull <= indexCount;
+	}
+	// Copied out so the cooked file is not held open, it has to be replaceable when the model is cooked again
+	if (isValid && bvhSize)
+	{
+		mesh.m_BvhBuffer = (char*)btAlignedAlloc(bvhSize, 16);
+		memcpy(mesh.m_BvhBuffer, bvhData, bvhSize);
+		mesh.m_OptimizedBvh = btOptimizedBvh::deSerializeInPlace(mesh.m_BvhBuffer, bvhSize, false);
+		isValid = mesh.m_OptimizedBvh != nullptr;
+	}
+	if (!isValid)
+	{
+		WARN("Cooked collision model is damaged, reimporting: " + getPath().generic_string());
+		return false;
+	}
+
+	mesh.m_Vertices.assign(vertices, vertices + vertexCount);
+	if (indexType == PHY_SHORT)
+	{
+		mesh.m_ShortIndices.assign((const unsigned short*)indices, (const unsigned short*)indices + indexCount);
+		indices = (const unsigned char*)mesh.m_ShortIndices.data();
+	}
+	else
+	{
+		mesh.m_Indices.assign((const unsigned int*)indices, (const unsigned int*)indices + indexCount);
+		indices = (const unsigned char*)mesh.m_Indices.data();
+	}
+	setMeshes(mesh, ranges, rangeCount, mesh.m_Vertices.data(), indices, indexType);
+	mesh.m_TriangleMesh.setPremadeAabb(btVector3(aabbMin.x, aabbMin.y, aabbMin.z), btVector3(aabbMax.x, aabbMax.y, aabbMax.z));
+
+	PRINT_SILENT("Loaded cooked collision BVH for " + getPath().generic_string() + " in " + std::to_string(loadTimer.getTimeMs()) + "ms, building it took " + std::to_string(buildTime) + "ms");
+	return true;
+}
+
+void CollisionModelResourceFile::importModel(CollisionMesh& mesh)
+{
+	ZoneScoped;
 	Assimp::Importer modelLoader;
-	const aiScene* scene = modelLoader.ReadFile(
-	    getPath().generic_string(),
-	    aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_OptimizeMeshes | aiProcess_OptimizeGraph | aiProcess_RemoveComponent);
+	const aiScene* scene = modelLoader.ReadFile(getPath().generic_string(), COLLISION_MODEL_IMPORT_FLAGS);
 
 	if (!scene)
 	{
@@ -26,59 +167,108 @@ void CollisionModelResourceFile::reimport()
 		return;
 	}
 
-	btTriangleIndexVertexArray meshes;
-	m_Meshes.clear();
-	m_Vertices.clear();
-	m_Indices.clear();
-
-	// Stop the arrays from changing memory locations
+	// Indices are relative to their mesh, so 16 bits are enough unless a single mesh has more vertices than that
+	PHY_ScalarType indexType = PHY_SHORT;
 	unsigned int totalVertices = 0;
 	unsigned int totalIndices = 0;
 	for (int i = 0; i < scene->mNumMeshes; i++)
 	{
 		totalVertices += scene->mMeshes[i]->mNumVertices;
 		totalIndices += scene->mMeshes[i]->mNumFaces * 3;
+		if (scene->mMeshes[i]->mNumVertices > USHRT_MAX + 1)
+		{
+			indexType = PHY_INTEGER;
+		}
+	}
+	mesh.m_Vertices.reserve(totalVertices);
+	if (indexType == PHY_SHORT)
+	{
+		mesh.m_ShortIndices.reserve(totalIndices);
+	}
+	else
+	{
+		mesh.m_Indices.reserve(totalIndices);
 	}
-	m_Vertices.reserve(totalVertices);
-	m_Indices.reserve(totalIndices);
 
-	unsigned int indicesSeen = 0;
-	unsigned int verticesSeen = 0;
+	Vector<MeshRange> ranges;
 	for (int i = 0; i < scene->mNumMeshes; i++)
 	{
-		const aiMesh* mesh = scene->mMeshes[i];
+		const aiMesh* sceneMesh = scene->mMeshes[i];
 
-		btIndexedMesh indexedMesh;
+		MeshRange range;
+		range.vertexOffset = mesh.m_Vertices.size();
+		range.vertexCount = sceneMesh->mNumVertices;
+		range.indexOffset = indexType == PHY_SHORT ? mesh.m_ShortIndices.size() : mesh.m_Indices.size();
+		range.triangleCount = sceneMesh->mNumFaces;
+		ranges.push_back(range);
+
+		for (unsigned int f = 0; f < sceneMesh->mNumFaces; f++)
 		{
-			indexedMesh.m_numTriangles = mesh->mNumFaces;
-			indexedMesh.m_numVertices = mesh->mNumVertices;
-			aiFace* face = nullptr;
-			for (unsigned int f = 0; f < mesh->mNumFaces; f++)
+			const aiFace& face = sceneMesh->mFaces[f];
+			//Model already triangulated by aiProcess_Triangulate so no need to check
+			for (unsigned int j = 0; j < 3; j++)
 			{
-				face = &mesh->mFaces[f];
-				//Model already triangulated by aiProcess_Triangulate so no need to check
-				m_Indices.push_back(face->mIndices[0]);
-				m_Indices.push_back(face->mIndices[1]);
-				m_Indices.push_back(face->mIndices[2]);
+				if (indexType == PHY_SHORT)
+				{
+					mesh.m_ShortIndices.push_back(face.mIndices[j]);
+				}
+				else
+				{
+					mesh.m_Indices.push_back(face.mIndices[j]);
+				}
 			}
-			indexedMesh.m_triangleIndexBase = (const unsigned char*)(m_Indices.data() + indicesSeen);
-			indexedMesh.m_triangleIndexStride = 3 * sizeof(short);
-			for (unsigned int v = 0; v < mesh->mNumVertices; v++)
-			{
-				Vector3 vertex;
-				vertex.x = mesh->mVertices[v].x;
-				vertex.y = mesh->mVertices[v].y;
-				vertex.z = mesh->mVertices[v].z;
-				m_Vertices.push_back(vertex);
-			}
-			indexedMesh.m_vertexBase = (const unsigned char*)(m_Vertices.data() + verticesSeen);
-			indexedMesh.m_vertexStride = 3 * sizeof(float);
 		}
-		indicesSeen += mesh->mNumFaces * 3;
-		verticesSeen += mesh->mNumVertices;
-		m_Meshes.push_back(indexedMesh);
-		meshes.addIndexedMesh(m_Meshes.back(), PHY_SHORT);
+		for (unsigned int v = 0; v < sceneMesh->mNumVertices; v++)
+		{
+			mesh.m_Vertices.push_back({ sceneMesh->mVertices[v].x, sceneMesh->mVertices[v].y, sceneMesh->mVertices[v].z });
+		}
+	}
+
+	const unsigned char* indices = indexType == PHY_SHORT ? (const unsigned char*)mesh.m_ShortIndices.data() : (const unsigned char*)mesh.m_Indices.data();
+	setMeshes(mesh, ranges.data(), ranges.size(), mesh.m_Vertices.data(), indices, indexType);
+
+	btVector3 aabbMin;
+	btVector3 aabbMax;
+	mesh.m_TriangleMesh.calculateAabbBruteForce(aabbMin, aabbMax);
+	mesh.m_TriangleMesh.setPremadeAabb(aabbMin, aabbMax);
+
+	CookedWriter writer;
+	writer.write((int)indexType);
+	writer.write(Vector3(aabbMin.x(), aabbMin.y(), aabbMin.z()));
+	writer.write(Vector3(aabbMax.x(), aabbMax.y(), aabbMax.z()));
+
+	float buildTime = 0.0f;
+	unsigned int bvhSize = 0;
+	if (totalIndices)
+	{
+		StopTimer buildTimer;
+		Ptr<btOptimizedBvh> optimizedBvh(new btOptimizedBvh());
+		optimizedBvh->build(&mesh.m_TriangleMesh, true, aabbMin, aabbMax);
+		buildTime = buildTimer.getTimeMs();
+
+		// Loaded from its serialized form on this load as well, so both paths share one BVH representation
+		bvhSize = optimizedBvh->calculateSerializeBufferSize();
+		mesh.m_BvhBuffer = (char*)btAlignedAlloc(bvhSize, 16);
+		optimizedBvh->serializeInPlace(mesh.m_BvhBuffer, bvhSize, false);
+	}
+	writer.write(buildTime);
+	writer.writeArray(mesh.m_Vertices);
+	if (indexType == PHY_SHORT)
+	{
+		writer.writeArray(mesh.m_ShortIndices);
+	}
+	else
+	{
+		writer.writeArray(mesh.m_Indices);
+	}
+	writer.writeArray(ranges);
+	writer.writeArray(mesh.m_BvhBuffer, bvhSize);
+
+	if (mesh.m_BvhBuffer)
+	{
+		mesh.m_OptimizedBvh = btOptimizedBvh::deSerializeInPlace(mesh.m_BvhBuffer, bvhSize, false);
 	}
 
-	m_TriangleMesh = meshes;
+	PRINT_SILENT("Built collision BVH for " + getPath().generic_string() + " in " + std::to_string(buildTime) + "ms");
+	CookedCache::Save(getPath(), COLLISION_MODEL_COOKED_EXTENSION, COLLISION_MODEL_COOKED_MAGIC, COLLISION_MODEL_COOKED_VERSION, COLLISION_MODEL_IMPORT_FLAGS, writer);
 }
@@ -5,15 +5,57 @@
 
 #include "btBulletCollisionCommon.h"
 
+/// Triangle mesh and quantized BVH of a collision model. Never changed once loaded, so shapes made from it stay valid
+/// for as long as they hold on to it, even after the file is reimported.
+class CollisionMesh
+{
+	btTriangleIndexVertexArray m_TriangleMesh;
+	Vector<Vector3> m_Vertices;
+	/// Only one of the index arrays is filled, 16 bit indices are used when every mesh is small enough.
+	Vector<unsigned short> m_ShortIndices;
+	Vector<unsigned int> m_Indices;
+
+	/// Serialized BVH, built on this load or copied from the cooked file. The BVH is deserialized in place in here.
+	char* m_BvhBuffer = nullptr;
+	btOptimizedBvh* m_OptimizedBvh = nullptr;
+
+	friend class CollisionModelResourceFile;
+
+public:
+	CollisionMesh() = default;
+	CollisionMesh(const CollisionMesh&) = delete;
+	~CollisionMesh();
+
+	size_t getCPUMemory() const;
+
+	btTriangleIndexVertexArray* getTriangleMesh() { return &m_TriangleMesh; }
+	/// BVH of the triangle mesh, to be set on shapes created without building their own.
+	btOptimizedBvh* getOptimizedBvh() { return m_OptimizedBvh; }
+};
+
 /// Representation of a 3D model file used to initialise a mesh collider.
+/// The triangle mesh and its quantized BVH are built once per file and shared by every collider using it.
 class CollisionModelResourceFile : public ResourceFile
 {
 	explicit CollisionModelResourceFile(const FilePath& path);
 
-	btTriangleIndexVertexArray m_TriangleMesh;
-	Vector<btIndexedMesh> m_Meshes;
-	Vector<Vector3> m_Vertices;
-	Vector<short> m_Indices;
+	/// Vertices and triangles of one mesh in the shared vertex and index arrays.
+	struct MeshRange
+	{
+		unsigned int vertexOffset;
+		unsigned int vertexCount;
+		unsigned int indexOffset;
+		unsigned int triangleCount;
+	};
+
+	/// Replaced as a whole on reimport, colliders keep the one they were made from until they are remade.
+	Ref<CollisionMesh> m_Mesh;
+
+	/// Load the mesh and the BVH from the cooked .rcol file. Returns false if there is no up to date cooked file.
+	bool loadCooked(CollisionMesh& mesh);
+	/// Load the mesh through Assimp, build its BVH and cook both for the next load.
+	void importModel(CollisionMesh& mesh);
+	void setMeshes(CollisionMesh& mesh, const MeshRange* ranges, size_t rangeCount, const Vector3* vertices, const unsigned char* indices, PHY_ScalarType indexType);
 
 	friend class ResourceLoader;
 
@@ -23,6 +65,11 @@ public:
 	~CollisionModelResourceFile() = default;
 
 	void reimport() override;
+	/// Import the model and build its BVH again even if the cooked file is up to date, then cook them again.
+	void rebuild();
+	/// Mesh data and BVH, which Bullet needs for as long as the file is alive.
+	size_t getCPUMemory() const override;
 
-	btTriangleIndexVertexArray* getCollisionMesh() { return &m_TriangleMesh; }
+	/// Mesh loaded on the last import. Hold on to it for as long as a shape uses it.
+	const Ref<CollisionMesh>& getCollisionMesh() const { return m_Mesh; }
 };
@@ -137,6 +137,9 @@ void CustomMaterialResourceFile::setShaders(const String& vertexShader, const St
 		ERR("Custom shaders not found: " + vertexShader + " or " + pixelShader);
 		return;
 	}
+	// Recorded before compiling, so fixing a broken shader reimports this material too
+	ResourceLoader::AddDependency(*this, Type::None, vertexShader);
+	ResourceLoader::AddDependency(*this, Type::None, pixelShader);
 
 	BufferFormat bufferFormat;
 	bufferFormat.push(VertexBufferElement::Type::FloatFloatFloat, "POSITION", D3D11_INPUT_PER_VERTEX_DATA, 0, false, 0);
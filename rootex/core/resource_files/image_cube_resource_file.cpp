@@ -1,5 +1,7 @@
 #include "image_cube_resource_file.h"
 
+#include "os/virtual_file_system.h"
+
 ImageCubeResourceFile::ImageCubeResourceFile(const FilePath& path)
     : ResourceFile(Type::ImageCube, path)
 {
@@ -10,6 +12,6 @@ void ImageCubeResourceFile::reimport()
 {
 	ResourceFile::reimport();
 
-	const FileBuffer& fileBuffer = OS::LoadFileContents(m_Path.generic_string());
-	m_ImageTexture.reset(new TextureCube(fileBuffer.data(), fileBuffer.size()));
+	const FileView& file = VirtualFileSystem::LoadFile(m_Path.generic_string());
+	m_ImageTexture.reset(new TextureCube(file.getData(), file.getSize()));
 }
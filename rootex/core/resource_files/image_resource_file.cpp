@@ -1,5 +1,7 @@
 #include "image_resource_file.h"
 
+#include "os/virtual_file_system.h"
+
 ImageResourceFile::ImageResourceFile(const FilePath& path)
     : ResourceFile(Type::Image, path)
 {
@@ -10,6 +12,12 @@ void ImageResourceFile::reimport()
 {
 	ResourceFile::reimport();
 
-	const FileBuffer& fileBuffer = OS::LoadFileContents(m_Path.generic_string());
-	m_ImageTexture.reset(new Texture(fileBuffer.data(), fileBuffer.size()));
+	const FileView& file = VirtualFileSystem::LoadFile(m_Path.generic_string());
+	m_ImageTexture.reset(new Texture(file.getData(), file.getSize()));
+}
+
+size_t ImageResourceFile::getGPUMemory() const
+{
+	const size_t bytes = (size_t)m_ImageTexture->getWidth() * m_ImageTexture->getHeight() * 4;
+	return m_ImageTexture->getMipLevels() > 1 ? bytes * 4 / 3 : bytes;
 }
@@ -22,4 +22,7 @@ public:
 	const Ref<Texture> getTexture() { return m_ImageTexture; }
 	unsigned int getWidth() const { return m_ImageTexture->getWidth(); }
 	unsigned int getHeight() const { return m_ImageTexture->getHeight(); }
+
+	/// Assumes 4 bytes per pixel, the mip chain adds up to a third more.
+	size_t getGPUMemory() const override;
 };
@@ -5,12 +5,21 @@
 #include "renderer/mesh.h"
 #include "renderer/vertex_buffer.h"
 #include "renderer/index_buffer.h"
+#include "cooked_cache.h"
 
 #include "assimp/Importer.hpp"
 #include "assimp/postprocess.h"
 #include "assimp/scene.h"
 
 #include "meshoptimizer.h"
+#include "Tracy/Tracy.hpp"
+
+/// Assimp post processing applied to models, also part of the key of cooked models.
+#define MODEL_IMPORT_FLAGS (aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SplitLargeMeshes | aiProcess_GenBoundingBoxes | aiProcess_OptimizeMeshes | aiProcess_CalcTangentSpace | aiProcess_RemoveComponent | aiProcess_PreTransformVertices)
+#define MODEL_COOKED_EXTENSION ".rmesh"
+#define MODEL_COOKED_MAGIC 0x48534d52 // "RMSH"
+/// Bump when the cooked layout, the vertex format or the LOD generation changes.
+#define MODEL_COOKED_VERSION 1
 
 ModelResourceFile::ModelResourceFile(const FilePath& path)
     : ResourceFile(Type::Model, path)
@@ -22,10 +31,121 @@ void ModelResourceFile::reimport()
 {
 	ResourceFile::reimport();
 
+	if (!loadCooked())
+	{
+		importModel();
+	}
+}
+
+size_t ModelResourceFile::getGPUMemory() const
+{
+	size_t bytes = 0;
+	for (auto& [material, meshes] : m_Meshes)
+	{
+		for (auto& mesh : meshes)
+		{
+			bytes += mesh.getGPUMemory();
+		}
+	}
+	return bytes;
+}
+
+void ModelResourceFile::addMesh(const Ref<BasicMaterialResourceFile>& material, const Mesh& mesh)
+{
+	for (auto& materialModels : getMeshes())
+	{
+		if (materialModels.first == material)
+		{
+			materialModels.second.push_back(mesh);
+			return;
+		}
+	}
+
+	if (material)
+	{
+		getMeshes().push_back(Pair<Ref<BasicMaterialResourceFile>, Vector<Mesh>>(material, { mesh }));
+	}
+}
+
+bool ModelResourceFile::loadCooked()
+{
+	ZoneScoped;
+	Ref<MappedFile> cookedFile = CookedCache::Open(getPath(), MODEL_COOKED_EXTENSION, MODEL_COOKED_MAGIC, MODEL_COOKED_VERSION, MODEL_IMPORT_FLAGS);
+	if (!cookedFile)
+	{
+		return false;
+	}
+
+	struct CookedMesh
+	{
+		String materialPath;
+		BoundingBox boundingBox;
+		const VertexData* vertices;
+		size_t vertexCount;
+		const unsigned int* indices;
+		size_t indexCount;
+		const CookedLOD* lods;
+		size_t lodCount;
+	};
+
+	// Read everything before touching the loaded meshes so a stale or damaged file can fall back to importing
+	CookedReader reader = CookedCache::GetReader(*cookedFile);
+	// The count is bounded by what is left of the file, each mesh holds at least its bounding box
+	Vector<CookedMesh> cookedMeshes(reader.readCount(sizeof(BoundingBox)));
+	for (auto& cookedMesh : cookedMeshes)
+	{
+		cookedMesh.materialPath = reader.readString();
+		cookedMesh.boundingBox = reader.read<BoundingBox>();
+		cookedMesh.vertices = reader.readArray<VertexData>(cookedMesh.vertexCount);
+		cookedMesh.indices = reader.readArray<unsigned int>(cookedMesh.indexCount);
+		cookedMesh.lods = reader.readArray<CookedLOD>(cookedMesh.lodCount);
+
+		if (!reader.isValid())
+		{
+			WARN("Cooked model is damaged, reimporting: " + getPath().generic_string());
+			return false;
+		}
+		for (size_t i = 0; i < cookedMesh.lodCount; i++)
+		{
+			if ((size_t)cookedMesh.lods[i].offset + cookedMesh.lods[i].count > cookedMesh.indexCount)
+			{
+				WARN("Cooked model is damaged, reimporting: " + getPath().generic_string());
+				return false;
+			}
+		}
+		if (!OS::IsExists(cookedMesh.materialPath))
+		{
+			return false;
+		}
+	}
+	if (!reader.isValid())
+	{
+		WARN("Cooked model is damaged, reimporting: " + getPath().generic_string());
+		return false;
+	}
+
+	m_Meshes.clear();
+	for (auto& cookedMesh : cookedMeshes)
+	{
+		Mesh extractedMesh;
+		extractedMesh.m_VertexBuffer.reset(new VertexBuffer((const char*)cookedMesh.vertices, cookedMesh.vertexCount, sizeof(VertexData), D3D11_USAGE_IMMUTABLE, 0));
+		for (size_t i = 0; i < cookedMesh.lodCount; i++)
+		{
+			const CookedLOD& lod = cookedMesh.lods[i];
+			extractedMesh.addLOD(std::make_shared<IndexBuffer>((const int*)cookedMesh.indices + lod.offset, lod.count), lod.level);
+		}
+		extractedMesh.m_BoundingBox = cookedMesh.boundingBox;
+
+		addMesh(ResourceLoader::CreateBasicMaterialResourceFile(cookedMesh.materialPath), extractedMesh);
+	}
+	return true;
+}
+
+void ModelResourceFile::importModel()
+{
+	ZoneScoped;
 	Assimp::Importer modelLoader;
-	const aiScene* scene = modelLoader.ReadFile(
-	    getPath().generic_string(),
-	    aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SplitLargeMeshes | aiProcess_GenBoundingBoxes | aiProcess_OptimizeMeshes | aiProcess_CalcTangentSpace | aiProcess_RemoveComponent | aiProcess_PreTransformVertices);
+	const aiScene* scene = modelLoader.ReadFile(getPath().generic_string(), MODEL_IMPORT_FLAGS);
 
 	if (!scene)
 	{
@@ -34,6 +154,9 @@ void ModelResourceFile::reimport()
 		return;
 	}
 
+	CookedWriter writer;
+	writer.write(scene->mNumMeshes);
+
 	m_Meshes.clear();
 	for (int i = 0; i < scene->mNumMeshes; i++)
 	{
@@ -262,11 +385,17 @@ void ModelResourceFile::reimport()
 		Mesh extractedMesh;
 		extractedMesh.m_VertexBuffer.reset(new VertexBuffer((const char*)vertices.data(), vertices.size(), sizeof(VertexData), D3D11_USAGE_IMMUTABLE, 0));
 		extractedMesh.addLOD(std::make_shared<IndexBuffer>(indices), 1.0f);
+
+		Vector<CookedLOD> cookedLODs = { { 1.0f, 0, (unsigned int)indices.size() } };
+		Vector<unsigned int> cookedIndices = indices;
 		for (int i = 0; i < MAX_LOD_COUNT - 1; i++)
 		{
 			if (!lods[i].empty())
 			{
 				extractedMesh.addLOD(std::make_shared<IndexBuffer>(lods[i]), lodLevels[i]);
+
+				cookedLODs.push_back({ lodLevels[i], (unsigned int)cookedIndices.size(), (unsigned int)lods[i].size() });
+				cookedIndices.insert(cookedIndices.end(), lods[i].begin(), lods[i].end());
 			}
 		}
 		Vector3 max = { mesh->mAABB.mMax.x, mesh->mAABB.mMax.y, mesh->mAABB.mMax.z };
@@ -278,20 +407,14 @@ void ModelResourceFile::reimport()
 		extractedMesh.m_BoundingBox.Extents.y = abs(extractedMesh.m_BoundingBox.Extents.y);
 		extractedMesh.m_BoundingBox.Extents.z = abs(extractedMesh.m_BoundingBox.Extents.z);
 
-		bool found = false;
-		for (auto& materialModels : getMeshes())
-		{
-			if (materialModels.first == extractedMaterial)
-			{
-				found = true;
-				materialModels.second.push_back(extractedMesh);
-				break;
-			}
-		}
+		writer.writeString(materialPath);
+		writer.write(extractedMesh.m_BoundingBox);
+		writer.writeArray(vertices);
+		writer.writeArray(cookedIndices);
+		writer.writeArray(cookedLODs);
 
-		if (!found && extractedMaterial)
-		{
-			getMeshes().push_back(Pair<Ref<BasicMaterialResourceFile>, Vector<Mesh>>(extractedMaterial, { extractedMesh }));
-		}
+		addMesh(extractedMaterial, extractedMesh);
 	}
+
+	CookedCache::Save(getPath(), MODEL_COOKED_EXTENSION, MODEL_COOKED_MAGIC, MODEL_COOKED_VERSION, MODEL_IMPORT_FLAGS, writer);
 }
@@ -13,6 +13,12 @@ class ModelResourceFile : public ResourceFile
 
 	Vector<Pair<Ref<BasicMaterialResourceFile>, Vector<Mesh>>> m_Meshes;
 
+	/// Load meshes from the cooked .rmesh file. Returns false if there is no up to date cooked file.
+	bool loadCooked();
+	/// Load meshes through Assimp and cook them for the next load.
+	void importModel();
+	void addMesh(const Ref<BasicMaterialResourceFile>& material, const Mesh& mesh);
+
 	friend class ResourceLoader;
 
 public:
@@ -21,6 +27,8 @@ public:
 	~ModelResourceFile() = default;
 
 	void reimport() override;
+	/// Vertices and indices are only kept on the GPU.
+	size_t getGPUMemory() const override;
 
 	Vector<Pair<Ref<BasicMaterialResourceFile>, Vector<Mesh>>>& getMeshes() { return m_Meshes; }
 };
@@ -1,5 +1,7 @@
 #include "text_resource_file.h"
 
+#include "os/virtual_file_system.h"
+
 TextResourceFile::TextResourceFile(const FilePath& path)
     : ResourceFile(Type::Text, path)
 {
@@ -9,8 +11,8 @@ TextResourceFile::TextResourceFile(const FilePath& path)
 void TextResourceFile::reimport()
 {
 	ResourceFile::reimport();
-	const FileBuffer& fileBuffer = OS::LoadFileContents(m_Path.generic_string());
-	m_FileString = String(fileBuffer.begin(), fileBuffer.end());
+	const FileView& file = VirtualFileSystem::LoadFile(m_Path.generic_string());
+	m_FileString = String(file.getContents());
 }
 
 bool TextResourceFile::save()
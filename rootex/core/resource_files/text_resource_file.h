@@ -28,4 +28,6 @@ public:
 
 	void reimport() override;
 	bool save() override;
+
+	size_t getCPUMemory() const override { return m_FileString.capacity(); }
 };
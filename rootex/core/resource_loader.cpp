@@ -1,7 +1,9 @@
 #include "resource_loader.h"
 
 #include "app/application.h"
+#include "event_manager.h"
 #include "os/thread.h"
+#include "os/timer.h"
 
 bool IsFileSupported(const String& extension, ResourceFile::Type supportedFileType)
 {
@@ -58,6 +60,29 @@ Ref<ResourceFile> ResourceLoader::CreateResourceFile(const ResourceFile::Type& t
 	return nullptr;
 }
 
+/// Number of preload stages, see GetPreloadStage.
+#define PRELOAD_STAGES 3
+
+/// Files of a stage are loaded only after every file of the earlier stages, so materials find their images and
+/// models find their materials already loaded.
+static int GetPreloadStage(ResourceFile::Type type)
+{
+	switch (type)
+	{
+	case ResourceFile::Type::BasicMaterial:
+	case ResourceFile::Type::InstancingBasicMaterial:
+	case ResourceFile::Type::AnimatedBasicMaterial:
+	case ResourceFile::Type::SkyMaterial:
+	case ResourceFile::Type::CustomMaterial:
+		return 1;
+	case ResourceFile::Type::Model:
+	case ResourceFile::Type::AnimatedModel:
+		return 2;
+	default:
+		return 0;
+	}
+}
+
 int ResourceLoader::Preload(ResourceCollection paths, Atomic<int>& progress)
 {
 	progress = 0;
@@ -68,40 +93,88 @@ int ResourceLoader::Preload(ResourceCollection paths, Atomic<int>& progress)
 		return 0;
 	}
 
-	std::sort(paths.begin(), paths.end(), [](const Pair<ResourceFile::Type, String>& a, const Pair<ResourceFile::Type, String>& b) {
-		return (int)a.first < (int)b.first && a.second < b.second;
-	});
-
-	ResourceCollection empericalPaths = { paths.front() };
-	for (auto& incomingPath : paths)
+	struct PreloadStatistics
 	{
-		if (empericalPaths.back() != incomingPath)
+		Atomic<int> files = 0;
+		Atomic<unsigned long long> bytes = 0;
+		Atomic<long long> timeNs = 0;
+	};
+	Ref<Map<ResourceFile::Type, PreloadStatistics>> statistics(new Map<ResourceFile::Type, PreloadStatistics>());
+
+	Map<ResourceFile::Type, HashSet<String>> uniquePaths;
+	Vector<Ref<Task>> stages[PRELOAD_STAGES];
+	int totalProgress = 0;
+	for (auto& path : paths)
+	{
+		const ResourceFile::Type type = path.first;
+		// Normalized like the resource cache keys, so differently written paths to one file are loaded once
+		const String normalizedPath = ResourceCache::NormalizePath(path.second);
+		if (!uniquePaths[type].insert(normalizedPath).second)
 		{
-			empericalPaths.emplace_back(incomingPath);
+			continue;
 		}
+
+		std::error_code error;
+		unsigned long long size = std::filesystem::file_size(OS::GetAbsolutePath(normalizedPath), error);
+		if (error)
+		{
+			size = 0;
+		}
+		// Progress is counted in KB so it follows the data loaded rather than the number of files
+		const int weight = std::max(1, (int)(size / 1024));
+		totalProgress += weight;
+		(*statistics)[type];
+
+		stages[GetPreloadStage(type)].push_back(std::make_shared<Task>([=, &progress]() {
+			StopTimer loadTimer;
+			Persist(CreateResourceFile(type, normalizedPath));
+
+			PreloadStatistics& typeStatistics = statistics->at(type);
+			typeStatistics.timeNs += loadTimer.getTimeNs();
+			typeStatistics.bytes += size;
+			typeStatistics.files++;
+			progress += weight;
+		}));
 	}
 
-	Vector<Ref<Task>> tasks;
+	const TimePoint startTime = Timer::Now();
+	Ref<Task> report = std::make_shared<Task>([statistics, startTime]() {
+		for (auto& [type, typeStatistics] : *statistics)
+		{
+			PRINT("Preloaded " + std::to_string(typeStatistics.files.load()) + " " + ResourceFile::s_TypeNames.at(type) + " files (" + std::to_string(typeStatistics.bytes.load() / 1024) + " KB) in " + std::to_string(typeStatistics.timeNs.load() * NS_TO_MS) + "ms");
+		}
+		PRINT("Preloading took " + std::to_string((Timer::Now() - startTime).count() * NS_TO_MS) + "ms");
+	});
 
-	for (auto& path : empericalPaths)
+	// Stages are joined through empty tasks instead of linking every file to every file of the next stage
+	Vector<Ref<Task>> tasks;
+	Ref<Task> previousJoin;
+	for (auto& stage : stages)
 	{
-		ResourceFile::Type type = path.first;
-		String pathString = path.second;
+		if (stage.empty())
+		{
+			continue;
+		}
 
-		tasks.push_back(std::make_shared<Task>([=, &progress]() {
-			Ref<ResourceFile> res = CreateResourceFile(type, pathString);
-			Persist(res);
-			progress++;
-		}));
+		Ref<Task> join = std::make_shared<Task>([]() {});
+		for (auto& task : stage)
+		{
+			if (previousJoin)
+			{
+				previousJoin->precede(task);
+			}
+			task->precede(join);
+			tasks.push_back(task);
+		}
+		tasks.push_back(join);
+		previousJoin = join;
 	}
-
-	/// TODO: Fix the need for this dummy task (blocks the main thread if no resources are preloaded)
-	tasks.push_back(std::make_shared<Task>([]() {}));
-	progress++;
+	previousJoin->precede(report);
+	tasks.push_back(report);
 
 	Application::GetSingleton()->getThreadPool().submit(tasks);
 
-	return tasks.size(); // One less for the dummy task
+	return totalProgress;
 }
 
 void ResourceLoader::Persist(Ref<ResourceFile> res)
@@ -116,6 +189,188 @@ void ResourceLoader::ClearPersistentResources()
 	s_PersistentResources.clear();
 }
 
+Ref<ResourceFile> ResourceLoader::GetPlaceholder(ResourceFile::Type type)
+{
+	auto&& placeholderPath = AsyncPlaceholders.find(type);
+	if (placeholderPath == AsyncPlaceholders.end())
+	{
+		return nullptr;
+	}
+
+	Ref<ResourceFile>& placeholder = s_Placeholders[type];
+	if (!placeholder)
+	{
+		placeholder = CreateResourceFile(type, placeholderPath->second);
+	}
+	return placeholder;
+}
+
+Ref<AsyncResourceState> ResourceLoader::LoadAsync(ResourceFile::Type type, const String& path)
+{
+	const String searchPath = ResourceCache::NormalizePath(path);
+	if (Ref<ResourceFile> cached = s_ResourceCache.find(type, searchPath))
+	{
+		cached->touch();
+		return Ref<AsyncResourceState>(new AsyncResourceState(cached, true));
+	}
+
+	std::lock_guard<Mutex> lock(s_AsyncMutex);
+	const ResourceKey key = { type, searchPath };
+	if (Ref<AsyncResourceState> loading = s_AsyncLoads[key].lock())
+	{
+		return loading;
+	}
+
+	Ref<AsyncResourceState> state(new AsyncResourceState(GetPlaceholder(type), false));
+	s_AsyncLoads[key] = state;
+	Application::GetSingleton()->getThreadPool().submit({ std::make_shared<Task>([state, key]() {
+		Ref<ResourceFile> file = CreateResourceFile(key.first, key.second);
+
+		// Swapped in on the main thread between two frames
+		EventManager::GetSingleton()->defer([state, key, file]() {
+			{
+				std::lock_guard<Mutex> lock(s_AsyncMutex);
+				auto&& loading = s_AsyncLoads.find(key);
+				if (loading != s_AsyncLoads.end() && loading->second.lock() == state)
+				{
+					s_AsyncLoads.erase(loading);
+				}
+			}
+			state->resolve(file);
+		});
+	}) });
+	return state;
+}
+
+void ResourceLoader::SetResidencyBudget(ResourceFile::Type type, size_t bytes)
+{
+	if (bytes == 0)
+	{
+		s_ResidencyBudgets.erase(type);
+		return;
+	}
+	s_ResidencyBudgets[type] = bytes;
+}
+
+void ResourceLoader::LoadResidencyBudgets(const JSON::json& budgetsMB)
+{
+	for (auto& budget : budgetsMB.items())
+	{
+		auto&& type = std::find_if(ResourceFile::s_TypeNames.begin(), ResourceFile::s_TypeNames.end(), [&budget](const auto& name) { return name.second == budget.key(); });
+		if (type == ResourceFile::s_TypeNames.end() || !budget.value().is_number())
+		{
+			WARN("Unknown resource type in residency budgets: " + budget.key());
+			continue;
+		}
+		SetResidencyBudget(type->first, (size_t)((double)budget.value() * 1024 * 1024));
+	}
+}
+
+void ResourceLoader::UpdateResidency()
+{
+	const long long now = ResourceFile::GetUsedTimeNow();
+	if (s_ResidencyBudgets.empty() || now - s_LastResidencyCheckTime < RESOURCE_RESIDENCY_INTERVAL_MS)
+	{
+		return;
+	}
+	s_LastResidencyCheckTime = now;
+
+	HashMap<ResourceFile::Type, Vector<Ref<ResourceFile>>> files;
+	s_ResourceCache.forEach([&files](const Ref<ResourceFile>& file) {
+		files[file->getType()].push_back(file);
+	});
+
+	std::lock_guard<RecursiveMutex> lock(s_PersistMutex);
+	for (auto& [type, budget] : s_ResidencyBudgets)
+	{
+		Vector<Ref<ResourceFile>>& typeFiles = files[type];
+		size_t used = 0;
+		for (auto& file : typeFiles)
+		{
+			used += file->getCPUMemory();
+		}
+		if (used <= budget)
+		{
+			continue;
+		}
+
+		std::sort(typeFiles.begin(), typeFiles.end(), [](const Ref<ResourceFile>& a, const Ref<ResourceFile>& b) {
+			return a->getLastUsedTime() < b->getLastUsedTime();
+		});
+		for (auto& file : typeFiles)
+		{
+			if (used <= budget)
+			{
+				break;
+			}
+
+			const size_t bytes = file->getCPUMemory();
+			auto&& persisted = std::find(s_PersistentResources.begin(), s_PersistentResources.end(), file);
+			// Referenced only by the persistent resources and by files, so it is freed once files goes out of scope
+			if (persisted != s_PersistentResources.end() && file.use_count() == 2)
+			{
+				PRINT_SILENT("Evicted " + file->getPath().generic_string());
+				s_PersistentResources.erase(persisted);
+				used -= bytes;
+			}
+			else if (file->demote())
+			{
+				PRINT_SILENT("Demoted " + file->getPath().generic_string());
+				used -= bytes - file->getCPUMemory();
+			}
+		}
+
+		if (used > budget)
+		{
+			WARN(ResourceFile::s_TypeNames.at(type) + " files in use take " + std::to_string(used / 1024) + " KB, over their budget of " + std::to_string(budget / 1024) + " KB");
+		}
+	}
+}
+
+void ResourceLoader::DumpResidency()
+{
+	Vector<Ref<ResourceFile>> files;
+	s_ResourceCache.forEach([&files](const Ref<ResourceFile>& file) {
+		files.push_back(file);
+	});
+	std::sort(files.begin(), files.end(), [](const Ref<ResourceFile>& a, const Ref<ResourceFile>& b) {
+		return a->getType() != b->getType() ? a->getType() < b->getType() : a->getLastUsedTime() > b->getLastUsedTime();
+	});
+
+	struct Totals
+	{
+		int files = 0;
+		size_t cpuBytes = 0;
+		size_t gpuBytes = 0;
+	};
+	Map<ResourceFile::Type, Totals> totals;
+
+	std::lock_guard<RecursiveMutex> lock(s_PersistMutex);
+	const long long now = ResourceFile::GetUsedTimeNow();
+	PRINT("Resource residency: " + std::to_string(files.size()) + " files");
+	for (auto& file : files)
+	{
+		const bool isPersistent = std::find(s_PersistentResources.begin(), s_PersistentResources.end(), file) != s_PersistentResources.end();
+		Totals& typeTotals = totals[file->getType()];
+		typeTotals.files++;
+		typeTotals.cpuBytes += file->getCPUMemory();
+		typeTotals.gpuBytes += file->getGPUMemory();
+
+		// Not counting the reference held by files
+		PRINT("    " + ResourceFile::s_TypeNames.at(file->getType()) + " " + file->getPath().generic_string()
+		    + ": CPU " + std::to_string(file->getCPUMemory() / 1024) + " KB, GPU " + std::to_string(file->getGPUMemory() / 1024) + " KB"
+		    + ", used " + std::to_string((now - file->getLastUsedTime()) / 1000) + "s ago, " + std::to_string(file.use_count() - 1) + " references"
+		    + (isPersistent ? ", persistent" : "") + (file->isDemoted() ? ", demoted" : ""));
+	}
+	for (auto& [type, typeTotals] : totals)
+	{
+		auto&& budget = s_ResidencyBudgets.find(type);
+		PRINT(ResourceFile::s_TypeNames.at(type) + ": " + std::to_string(typeTotals.files) + " files, CPU " + std::to_string(typeTotals.cpuBytes / 1024) + " KB"
+		    + (budget != s_ResidencyBudgets.end() ? " of " + std::to_string(budget->second / 1024) + " KB budget" : "")
+		    + ", GPU " + std::to_string(typeTotals.gpuBytes / 1024) + " KB");
+	}
+}
+
 void ResourceLoader::Initialize()
 {
 	BasicMaterialResourceFile::Load();
@@ -123,10 +378,14 @@ void ResourceLoader::Initialize()
 	InstancingBasicMaterialResourceFile::Load();
 	SkyMaterialResourceFile::Load();
 	CustomMaterialResourceFile::Load();
+
+	s_FileWatcher.start(OS::s_RootDirectory);
 }
 
 void ResourceLoader::Destroy()
 {
+	s_FileWatcher.stop();
+	s_Placeholders.clear();
 	BasicMaterialResourceFile::Destroy();
 	AnimatedBasicMaterialResourceFile::Destroy();
 	InstancingBasicMaterialResourceFile::Destroy();
@@ -134,48 +393,109 @@ void ResourceLoader::Destroy()
 	CustomMaterialResourceFile::Destroy();
 }
 
-const HashMap<ResourceFile::Type, Vector<Weak<ResourceFile>>>& ResourceLoader::GetResources()
+ResourceLoader::DependencyScope::DependencyScope(const ResourceFile& file)
 {
-	return s_ResourcesDataFiles;
+	s_LoadingFiles.push_back({ file.getType(), file.getPath().generic_string() });
 }
 
-const char* ResourceLoader::GetCreatableExtension(ResourceFile::Type type)
+ResourceLoader::DependencyScope::DependencyScope(const ResourceKey& file)
 {
-	if (CreatableFiles.find(type) != CreatableFiles.end())
+	s_LoadingFiles.push_back(file);
+}
+
+ResourceLoader::DependencyScope::~DependencyScope()
+{
+	s_LoadingFiles.pop_back();
+}
+
+Optional<ResourceKey> ResourceLoader::GetLoadingFile()
+{
+	if (s_LoadingFiles.empty())
 	{
-		return CreatableFiles.at(type);
+		return {};
 	}
-	return nullptr;
+	return s_LoadingFiles.back();
 }
 
-void ResourceLoader::SaveResources(ResourceFile::Type type)
+void ResourceLoader::ReimportChangedFiles()
 {
-	for (auto& file : s_ResourcesDataFiles[type])
+	const Vector<String> changes = s_FileWatcher.drainChanges();
+	if (changes.empty())
+	{
+		return;
+	}
+
+	StopTimer timer;
+	Vector<ResourceKey> changed;
+	for (auto& path : changes)
 	{
-		if (Ref<ResourceFile> resFile = file.lock())
+		// The same file may be loaded as more than one type, or used without being a resource file
+		const String searchPath = ResourceCache::NormalizePath(path);
+		for (auto& [type, name] : ResourceFile::s_TypeNames)
 		{
-			if (resFile->getPath().string().substr(0, 6) != "rootex")
-			{
-				resFile->save();
-			}
+			changed.push_back({ type, searchPath });
+		}
+	}
+
+	// Everything affected is collected before any file is reimported, since reimporting records dependencies again
+	Vector<Pair<ResourceKey, Ref<ResourceFile>>> toReimport;
+	for (auto& key : s_DependencyGraph.getDependentsInOrder(changed))
+	{
+		if (key.first == ResourceFile::Type::None)
+		{
+			continue;
+		}
+		if (Ref<ResourceFile> file = s_ResourceCache.find(key.first, key.second))
+		{
+			toReimport.push_back({ key, file });
 		}
 	}
+
+	for (auto& [key, file] : toReimport)
+	{
+		PRINT("Reimporting " + key.second);
+		// Dependencies are recorded again while reimporting
+		s_DependencyGraph.clearDependencies(key);
+		DependencyScope scope(*file);
+		file->reimport();
+	}
+
+	s_LastReimportStatistics.changedFiles = changes.size();
+	s_LastReimportStatistics.reimportedFiles = toReimport.size();
+	s_LastReimportStatistics.timeMs = timer.getTimeMs();
 }
 
-void ResourceLoader::ClearDeadResources()
+void ResourceLoader::AddDependency(const ResourceFile& dependent, ResourceFile::Type type, const String& path)
 {
-	for (auto& [type, resources] : s_ResourcesDataFiles)
+	s_DependencyGraph.addDependency({ dependent.getType(), dependent.getPath().generic_string() }, { type, ResourceCache::NormalizePath(path) });
+}
+
+HashMap<ResourceFile::Type, Vector<Weak<ResourceFile>>> ResourceLoader::GetResources()
+{
+	HashMap<ResourceFile::Type, Vector<Weak<ResourceFile>>> resources;
+	s_ResourceCache.forEach([&resources](const Ref<ResourceFile>& file) {
+		resources[file->getType()].push_back(file);
+	});
+	return resources;
+}
+
+const char* ResourceLoader::GetCreatableExtension(ResourceFile::Type type)
+{
+	if (CreatableFiles.find(type) != CreatableFiles.end())
 	{
-		Vector<int> toRemove;
-		for (int i = 0; i < resources.size(); i++)
+		return CreatableFiles.at(type);
+	}
+	return nullptr;
+}
+
+void ResourceLoader::SaveResources(ResourceFile::Type type)
+{
+	s_ResourceCache.forEach([type](const Ref<ResourceFile>& file) {
+		if (file->getType() == type && file->getPath().string().substr(0, 6) != "rootex")
 		{
-			if (!resources[i].lock())
-			{
-				resources.erase(resources.begin() + i);
-				i--;
-			}
+			file->save();
 		}
-	}
+	});
 }
 
 Ref<TextResourceFile> ResourceLoader::CreateTextResourceFile(const String& path)
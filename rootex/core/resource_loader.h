@@ -1,8 +1,13 @@
 #pragma once
 
 #include "common/common.h"
+#include "os/virtual_file_system.h"
+#include "os/file_watcher.h"
 
 #include "resource_file.h"
+#include "resource_cache.h"
+#include "resource_dependency_graph.h"
+#include "async_resource.h"
 
 #include "resource_files/audio_resource_file.h"
 #include "resource_files/font_resource_file.h"
@@ -20,6 +25,9 @@
 #include "resource_files/sky_material_resource_file.h"
 #include "resource_files/custom_material_resource_file.h"
 
+/// Milliseconds between two checks of the residency budgets.
+#define RESOURCE_RESIDENCY_INTERVAL_MS 1000
+
 static const inline HashMap<ResourceFile::Type, const char*> SupportedFiles = {
 	{ ResourceFile::Type::Image, "Image(*.png;*.jpeg;*.jpg;*.dds)\0*.png;*.jpeg;*.jpg;*.dds\0" },
 	{ ResourceFile::Type::ImageCube, "Image Cube(*.dds)\0*.dds\0" },
@@ -51,6 +59,14 @@ static const inline HashMap<ResourceFile::Type, const char*> CreatableFiles = {
 
 bool IsFileSupported(const String& extension, ResourceFile::Type supportedFileType);
 
+/// Files standing in for files of each type while they load asynchronously. Other types have no placeholder.
+static const inline HashMap<ResourceFile::Type, const char*> AsyncPlaceholders = {
+	{ ResourceFile::Type::Image, "rootex/assets/checker.png" },
+	{ ResourceFile::Type::Model, "rootex/assets/cube.obj" },
+	{ ResourceFile::Type::AnimatedModel, "rootex/assets/animation.dae" },
+	{ ResourceFile::Type::Audio, "rootex/assets/silence.wav" },
+};
+
 /// Factory for ResourceFile objects. Implements creating, loading and saving files.                                \n
 /// Maintains an internal cache that doesn't let the same file to be loaded twice. Cache misses force file loading. \n
 /// This just means you can load the same file multiple times without worrying about unnecessary copies.            \n
@@ -58,22 +74,75 @@ bool IsFileSupported(const String& extension, ResourceFile::Type supportedFileTy
 /// The resource creation API is internally synchronised (threadsafe).
 class ResourceLoader
 {
-	static inline HashMap<ResourceFile::Type, Vector<Weak<ResourceFile>>> s_ResourcesDataFiles;
+public:
+	struct ReimportStatistics
+	{
+		int changedFiles = 0;
+		/// Changed files and their dependents reimported.
+		int reimportedFiles = 0;
+		float timeMs = 0.0f;
+	};
+
+private:
+	static inline ResourceCache s_ResourceCache;
 	static inline Vector<Ref<ResourceFile>> s_PersistentResources;
 
 	static inline RecursiveMutex s_PersistMutex;
-	static inline RecursiveMutex s_ResourceDataMutex;
+	static inline ReimportStatistics s_LastReimportStatistics;
+
+	/// System memory allowed per type, in bytes.
+	static inline HashMap<ResourceFile::Type, size_t> s_ResidencyBudgets;
+	static inline long long s_LastResidencyCheckTime = 0;
+
+	static inline Mutex s_AsyncMutex;
+	/// Asynchronous loads in flight, so requesting the same file again shares the load.
+	static inline HashMap<ResourceKey, Weak<AsyncResourceState>, ResourceKeyHash> s_AsyncLoads;
+	static inline HashMap<ResourceFile::Type, Ref<ResourceFile>> s_Placeholders;
+
+	/// Loads the placeholder on first use. Expects s_AsyncMutex to be locked.
+	static Ref<ResourceFile> GetPlaceholder(ResourceFile::Type type);
+	static Ref<AsyncResourceState> LoadAsync(ResourceFile::Type type, const String& path);
+
+	static inline FileWatcher s_FileWatcher;
+
+	static inline ResourceDependencyGraph s_DependencyGraph;
+	/// Files being loaded on this thread, innermost last. Files created meanwhile are dependencies of the last one.
+	static inline thread_local Vector<ResourceKey> s_LoadingFiles;
 
 	template <class T>
 	static Ref<T> GetCachedResource(ResourceFile::Type type, const FilePath& path);
 
 public:
+	/// Files created on the calling thread while a scope is alive are recorded as dependencies of the scope's file.
+	class DependencyScope
+	{
+	public:
+		DependencyScope(const ResourceFile& file);
+		/// Record for a file being loaded on another thread, as returned by GetLoadingFile() there.
+		DependencyScope(const ResourceKey& file);
+		DependencyScope(DependencyScope&) = delete;
+		~DependencyScope();
+	};
+
+	/// Innermost file being loaded on the calling thread, for work done for it on other threads. Empty if there is none.
+	static Optional<ResourceKey> GetLoadingFile();
+
 	static void Initialize();
 	static void Destroy();
-	static const HashMap<ResourceFile::Type, Vector<Weak<ResourceFile>>>& GetResources();
+	/// Reimport the loaded files reported changed on disk since the last call, and then the files depending on them
+	/// in dependency order. Called once per frame. Files saved by the engine count as changed, so saving a file
+	/// reimports it and its dependents too.
+	static void ReimportChangedFiles();
+	/// Record that dependent uses the file at path, for files not loaded through ResourceLoader. Use Type::None for
+	/// files which are not resource files.
+	static void AddDependency(const ResourceFile& dependent, ResourceFile::Type type, const String& path);
+	static ResourceDependencyGraph::Statistics GetDependencyStatistics() { return s_DependencyGraph.getStatistics(); }
+	/// Statistics of the last call to ReimportChangedFiles() which found changes.
+	static ReimportStatistics GetLastReimportStatistics() { return s_LastReimportStatistics; }
+	/// Snapshot of the loaded files by type.
+	static HashMap<ResourceFile::Type, Vector<Weak<ResourceFile>>> GetResources();
 	static const char* GetCreatableExtension(ResourceFile::Type type);
 	static void SaveResources(ResourceFile::Type type);
-	static void ClearDeadResources();
 
 	static Ref<TextResourceFile> CreateTextResourceFile(const String& path);
 	static Ref<LuaTextResourceFile> CreateLuaTextResourceFile(const String& path);
@@ -94,13 +163,32 @@ public:
 
 	static Ref<ResourceFile> CreateResourceFile(const ResourceFile::Type& type, const String& path);
 
+	/// Return right away with a placeholder and load the file on worker threads. See AsyncPlaceholders.
+	static AsyncHandle<ResourceFile> CreateResourceFileAsync(const ResourceFile::Type& type, const String& path) { return AsyncHandle<ResourceFile>(LoadAsync(type, path)); }
+	static AsyncHandle<ModelResourceFile> CreateModelResourceFileAsync(const String& path) { return AsyncHandle<ModelResourceFile>(LoadAsync(ResourceFile::Type::Model, path)); }
+	static AsyncHandle<AnimatedModelResourceFile> CreateAnimatedModelResourceFileAsync(const String& path) { return AsyncHandle<AnimatedModelResourceFile>(LoadAsync(ResourceFile::Type::AnimatedModel, path)); }
+	static AsyncHandle<ImageResourceFile> CreateImageResourceFileAsync(const String& path) { return AsyncHandle<ImageResourceFile>(LoadAsync(ResourceFile::Type::Image, path)); }
+	static AsyncHandle<AudioResourceFile> CreateAudioResourceFileAsync(const String& path) { return AsyncHandle<AudioResourceFile>(LoadAsync(ResourceFile::Type::Audio, path)); }
+
 	static Ref<TextResourceFile> CreateNewTextResourceFile(const String& path);
 	static Ref<BasicMaterialResourceFile> CreateNewBasicMaterialResourceFile(const String& path);
 	static Ref<AnimatedBasicMaterialResourceFile> CreateNewAnimatedBasicMaterialResourceFile(const String& path);
 
-	/// Load all the files passed in parallely. Return total tasks generated.
+	/// Load all the files passed in parallel, images before materials before models.
+	/// Returns the total progress, which progress reaches once every file is loaded. Progress is counted in KB of files loaded.
 	static int Preload(ResourceCollection paths, Atomic<int>& progress);
 
+	/// Limit the system memory held by files of type. Over the budget, files are evicted least recently used first:
+	/// persistent files nothing else references are released, and files still in use have their data demoted.
+	/// A budget of 0 removes the limit.
+	static void SetResidencyBudget(ResourceFile::Type type, size_t bytes);
+	/// Set budgets in MB keyed by type name, as in the "resourceBudgetsMB" application setting.
+	static void LoadResidencyBudgets(const JSON::json& budgetsMB);
+	/// Enforce the residency budgets. Called once per frame, checks at most every RESOURCE_RESIDENCY_INTERVAL_MS.
+	static void UpdateResidency();
+	/// Print every loaded file with its memory use, last use and residency, followed by the totals of each type.
+	static void DumpResidency();
+
 	/// Add a resource to be kept alive till explicitly ordered to clear them. Internally synchronised.
 	static void Persist(Ref<ResourceFile> res);
 	static void ClearPersistentResources();
@@ -109,39 +197,27 @@ public:
 template <class T>
 inline Ref<T> ResourceLoader::GetCachedResource(ResourceFile::Type type, const FilePath& path)
 {
-	s_ResourceDataMutex.lock();
-	String searchPath = path.generic_string();
-	Ref<T> ret;
-	for (auto& item : s_ResourcesDataFiles[type])
+	String searchPath = ResourceCache::NormalizePath(path);
+	if (!s_LoadingFiles.empty())
 	{
-		if (item.lock())
-		{
-			Ref<ResourceFile> itemRes = item.lock();
-			if (itemRes && itemRes->getPath() == searchPath)
-			{
-				ret = std::dynamic_pointer_cast<T>(itemRes);
-				break;
-			}
-		}
+		s_DependencyGraph.addDependency(s_LoadingFiles.back(), { type, searchPath });
 	}
-	s_ResourceDataMutex.unlock();
 
-	if (ret)
+	if (Ref<ResourceFile> cached = s_ResourceCache.find(type, searchPath))
 	{
-		return ret;
+		cached->touch();
+		return std::dynamic_pointer_cast<T>(cached);
 	}
 
 	// File not found in cache, load it
-	if (!OS::IsExists(searchPath))
+	if (!VirtualFileSystem::IsExists(searchPath))
 	{
 		ERR("File not found: " + searchPath);
 		return nullptr;
 	}
-	Ref<T> file(new T(searchPath));
-
-	s_ResourceDataMutex.lock();
-	s_ResourcesDataFiles[file->getType()].push_back(file);
-	s_ResourceDataMutex.unlock();
+	s_LoadingFiles.push_back({ type, searchPath });
+	Ref<ResourceFile> file(new T(searchPath));
+	s_LoadingFiles.pop_back();
 
-	return file;
+	return std::dynamic_pointer_cast<T>(s_ResourceCache.insert(type, searchPath, file));
 }
@@ -13,25 +13,25 @@ class Component;
 		bool Add##Type(Entity& owner, const JSON::json& componentData, bool checks = true); \
 		bool AddDefault##Type(Entity& owner, bool checks = true);                           \
 		bool Remove##Type(Entity& entity);                                                  \
-		Vector<Type>& GetAll##Type();                                                       \
+		ComponentArray<Type>& GetAll##Type();                                               \
 	}
 
 #define DEFINE_COMPONENT(Type)                                                              \
 	bool ECSFactory::Add##Type(Entity& owner, const JSON::json& componentData, bool checks) \
 	{                                                                                       \
-		return s_ComponentSets[Type::s_Name]->addComponent(owner, componentData, checks);   \
+		return s_ComponentSetsByID[Type::s_ID]->addComponent(owner, componentData, checks); \
 	}                                                                                       \
 	bool ECSFactory::AddDefault##Type(Entity& owner, bool checks)                           \
 	{                                                                                       \
-		return s_ComponentSets[Type::s_Name]->addDefaultComponent(owner, checks);           \
+		return s_ComponentSetsByID[Type::s_ID]->addDefaultComponent(owner, checks);         \
 	}                                                                                       \
 	bool ECSFactory::Remove##Type(Entity& entity)                                           \
 	{                                                                                       \
-		return s_ComponentSets[Type::s_Name]->removeComponent(entity);                      \
+		return s_ComponentSetsByID[Type::s_ID]->removeComponent(entity);                    \
 	}                                                                                       \
-	Vector<Type>& ECSFactory::GetAll##Type()                                                \
+	ComponentArray<Type>& ECSFactory::GetAll##Type()                                        \
 	{                                                                                       \
-		return ((ComponentSet<Type>*)(s_ComponentSets[Type::s_Name].get()))->getAll();      \
+		return ((ComponentSet<Type>*)(s_ComponentSetsByID[Type::s_ID]))->getAll();          \
 	}
 
 class Dependable
@@ -99,11 +99,15 @@ private:
 class Component
 {
 	Vector<Dependable*> m_Dependencies;
+	/// Storage slot occupied inside the owning ComponentSet.
+	unsigned int m_SetSlot = -1;
 
 	/// Perform setting up dependencies and internal data. Return true if successful.
 	bool setup();
 
 	friend class Entity;
+	template <class T>
+	friend class ComponentSet;
 
 protected:
 	struct Category
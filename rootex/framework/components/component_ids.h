@@ -29,5 +29,7 @@ enum class ComponentIDs : unsigned int
 	AnimatedModelComponent,
 	RenderableComponent,
 	ParticleEffectComponent,
-	PlayerController
+	PlayerController,
+	/// Number of component types. Keep this last.
+	Count
 };
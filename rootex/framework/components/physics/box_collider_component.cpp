@@ -3,27 +3,27 @@
 
 DEFINE_COMPONENT(BoxColliderComponent);
 
-BoxColliderComponent::BoxColliderComponent(Entity& owner, const JSON::json& data)
+BoxColliderComponent::Record BoxColliderComponent::MakeRecord(const JSON::json& data)
+{
+	return { MakeRigidBodyRecord(data), data.value("dimensions", Vector3 { 0.5f, 0.5f, 0.5f }) };
+}
+
+BoxColliderComponent::BoxColliderComponent(Entity& owner, const Record& record)
     : RigidBodyComponent(
         owner,
-        data.value("material", PhysicsMaterial::Air),
-        data.value("dimensions", Vector3 { 0.5f, 0.5f, 0.5f }).x * data.value("dimensions", Vector3 { 0.5f, 0.5f, 0.5f }).y * data.value("dimensions", Vector3 { 0.5f, 0.5f, 0.5f }).z,
-        data.value("offset", Vector3(0.0f, 0.0f, 0.0f)),
-        data.value("gravity", Vector3(0.0f, -9.8f, 0.0f)),
-        data.value("angularFactor", Vector3::One),
-        data.value("collisionGroup", (int)CollisionMask::All),
-        data.value("collisionMask", (int)CollisionMask::All),
-        data.value("isMoveable", false),
-        data.value("isKinematic", false),
-        data.value("isGeneratesHitEvents", false),
-        data.value("isSleepable", true),
-        data.value("isCCD", false),
-        Ref<btBoxShape>(new btBoxShape(VecTobtVector3(data.value("dimensions", Vector3 { 0.5f, 0.5f, 0.5f })))))
-    , m_Dimensions(data.value("dimensions", Vector3 { 0.5f, 0.5f, 0.5f }))
+        record.rigidBody,
+        record.dimensions.x * record.dimensions.y * record.dimensions.z,
+        Ref<btBoxShape>(new btBoxShape(VecTobtVector3(record.dimensions))))
+    , m_Dimensions(record.dimensions)
 {
 	m_BoxShape = (btBoxShape*)m_CollisionShape.get();
 }
 
+BoxColliderComponent::BoxColliderComponent(Entity& owner, const JSON::json& data)
+    : BoxColliderComponent(owner, MakeRecord(data))
+{
+}
+
 JSON::json BoxColliderComponent::getJSON() const
 {
 	JSON::json& j = RigidBodyComponent::getJSON();
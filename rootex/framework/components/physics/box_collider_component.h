@@ -12,6 +12,15 @@ class BoxColliderComponent : public RigidBodyComponent
 	btBoxShape* m_BoxShape;
 
 public:
+	/// Fields read from scene files.
+	struct Record
+	{
+		RigidBodyRecord rigidBody;
+		Vector3 dimensions;
+	};
+	static Record MakeRecord(const JSON::json& data);
+
+	BoxColliderComponent(Entity& owner, const Record& record);
 	BoxColliderComponent(Entity& owner, const JSON::json& data);
 	~BoxColliderComponent() = default;
 
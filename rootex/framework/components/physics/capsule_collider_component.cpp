@@ -3,28 +3,28 @@
 
 DEFINE_COMPONENT(CapsuleColliderComponent);
 
-CapsuleColliderComponent::CapsuleColliderComponent(Entity& owner, const JSON::json& data)
+CapsuleColliderComponent::Record CapsuleColliderComponent::MakeRecord(const JSON::json& data)
+{
+	return { MakeRigidBodyRecord(data), data.value("radius", 0.5f), data.value("sideHeight", 1.0f) };
+}
+
+CapsuleColliderComponent::CapsuleColliderComponent(Entity& owner, const Record& record)
     : RigidBodyComponent(
         owner,
-        data.value("material", PhysicsMaterial::Air),
-        DirectX::XM_PI * data.value("radius", 0.5f) * data.value("radius", 0.5f) * ((4.0f / 3.0f) * data.value("radius", 0.5f) + data.value("sideHeight", 1.0f)),
-        data.value("offset", Vector3(0.0f, 0.0f, 0.0f)),
-        data.value("gravity", Vector3(0.0f, -9.8f, 0.0f)),
-        data.value("angularFactor", Vector3::One),
-        data.value("collisionGroup", (int)CollisionMask::All),
-        data.value("collisionMask", (int)CollisionMask::All),
-        data.value("isMoveable", false),
-        data.value("isKinematic", false),
-        data.value("isGeneratesHitEvents", false),
-        data.value("isSleepable", true),
-        data.value("isCCD", false),
-        Ref<btCapsuleShape>(new btCapsuleShape(data.value("radius", 0.5f), data.value("sideHeight", 1.0f))))
-    , m_Radius(data.value("radius", 0.5f))
-    , m_SideHeight(data.value("sideHeight", 1.0f))
+        record.rigidBody,
+        DirectX::XM_PI * record.radius * record.radius * ((4.0f / 3.0f) * record.radius + record.sideHeight),
+        Ref<btCapsuleShape>(new btCapsuleShape(record.radius, record.sideHeight)))
+    , m_Radius(record.radius)
+    , m_SideHeight(record.sideHeight)
 {
 	m_CapsuleShape = (btCapsuleShape*)m_CollisionShape.get();
 }
 
+CapsuleColliderComponent::CapsuleColliderComponent(Entity& owner, const JSON::json& data)
+    : CapsuleColliderComponent(owner, MakeRecord(data))
+{
+}
+
 void CapsuleColliderComponent::setSideHeight(float s)
 {
 	detachCollisionObject();
@@ -13,6 +13,16 @@ class CapsuleColliderComponent : public RigidBodyComponent
 	btCapsuleShape* m_CapsuleShape;
 
 public:
+	/// Fields read from scene files.
+	struct Record
+	{
+		RigidBodyRecord rigidBody;
+		float radius;
+		float sideHeight;
+	};
+	static Record MakeRecord(const JSON::json& data);
+
+	CapsuleColliderComponent(Entity& owner, const Record& record);
 	CapsuleColliderComponent(Entity& owner, const JSON::json& data);
 	~CapsuleColliderComponent() = default;
 
@@ -38,6 +38,42 @@ RigidBodyComponent::RigidBodyComponent(
 	m_CollisionShape = collisionShape;
 }
 
+RigidBodyComponent::RigidBodyComponent(Entity& owner, const RigidBodyRecord& record, float volume, const Ref<btCollisionShape>& collisionShape)
+    : RigidBodyComponent(
+        owner,
+        record.material,
+        volume,
+        record.offset,
+        record.gravity,
+        record.angularFactor,
+        record.collisionGroup,
+        record.collisionMask,
+        record.isMoveable,
+        record.isKinematic,
+        record.isGeneratesHitEvents,
+        record.isSleepable,
+        record.isCCD,
+        collisionShape)
+{
+}
+
+RigidBodyComponent::RigidBodyRecord RigidBodyComponent::MakeRigidBodyRecord(const JSON::json& data)
+{
+	return {
+		data.value("material", PhysicsMaterial::Air),
+		data.value("offset", Vector3(0.0f, 0.0f, 0.0f)),
+		data.value("gravity", Vector3(0.0f, -9.8f, 0.0f)),
+		data.value("angularFactor", Vector3::One),
+		data.value("collisionGroup", (int)CollisionMask::All),
+		data.value("collisionMask", (int)CollisionMask::All),
+		data.value("isMoveable", false),
+		data.value("isKinematic", false),
+		data.value("isGeneratesHitEvents", false),
+		data.value("isSleepable", true),
+		data.value("isCCD", false)
+	};
+}
+
 bool RigidBodyComponent::setupData()
 {
 	if (m_Body)
@@ -13,6 +13,24 @@ class RigidBodyComponent : public CollisionComponent, public btMotionState
 {
 	DEPENDS_ON(TransformComponent);
 
+public:
+	/// Fields shared by colliders read from scene files.
+	struct RigidBodyRecord
+	{
+		PhysicsMaterial material;
+		Vector3 offset;
+		Vector3 gravity;
+		Vector3 angularFactor;
+		int collisionGroup;
+		int collisionMask;
+		bool isMoveable;
+		bool isKinematic;
+		bool isGeneratesHitEvents;
+		bool isSleepable;
+		bool isCCD;
+	};
+	static RigidBodyRecord MakeRigidBodyRecord(const JSON::json& data);
+
 protected:
 	Ref<btCollisionShape> m_CollisionShape;
 	btRigidBody* m_Body = nullptr;
@@ -45,6 +63,7 @@ protected:
 	    bool canSleep,
 	    bool isCCD,
 	    const Ref<btCollisionShape>& collisionShape);
+	RigidBodyComponent(Entity& owner, const RigidBodyRecord& record, float volume, const Ref<btCollisionShape>& collisionShape);
 
 	void getWorldTransform(btTransform& worldTrans) const override;
 	void setWorldTransform(const btTransform& worldTrans) override;
@@ -3,27 +3,27 @@
 
 DEFINE_COMPONENT(SphereColliderComponent);
 
-SphereColliderComponent::SphereColliderComponent(Entity& owner, const JSON::json& data)
+SphereColliderComponent::Record SphereColliderComponent::MakeRecord(const JSON::json& data)
+{
+	return { MakeRigidBodyRecord(data), data.value("radius", 1.0f) };
+}
+
+SphereColliderComponent::SphereColliderComponent(Entity& owner, const Record& record)
     : RigidBodyComponent(
         owner,
-        data.value("material", PhysicsMaterial::Air),
-        (4.0f / 3.0f) * DirectX::XM_PI * data.value("radius", 1.0f) * data.value("radius", 1.0f) * data.value("radius", 1.0f),
-        data.value("offset", Vector3(0.0f, 0.0f, 0.0f)),
-        data.value("gravity", Vector3(0.0f, -9.8f, 0.0f)),
-        data.value("angularFactor", Vector3::One),
-        data.value("collisionGroup", (int)CollisionMask::All),
-        data.value("collisionMask", (int)CollisionMask::All),
-        data.value("isMoveable", false),
-        data.value("isKinematic", false),
-        data.value("isGeneratesHitEvents", false),
-        data.value("isSleepable", true),
-        data.value("isCCD", false),
-        Ref<btSphereShape>(new btSphereShape(data.value("radius", 1.0f))))
-    , m_Radius(data.value("radius", 1.0f))
+        record.rigidBody,
+        (4.0f / 3.0f) * DirectX::XM_PI * record.radius * record.radius * record.radius,
+        Ref<btSphereShape>(new btSphereShape(record.radius)))
+    , m_Radius(record.radius)
 {
 	m_SphereShape = (btSphereShape*)m_CollisionShape.get();
 }
 
+SphereColliderComponent::SphereColliderComponent(Entity& owner, const JSON::json& data)
+    : SphereColliderComponent(owner, MakeRecord(data))
+{
+}
+
 JSON::json SphereColliderComponent::getJSON() const
 {
 	JSON::json& j = RigidBodyComponent::getJSON();
@@ -12,6 +12,15 @@ class SphereColliderComponent : public RigidBodyComponent
 	btSphereShape* m_SphereShape;
 
 public:
+	/// Fields read from scene files.
+	struct Record
+	{
+		RigidBodyRecord rigidBody;
+		float radius;
+	};
+	static Record MakeRecord(const JSON::json& data);
+
+	SphereColliderComponent(Entity& owner, const Record& record);
 	SphereColliderComponent(Entity& owner, const JSON::json& data);
 	~SphereColliderComponent() = default;
 
@@ -5,39 +5,77 @@
 
 DEFINE_COMPONENT(StaticMeshColliderComponent);
 
-StaticMeshColliderComponent::StaticMeshColliderComponent(Entity& owner, const JSON::json& data)
-    : RigidBodyComponent(
-        owner,
-        data.value("material", PhysicsMaterial::Air),
-        0.0f,
-        data.value("offset", Vector3(0.0f, 0.0f, 0.0f)),
-        Vector3::Zero,
-        Vector3::Zero,
-        data.value("collisionGroup", (int)CollisionMask::All),
-        data.value("collisionMask", (int)CollisionMask::All),
-        false,
-        false,
-        data.value("isGeneratesHitEvents", false),
-        true,
-        false,
-        nullptr)
-    , m_CollisionModel(ResourceLoader::CreateCollisionModelResourceFile(data.value("collisionModel", String("rootex/assets/cube.obj"))))
+StaticMeshColliderComponent::Record StaticMeshColliderComponent::MakeRecord(const JSON::json& data)
+{
+	Record record;
+	record.rigidBody = {
+		data.value("material", PhysicsMaterial::Air),
+		data.value("offset", Vector3(0.0f, 0.0f, 0.0f)),
+		Vector3::Zero,
+		Vector3::Zero,
+		data.value("collisionGroup", (int)CollisionMask::All),
+		data.value("collisionMask", (int)CollisionMask::All),
+		false,
+		false,
+		data.value("isGeneratesHitEvents", false),
+		true,
+		false
+	};
+	record.collisionModel = data.value("collisionModel", String("rootex/assets/cube.obj"));
+	return record;
+}
+
+void StaticMeshColliderComponent::WriteRecord(CookedWriter& writer, const Record& record)
+{
+	writer.write(record.rigidBody);
+	writer.writeString(record.collisionModel);
+}
+
+StaticMeshColliderComponent::Record StaticMeshColliderComponent::ReadRecord(CookedReader& reader)
+{
+	Record record;
+	record.rigidBody = reader.read<RigidBodyRecord>();
+	record.collisionModel = reader.readString();
+	return record;
+}
+
+StaticMeshColliderComponent::StaticMeshColliderComponent(Entity& owner, const Record& record)
+    : RigidBodyComponent(owner, record.rigidBody, 0.0f, nullptr)
+    , m_CollisionModel(ResourceLoader::CreateCollisionModelResourceFile(record.collisionModel))
 {
 	// m_MeshShape will be set during setup
 }
 
+StaticMeshColliderComponent::StaticMeshColliderComponent(Entity& owner, const JSON::json& data)
+    : StaticMeshColliderComponent(owner, MakeRecord(data))
+{
+}
+
+void StaticMeshColliderComponent::createMeshShape()
+{
+	Ref<CollisionMesh> mesh = m_CollisionModel->getCollisionMesh();
+	btOptimizedBvh* optimizedBvh = mesh->getOptimizedBvh();
+	m_MeshShape = new btBvhTriangleMeshShape(mesh->getTriangleMesh(), true, optimizedBvh == nullptr);
+	if (optimizedBvh)
+	{
+		m_MeshShape->setOptimizedBvh(optimizedBvh);
+	}
+
+	// The previous shape is deleted before the mesh it points into can be
+	m_CollisionShape.reset(m_MeshShape);
+	m_CollisionMesh = mesh;
+}
+
 bool StaticMeshColliderComponent::setupData()
 {
-	m_CollisionShape.reset(new btBvhTriangleMeshShape(m_CollisionModel->getCollisionMesh(), true));
-	m_MeshShape = (btBvhTriangleMeshShape*)m_CollisionShape.get();
+	createMeshShape();
 	return RigidBodyComponent::setupData();
 }
 
 void StaticMeshColliderComponent::createStaticMesh()
 {
 	detachCollisionObject();
-	m_CollisionShape.reset(new btBvhTriangleMeshShape(m_CollisionModel->getCollisionMesh(), true));
-	m_MeshShape = (btBvhTriangleMeshShape*)m_CollisionShape.get();
+	createMeshShape();
 	m_Body->setCollisionShape(m_MeshShape);
 	attachCollisionObject();
 }
@@ -48,6 +86,14 @@ void StaticMeshColliderComponent::setCollisionModel(Ref<CollisionModelResourceFi
 	createStaticMesh();
 }
 
+void StaticMeshColliderComponent::refreshCollisionMesh()
+{
+	if (m_CollisionMesh != m_CollisionModel->getCollisionMesh())
+	{
+		createStaticMesh();
+	}
+}
+
 JSON::json StaticMeshColliderComponent::getJSON() const
 {
 	JSON::json j = RigidBodyComponent::getJSON();
@@ -11,15 +11,32 @@ class StaticMeshColliderComponent : public RigidBodyComponent
 
 	btBvhTriangleMeshShape* m_MeshShape;
 	Ref<CollisionModelResourceFile> m_CollisionModel;
+	/// Mesh m_MeshShape points into, kept alive until the shape is replaced.
+	Ref<CollisionMesh> m_CollisionMesh;
 
+	/// Create the mesh shape over the shared BVH of the collision model instead of building one per collider.
+	void createMeshShape();
 	void createStaticMesh();
 
 public:
+	/// Fields read from scene files.
+	struct Record
+	{
+		RigidBodyRecord rigidBody;
+		String collisionModel;
+	};
+	static Record MakeRecord(const JSON::json& data);
+	static void WriteRecord(CookedWriter& writer, const Record& record);
+	static Record ReadRecord(CookedReader& reader);
+
+	StaticMeshColliderComponent(Entity& owner, const Record& record);
 	StaticMeshColliderComponent(Entity& owner, const JSON::json& data);
 	~StaticMeshColliderComponent() = default;
 
 	bool setupData() override;
 	void setCollisionModel(Ref<CollisionModelResourceFile> file);
+	/// Remake the shape if the collision model has been reimported since it was made.
+	void refreshCollisionMesh();
 
 	JSON::json getJSON() const override;
 	void draw() override;
@@ -5,27 +5,57 @@
 
 #include "entity.h"
 #include "systems/render_system.h"
+#include "transform_hierarchy.h"
 
 DEFINE_COMPONENT(TransformComponent);
 
-TransformComponent::TransformComponent(Entity& owner, const JSON::json& data)
+TransformComponent::Record TransformComponent::MakeRecord(const JSON::json& data)
+{
+	return {
+		data.value("position", Vector3::Zero),
+		data.value("rotation", Quaternion::CreateFromYawPitchRoll(0.0f, 0.0f, 0.0f)),
+		data.value("scale", Vector3 { 1.0f, 1.0f, 1.0f }),
+		data.value("boundingBox", BoundingBox { Vector3::Zero, Vector3 { 0.5f, 0.5f, 0.5f } }),
+		data.value("passDown", (int)TransformPassDown::All),
+		data.value("overrideBoundingBox", false)
+	};
+}
+
+TransformComponent::TransformComponent(Entity& owner, const Record& record)
     : Component(owner)
-    , m_TransformBuffer(
-          { data.value("position", Vector3::Zero),
-              data.value("rotation", Quaternion::CreateFromYawPitchRoll(0.0f, 0.0f, 0.0f)),
-              data.value("scale", Vector3 { 1.0f, 1.0f, 1.0f }),
-              data.value("boundingBox", BoundingBox { Vector3::Zero, Vector3 { 0.5f, 0.5f, 0.5f } }),
-              Matrix::Identity })
-    , m_TransformPassDown(data.value("passDown", (int)TransformPassDown::All))
-    , m_OverrideBoundingBox(data.value("overrideBoundingBox", false))
+    , m_TransformBuffer({ record.position, record.rotation, record.scale, record.boundingBox, Matrix::Identity })
+    , m_TransformPassDown(record.passDown)
+    , m_OverrideBoundingBox(record.overrideBoundingBox)
 {
 	updateTransformFromPositionRotationScale();
 }
 
+TransformComponent::TransformComponent(Entity& owner, const JSON::json& data)
+    : TransformComponent(owner, MakeRecord(data))
+{
+}
+
 void TransformComponent::updateAbsoluteTransformValues()
 {
 	m_AbsoluteTransform = m_TransformBuffer.transform * m_ParentAbsoluteTransform;
+	m_IsAbsoluteTransformDirty = false;
+	m_IsAbsoluteDecompositionDirty = true;
+}
+
+void TransformComponent::updateAbsoluteDecomposition()
+{
+	if (m_IsAbsoluteTransformDirty)
+	{
+		updateAbsoluteTransformValues();
+	}
 	m_AbsoluteTransform.Decompose(m_AbsoluteScale, m_AbsoluteRotation, m_AbsolutePosition);
+	m_IsAbsoluteDecompositionDirty = false;
+}
+
+void TransformComponent::markDirty()
+{
+	m_IsAbsoluteTransformDirty = true;
+	TransformHierarchy::GetSingleton()->markDirty(this);
 }
 
 void TransformComponent::updateTransformFromPositionRotationScale()
@@ -45,7 +75,7 @@ void TransformComponent::setPosition(const Vector3& position)
 {
 	m_TransformBuffer.position = position;
 	updateTransformFromPositionRotationScale();
-	m_IsAbsoluteTransformDirty = true;
+	markDirty();
 }
 
 void TransformComponent::setAbsolutePosition(const Vector3& position)
@@ -57,34 +87,34 @@ void TransformComponent::setRotation(const float& yaw, const float& pitch, const
 {
 	m_TransformBuffer.rotation = Quaternion::CreateFromYawPitchRoll(yaw, pitch, roll);
 	updateTransformFromPositionRotationScale();
-	m_IsAbsoluteTransformDirty = true;
+	markDirty();
 }
 
 void TransformComponent::setRotationQuaternion(const Quaternion& rotation)
 {
 	m_TransformBuffer.rotation = rotation;
 	updateTransformFromPositionRotationScale();
-	m_IsAbsoluteTransformDirty = true;
+	markDirty();
 }
 
 void TransformComponent::setScale(const Vector3& scale)
 {
 	m_TransformBuffer.scale = scale;
 	updateTransformFromPositionRotationScale();
-	m_IsAbsoluteTransformDirty = true;
+	markDirty();
 }
 
 void TransformComponent::setLocalTransform(const Matrix& transform)
 {
 	m_TransformBuffer.transform = transform;
 	updatePositionRotationScaleFromTransform(m_TransformBuffer.transform);
-	m_IsAbsoluteTransformDirty = true;
+	markDirty();
 }
 
 void TransformComponent::setAbsoluteTransform(const Matrix& transform)
 {
 	setLocalTransform(transform * m_ParentAbsoluteTransform.Invert());
-	m_IsAbsoluteTransformDirty = true;
+	markDirty();
 }
 
 void TransformComponent::setBounds(const BoundingBox& bounds)
@@ -99,33 +129,33 @@ void TransformComponent::setRotationPosition(const Matrix& transform)
 {
 	m_TransformBuffer.transform = Matrix::CreateScale(m_TransformBuffer.scale) * transform;
 	updatePositionRotationScaleFromTransform(m_TransformBuffer.transform);
-	m_IsAbsoluteTransformDirty = true;
+	markDirty();
 }
 
 void TransformComponent::setAbsoluteRotationPosition(const Matrix& transform)
 {
 	setAbsoluteTransform(Matrix::CreateScale(m_TransformBuffer.scale) * transform);
 	updatePositionRotationScaleFromTransform(m_TransformBuffer.transform);
-	m_IsAbsoluteTransformDirty = true;
+	markDirty();
 }
 
 void TransformComponent::setParentAbsoluteTransform(const Matrix& parentTransform)
 {
 	m_ParentAbsoluteTransform = parentTransform;
-	m_IsAbsoluteTransformDirty = true;
+	markDirty();
 }
 
 void TransformComponent::addLocalTransform(const Matrix& applyTransform)
 {
 	setLocalTransform(getLocalTransform() * applyTransform);
-	m_IsAbsoluteTransformDirty = true;
+	markDirty();
 }
 
 void TransformComponent::addQuaternion(const Quaternion& applyQuaternion)
 {
 	m_TransformBuffer.rotation = Quaternion::Concatenate(applyQuaternion, m_TransformBuffer.rotation);
 	updateTransformFromPositionRotationScale();
-	m_IsAbsoluteTransformDirty = true;
+	markDirty();
 }
 
 void TransformComponent::addRotation(float yaw, float pitch, float roll)
@@ -146,7 +176,6 @@ Matrix TransformComponent::getAbsoluteTransform()
 	{
 		updateAbsoluteTransformValues();
 	}
-	m_IsAbsoluteTransformDirty = false;
 	return m_AbsoluteTransform;
 }
 
@@ -156,27 +185,24 @@ Vector3 TransformComponent::getAbsolutePosition()
 	{
 		updateAbsoluteTransformValues();
 	}
-	m_IsAbsoluteTransformDirty = false;
-	return m_AbsolutePosition;
+	return m_AbsoluteTransform.Translation();
 }
 
 Quaternion TransformComponent::getAbsoluteRotation()
 {
-	if (m_IsAbsoluteTransformDirty)
+	if (m_IsAbsoluteDecompositionDirty || m_IsAbsoluteTransformDirty)
 	{
-		updateAbsoluteTransformValues();
+		updateAbsoluteDecomposition();
 	}
-	m_IsAbsoluteTransformDirty = false;
 	return m_AbsoluteRotation;
 }
 
 Vector3 TransformComponent::getAbsoluteScale()
 {
-	if (m_IsAbsoluteTransformDirty)
+	if (m_IsAbsoluteDecompositionDirty || m_IsAbsoluteTransformDirty)
 	{
-		updateAbsoluteTransformValues();
+		updateAbsoluteDecomposition();
 	}
-	m_IsAbsoluteTransformDirty = false;
 	return m_AbsoluteScale;
 }
 
@@ -271,6 +297,7 @@ void TransformComponent::draw()
 	}
 
 	updateTransformFromPositionRotationScale();
+	markDirty();
 }
 
 void TransformComponent::highlight()
@@ -36,18 +36,41 @@ class TransformComponent : public Component
 	Quaternion m_AbsoluteRotation;
 	Vector3 m_AbsoluteScale;
 	bool m_IsAbsoluteTransformDirty = true;
+	bool m_IsAbsoluteDecompositionDirty = true;
 	bool m_OverrideBoundingBox;
 
+	/// Position in the TransformHierarchy, refreshed whenever the hierarchy is rebuilt.
+	unsigned int m_HierarchyIndex = -1;
+	/// True while queued for the next TransformHierarchy update.
+	bool m_IsHierarchyDirty = false;
+
 	const TransformBuffer* getTransformBuffer() const { return &m_TransformBuffer; };
 
 	void updateAbsoluteTransformValues();
+	void updateAbsoluteDecomposition();
 	void updateTransformFromPositionRotationScale();
 	void updatePositionRotationScaleFromTransform(Matrix& transform);
+	/// Invalidate the absolute transform of this and of all transforms below it in the scene tree.
+	void markDirty();
 
 	friend class ModelComponent;
 	friend class RenderSystem;
+	friend class TransformHierarchy;
 
 public:
+	/// Fields read from scene files.
+	struct Record
+	{
+		Vector3 position;
+		Quaternion rotation;
+		Vector3 scale;
+		BoundingBox boundingBox;
+		int passDown;
+		bool overrideBoundingBox;
+	};
+	static Record MakeRecord(const JSON::json& data);
+
+	TransformComponent(Entity& owner, const Record& record);
 	TransformComponent(Entity& owner, const JSON::json& data);
 	~TransformComponent() = default;
 
@@ -0,0 +1,179 @@
+#include "transform_hierarchy.h"
+
+#include "framework/scene.h"
+#include "framework/ecs_factory.h"
+#include "transform_component.h"
+
+#include "Tracy/Tracy.hpp"
+
+TransformHierarchy* TransformHierarchy::GetSingleton()
+{
+	static TransformHierarchy singleton;
+	return &singleton;
+}
+
+void TransformHierarchy::markDirty(TransformComponent* transform)
+{
+	if (transform->m_IsHierarchyDirty)
+	{
+		return;
+	}
+	transform->m_IsHierarchyDirty = true;
+
+	if (transform->m_HierarchyIndex < m_Transforms.size())
+	{
+		std::lock_guard<Mutex> lock(m_DirtyMutex);
+		m_DirtyIndices.push_back(transform->m_HierarchyIndex);
+	}
+}
+
+void TransformHierarchy::rebuild(Scene* root)
+{
+	m_Root = root;
+	m_SceneVersion = Scene::GetHierarchyVersion();
+	m_TransformVersion = ECSFactory::s_ComponentSetsByID[TransformComponent::s_ID]->getVersion();
+
+	m_Transforms.clear();
+	m_Parents.clear();
+	m_SubtreeEnds.clear();
+	if (root)
+	{
+		flatten(root, -1);
+	}
+	m_PassedDown.resize(m_Transforms.size());
+
+	std::lock_guard<Mutex> lock(m_DirtyMutex);
+	m_DirtyIndices.clear();
+	if (!m_Transforms.empty())
+	{
+		m_DirtyIndices.push_back(0);
+	}
+}
+
+void TransformHierarchy::flatten(Scene* scene, int parent)
+{
+	const unsigned int index = m_Transforms.size();
+	TransformComponent* transform = scene->getEntity().getComponent<TransformComponent>();
+	if (transform)
+	{
+		transform->m_HierarchyIndex = index;
+	}
+	m_Transforms.push_back(transform);
+	m_Parents.push_back(parent);
+	m_SubtreeEnds.push_back(0);
+
+	for (auto& child : scene->getChildren())
+	{
+		flatten(child.get(), index);
+	}
+	m_SubtreeEnds[index] = m_Transforms.size();
+}
+
+void TransformHierarchy::updateNode(unsigned int index)
+{
+	const int parent = m_Parents[index];
+	const DirectX::XMMATRIX parentMatrix = parent == -1 ? DirectX::XMMatrixIdentity() : DirectX::XMLoadFloat4x4(&m_PassedDown[parent]);
+
+	TransformComponent* transform = m_Transforms[index];
+	if (!transform)
+	{
+		DirectX::XMStoreFloat4x4(&m_PassedDown[index], parentMatrix);
+		return;
+	}
+
+	const DirectX::XMMATRIX localMatrix = DirectX::XMLoadFloat4x4(&transform->m_TransformBuffer.transform);
+	DirectX::XMStoreFloat4x4(&transform->m_ParentAbsoluteTransform, parentMatrix);
+	DirectX::XMStoreFloat4x4(&transform->m_AbsoluteTransform, DirectX::XMMatrixMultiply(localMatrix, parentMatrix));
+	transform->m_IsAbsoluteTransformDirty = false;
+	transform->m_IsAbsoluteDecompositionDirty = true;
+	transform->m_IsHierarchyDirty = false;
+
+	const int passDown = transform->getPassDowns();
+	if (passDown == (int)TransformPassDown::All)
+	{
+		DirectX::XMStoreFloat4x4(&m_PassedDown[index], DirectX::XMMatrixMultiply(localMatrix, parentMatrix));
+		return;
+	}
+
+	DirectX::XMMATRIX passedDown = DirectX::XMMatrixIdentity();
+	if (passDown & (int)TransformPassDown::Position)
+	{
+		passedDown = DirectX::XMMatrixMultiply(Matrix::CreateTranslation(transform->getPosition()), passedDown);
+	}
+	if (passDown & (int)TransformPassDown::Rotation)
+	{
+		passedDown = DirectX::XMMatrixMultiply(Matrix::CreateFromQuaternion(transform->getRotation()), passedDown);
+	}
+	if (passDown & (int)TransformPassDown::Scale)
+	{
+		passedDown = DirectX::XMMatrixMultiply(Matrix::CreateScale(transform->getScale()), passedDown);
+	}
+	DirectX::XMStoreFloat4x4(&m_PassedDown[index], DirectX::XMMatrixMultiply(passedDown, parentMatrix));
+}
+
+void TransformHierarchy::updateRange(ThreadPool& pool, unsigned int begin, unsigned int end)
+{
+	if (end - begin < TRANSFORM_HIERARCHY_PARALLEL_THRESHOLD)
+	{
+		// Depth-first order guarantees parents are computed before their children
+		for (unsigned int i = begin; i < end; i++)
+		{
+			updateNode(i);
+		}
+		return;
+	}
+
+	updateNode(begin);
+
+	Vector<Pair<unsigned int, unsigned int>> children;
+	for (unsigned int child = begin + 1; child < end; child = m_SubtreeEnds[child])
+	{
+		children.push_back({ child, m_SubtreeEnds[child] });
+	}
+	pool.parallelFor(0, children.size(), 1, [this, &pool, &children](size_t first, size_t last) {
+		for (size_t i = first; i < last; i++)
+		{
+			updateRange(pool, children[i].first, children[i].second);
+		}
+	});
+}
+
+void TransformHierarchy::update(Scene* root, ThreadPool& pool)
+{
+	ZoneScoped;
+	if (root != m_Root
+	    || m_SceneVersion != Scene::GetHierarchyVersion()
+	    || m_TransformVersion != ECSFactory::s_ComponentSetsByID[TransformComponent::s_ID]->getVersion())
+	{
+		rebuild(root);
+	}
+
+	Vector<unsigned int> dirtyIndices;
+	{
+		std::lock_guard<Mutex> lock(m_DirtyMutex);
+		if (m_DirtyIndices.empty())
+		{
+			return;
+		}
+		dirtyIndices.swap(m_DirtyIndices);
+	}
+	std::sort(dirtyIndices.begin(), dirtyIndices.end());
+
+	// Dirty subtrees nested inside an earlier dirty subtree are covered by it
+	Vector<Pair<unsigned int, unsigned int>> ranges;
+	for (unsigned int index : dirtyIndices)
+	{
+		if (index >= m_Transforms.size() || (!ranges.empty() && index < ranges.back().second))
+		{
+			continue;
+		}
+		ranges.push_back({ index, m_SubtreeEnds[index] });
+	}
+
+	pool.parallelFor(0, ranges.size(), 64, [this, &pool, &ranges](size_t first, size_t last) {
+		for (size_t i = first; i < last; i++)
+		{
+			updateRange(pool, ranges[i].first, ranges[i].second);
+		}
+	});
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "common/common.h"
+#include "os/thread.h"
+
+class Scene;
+class TransformComponent;
+
+/// Subtrees larger than this many scenes are split across the thread pool by child subtree.
+#define TRANSFORM_HIERARCHY_PARALLEL_THRESHOLD 512
+
+/// Flattened scene tree used to propagate absolute transforms. Scenes are stored in depth-first order so every subtree
+/// is a contiguous range. Only the subtrees of transforms changed since the last update are recomputed.
+class TransformHierarchy
+{
+	Scene* m_Root = nullptr;
+	unsigned int m_SceneVersion = -1;
+	unsigned int m_TransformVersion = -1;
+
+	Vector<TransformComponent*> m_Transforms;
+	/// Index of the parent scene, -1 for the root.
+	Vector<int> m_Parents;
+	/// One past the last index of the subtree rooted at each scene.
+	Vector<unsigned int> m_SubtreeEnds;
+	/// Transform passed down to the children of each scene.
+	Vector<Matrix> m_PassedDown;
+
+	Mutex m_DirtyMutex;
+	Vector<unsigned int> m_DirtyIndices;
+
+	TransformHierarchy() = default;
+	TransformHierarchy(TransformHierarchy&) = delete;
+
+	void rebuild(Scene* root);
+	void flatten(Scene* scene, int parent);
+	void updateNode(unsigned int index);
+	void updateRange(ThreadPool& pool, unsigned int begin, unsigned int end);
+
+public:
+	static TransformHierarchy* GetSingleton();
+
+	/// Queue the subtree under transform for recomputation in the next update.
+	void markDirty(TransformComponent* transform);
+	/// Recompute absolute transforms of all dirty subtrees under root.
+	void update(Scene* root, ThreadPool& pool);
+
+	size_t size() const { return m_Transforms.size(); }
+};
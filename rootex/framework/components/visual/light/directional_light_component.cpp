@@ -2,16 +2,27 @@
 
 DEFINE_COMPONENT(DirectionalLightComponent);
 
-DirectionalLightComponent::DirectionalLightComponent(Entity& owner, const JSON::json& data)
+DirectionalLightComponent::Record DirectionalLightComponent::MakeRecord(const JSON::json& data)
+{
+	return {
+		data.value("diffuseIntensity", 0.8f),
+		data.value("diffuseColor", Color(1.0f, 1.0f, 0.5f, 1.0f)),
+		data.value("ambientColor", Color(1.0f, 1.0f, 0.5f, 1.0f))
+	};
+}
+
+DirectionalLightComponent::DirectionalLightComponent(Entity& owner, const Record& record)
     : Component(owner)
-    , m_DirectionalLight(
-          { data.value("diffuseIntensity", 0.8f),
-              data.value("diffuseColor", Color(1.0f, 1.0f, 0.5f, 1.0f)),
-              data.value("ambientColor", Color(1.0f, 1.0f, 0.5f, 1.0f)) })
+    , m_DirectionalLight(record)
     , m_DependencyOnTransformComponent(this)
 {
 }
 
+DirectionalLightComponent::DirectionalLightComponent(Entity& owner, const JSON::json& data)
+    : DirectionalLightComponent(owner, MakeRecord(data))
+{
+}
+
 JSON::json DirectionalLightComponent::getJSON() const
 {
 	JSON::json j;
@@ -14,6 +14,11 @@ class DirectionalLightComponent : public Component
 	DirectionalLight m_DirectionalLight;
 
 public:
+	/// Fields read from scene files.
+	typedef DirectionalLight Record;
+	static Record MakeRecord(const JSON::json& data);
+
+	DirectionalLightComponent(Entity& owner, const Record& record);
 	DirectionalLightComponent(Entity& owner, const JSON::json& data);
 	~DirectionalLightComponent() = default;
 
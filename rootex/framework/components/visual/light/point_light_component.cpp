@@ -5,17 +5,29 @@
 
 DEFINE_COMPONENT(PointLightComponent);
 
-PointLightComponent::PointLightComponent(Entity& owner, const JSON::json& data)
+PointLightComponent::Record PointLightComponent::MakeRecord(const JSON::json& data)
+{
+	Record record;
+	record.ambientColor = data.value("diffuseColor", Color(1.0f, 1.0f, 1.0f, 1.0f));
+	record.attConst = data.value("attConst", 0.045f);
+	record.attLin = data.value("attLin", 1.0f);
+	record.attQuad = data.value("attQuad", 0.0075f);
+	record.diffuseColor = data.value("diffuseColor", Color(1.0f, 1.0f, 1.0f, 1.0f));
+	record.diffuseIntensity = data.value("diffuseIntensity", 1.0f);
+	record.range = data.value("range", 10.0f);
+	return record;
+}
+
+PointLightComponent::PointLightComponent(Entity& owner, const Record& record)
     : Component(owner)
+    , m_PointLight(record)
     , m_DependencyOnTransformComponent(this)
 {
-	m_PointLight.ambientColor = data.value("diffuseColor", Color(1.0f, 1.0f, 1.0f, 1.0f));
-	m_PointLight.attConst = data.value("attConst", 0.045f);
-	m_PointLight.attLin = data.value("attLin", 1.0f);
-	m_PointLight.attQuad = data.value("attQuad", 0.0075f);
-	m_PointLight.diffuseColor = data.value("diffuseColor", Color(1.0f, 1.0f, 1.0f, 1.0f));
-	m_PointLight.diffuseIntensity = data.value("diffuseIntensity", 1.0f);
-	m_PointLight.range = data.value("range", 10.0f);
+}
+
+PointLightComponent::PointLightComponent(Entity& owner, const JSON::json& data)
+    : PointLightComponent(owner, MakeRecord(data))
+{
 }
 
 JSON::json PointLightComponent::getJSON() const
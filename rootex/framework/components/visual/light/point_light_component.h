@@ -14,7 +14,12 @@ class PointLightComponent : public Component
 	PointLight m_PointLight;
 
 public:
-	PointLightComponent::PointLightComponent(Entity& owner, const JSON::json& data);
+	/// Fields read from scene files.
+	typedef PointLight Record;
+	static Record MakeRecord(const JSON::json& data);
+
+	PointLightComponent(Entity& owner, const Record& record);
+	PointLightComponent(Entity& owner, const JSON::json& data);
 	~PointLightComponent() = default;
 
 	Matrix getAbsoluteTransform() { return getTransformComponent()->getAbsoluteTransform(); }
@@ -5,19 +5,31 @@
 
 DEFINE_COMPONENT(SpotLightComponent);
 
-SpotLightComponent::SpotLightComponent(Entity& owner, const JSON::json& data)
+SpotLightComponent::Record SpotLightComponent::MakeRecord(const JSON::json& data)
+{
+	Record record;
+	record.ambientColor = data.value("diffuseColor", Color(1.0f, 1.0f, 1.0f, 1.0f));
+	record.attConst = data.value("attConst", 0.045f);
+	record.attLin = data.value("attLin", 1.0f);
+	record.attQuad = data.value("attQuad", 0.0075f);
+	record.diffuseColor = data.value("diffuseColor", Color(1.0f, 1.0f, 1.0f, 1.0f));
+	record.diffuseIntensity = data.value("diffuseIntensity", 1.0f);
+	record.range = data.value("range", 10.0f);
+	record.spot = data.value("spot", 4.0f);
+	record.angleRange = data.value("angleRange", DirectX::XMConvertToRadians(30.0f));
+	return record;
+}
+
+SpotLightComponent::SpotLightComponent(Entity& owner, const Record& record)
     : Component(owner)
+    , m_SpotLight(record)
     , m_DependencyOnTransformComponent(this)
 {
-	m_SpotLight.ambientColor = data.value("diffuseColor", Color(1.0f, 1.0f, 1.0f, 1.0f));
-	m_SpotLight.attConst = data.value("attConst", 0.045f);
-	m_SpotLight.attLin = data.value("attLin", 1.0f);
-	m_SpotLight.attQuad = data.value("attQuad", 0.0075f);
-	m_SpotLight.diffuseColor = data.value("diffuseColor", Color(1.0f, 1.0f, 1.0f, 1.0f));
-	m_SpotLight.diffuseIntensity = data.value("diffuseIntensity", 1.0f);
-	m_SpotLight.range = data.value("range", 10.0f);
-	m_SpotLight.spot = data.value("spot", 4.0f);
-	m_SpotLight.angleRange = data.value("angleRange", DirectX::XMConvertToRadians(30.0f));
+}
+
+SpotLightComponent::SpotLightComponent(Entity& owner, const JSON::json& data)
+    : SpotLightComponent(owner, MakeRecord(data))
+{
 }
 
 JSON::json SpotLightComponent::getJSON() const
@@ -15,7 +15,12 @@ class SpotLightComponent : public Component
 	SpotLight m_SpotLight;
 
 public:
-	SpotLightComponent::SpotLightComponent(Entity& owner, const JSON::json& data);
+	/// Fields read from scene files.
+	typedef SpotLight Record;
+	static Record MakeRecord(const JSON::json& data);
+
+	SpotLightComponent(Entity& owner, const Record& record);
+	SpotLightComponent(Entity& owner, const JSON::json& data);
 	~SpotLightComponent() = default;
 
 	Matrix getAbsoluteTransform() { return getTransformComponent()->getAbsoluteTransform(); }
@@ -19,11 +19,52 @@ bool CompareMaterials(const Pair<Ref<MaterialResourceFile>, Vector<Mesh>>& a, co
 	return !a.first->isAlpha() && b.first->isAlpha();
 }
 
+ModelComponent::Record ModelComponent::MakeRecord(const JSON::json& data)
+{
+	return {
+		MakeRenderableRecord(data),
+		data.value("resFile", "rootex/assets/cube.obj"),
+		data.value("materialOverrides", HashMap<String, String>())
+	};
+}
+
+void ModelComponent::WriteRecord(CookedWriter& writer, const Record& record)
+{
+	WriteRenderableRecord(writer, record.renderable);
+	writer.writeString(record.resFile);
+	writer.write((unsigned int)record.materialOverrides.size());
+	for (auto& [oldMaterial, newMaterial] : record.materialOverrides)
+	{
+		writer.writeString(oldMaterial);
+		writer.writeString(newMaterial);
+	}
+}
+
+ModelComponent::Record ModelComponent::ReadRecord(CookedReader& reader)
+{
+	Record record;
+	record.renderable = ReadRenderableRecord(reader);
+	record.resFile = reader.readString();
+	// Every string is at least its length
+	const size_t overrideCount = reader.readCount(2 * sizeof(unsigned long long));
+	for (size_t i = 0; i < overrideCount; i++)
+	{
+		String oldMaterial = reader.readString();
+		record.materialOverrides[oldMaterial] = reader.readString();
+	}
+	return record;
+}
+
+ModelComponent::ModelComponent(Entity& owner, const Record& record)
+    : RenderableComponent(owner, record.renderable)
+    , m_ModelResourceFile(ResourceLoader::CreateModelResourceFile(record.resFile))
+{
+	assignOverrides(m_ModelResourceFile, record.materialOverrides);
+}
+
 ModelComponent::ModelComponent(Entity& owner, const JSON::json& data)
-    : RenderableComponent(owner, data)
-    , m_ModelResourceFile(ResourceLoader::CreateModelResourceFile(data.value("resFile", "rootex/assets/cube.obj")))
+    : ModelComponent(owner, MakeRecord(data))
 {
-	assignOverrides(m_ModelResourceFile, data.value("materialOverrides", HashMap<String, String>()));
 }
 
 bool ModelComponent::setupData()
@@ -20,6 +20,18 @@ protected:
 	void assignOverrides(Ref<ModelResourceFile> newModel, const HashMap<String, String>& materialOverrides);
 
 public:
+	/// Fields read from scene files.
+	struct Record
+	{
+		RenderableRecord renderable;
+		String resFile;
+		HashMap<String, String> materialOverrides;
+	};
+	static Record MakeRecord(const JSON::json& data);
+	static void WriteRecord(CookedWriter& writer, const Record& record);
+	static Record ReadRecord(CookedReader& reader);
+
+	ModelComponent(Entity& owner, const Record& record);
 	ModelComponent(Entity& owner, const JSON::json& data);
 	virtual ~ModelComponent() = default;
 
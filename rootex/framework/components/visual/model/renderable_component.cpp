@@ -6,19 +6,62 @@
 #include "systems/render_system.h"
 #include "scene_loader.h"
 
-RenderableComponent::RenderableComponent(Entity& owner, const JSON::json& data)
+RenderableComponent::RenderableRecord RenderableComponent::MakeRenderableRecord(const JSON::json& data)
+{
+	return {
+		(unsigned int)data.value("renderPass", (int)RenderPass::Basic),
+		data.value("isVisible", true),
+		data.value("affectingStaticLights", Vector<SceneID>()),
+		data.value("lodEnable", true),
+		data.value("lodBias", 0.0f),
+		data.value("lodDistance", 10.0f)
+	};
+}
+
+void RenderableComponent::WriteRenderableRecord(CookedWriter& writer, const RenderableRecord& record)
+{
+	writer.write(record.renderPass);
+	writer.write(record.isVisible);
+	writer.write(record.lodEnable);
+	writer.write(record.lodBias);
+	writer.write(record.lodDistance);
+	writer.writeArray(record.affectingStaticLights);
+}
+
+RenderableComponent::RenderableRecord RenderableComponent::ReadRenderableRecord(CookedReader& reader)
+{
+	RenderableRecord record;
+	record.renderPass = reader.read<unsigned int>();
+	record.isVisible = reader.read<bool>();
+	record.lodEnable = reader.read<bool>();
+	record.lodBias = reader.read<float>();
+	record.lodDistance = reader.read<float>();
+	size_t lightCount = 0;
+	if (const SceneID* lights = reader.readArray<SceneID>(lightCount))
+	{
+		record.affectingStaticLights.assign(lights, lights + lightCount);
+	}
+	return record;
+}
+
+RenderableComponent::RenderableComponent(Entity& owner, const RenderableRecord& record)
     : Component(owner)
-    , m_RenderPass(data.value("renderPass", (int)RenderPass::Basic))
-    , m_IsVisible(data.value("isVisible", true))
-    , m_AffectingStaticLightIDs(data.value("affectingStaticLights", Vector<SceneID>()))
-    , m_LODEnable(data.value("lodEnable", true))
-    , m_LODBias(data.value("lodBias", 0.0f))
-    , m_LODDistance(data.value("lodDistance", 10.0f))
+    , m_RenderPass(record.renderPass)
+    , m_IsVisible(record.isVisible)
+    , m_AffectingStaticLightIDs(record.affectingStaticLights)
+    , m_LODEnable(record.lodEnable)
+    , m_LODBias(record.lodBias)
+    , m_LODDistance(record.lodDistance)
     , m_DependencyOnTransformComponent(this)
 {
 	m_PerModelCB = RenderingDevice::GetSingleton()->createBuffer<PerModelPSCB>(PerModelPSCB(), D3D11_BIND_CONSTANT_BUFFER, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE);
 }
 
+RenderableComponent::RenderableComponent(Entity& owner, const JSON::json& data)
+    : RenderableComponent(owner, MakeRenderableRecord(data))
+{
+}
+
 float RenderableComponent::getLODFactor(float viewDistance)
 {
 	return m_LODEnable ? m_LODBias + m_LODDistance / viewDistance : 1.0f;
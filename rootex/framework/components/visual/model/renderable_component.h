@@ -10,6 +10,21 @@ class RenderableComponent : public Component
 {
 	DEPENDS_ON(TransformComponent);
 
+public:
+	/// Fields shared by renderables read from scene files.
+	struct RenderableRecord
+	{
+		unsigned int renderPass;
+		bool isVisible;
+		Vector<SceneID> affectingStaticLights;
+		bool lodEnable;
+		float lodBias;
+		float lodDistance;
+	};
+	static RenderableRecord MakeRenderableRecord(const JSON::json& data);
+	static void WriteRenderableRecord(CookedWriter& writer, const RenderableRecord& record);
+	static RenderableRecord ReadRenderableRecord(CookedReader& reader);
+
 protected:
 	bool m_IsVisible;
 	unsigned int m_RenderPass;
@@ -24,6 +39,7 @@ protected:
 
 	Microsoft::WRL::ComPtr<ID3D11Buffer> m_PerModelCB;
 
+	RenderableComponent(Entity& owner, const RenderableRecord& record);
 	RenderableComponent(Entity& owner, const JSON::json& data);
 
 	float getLODFactor(float viewDistance);
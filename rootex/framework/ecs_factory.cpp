@@ -30,8 +30,16 @@
 #include "components/game/player_controller.h"
 
 HashMap<String, Ptr<BaseComponentSet>> ECSFactory::s_ComponentSets;
+Array<BaseComponentSet*, MAX_COMPONENT_TYPES> ECSFactory::s_ComponentSetsByID = {};
 
-#define ASSIGN_COMPONENT_SET(ComponentType) s_ComponentSets[ComponentType::s_Name] = std::make_unique<ComponentSet<ComponentType>>()
+#define ASSIGN_COMPONENT_SET(ComponentType)                                                   \
+	s_ComponentSets[ComponentType::s_Name] = std::make_unique<ComponentSet<ComponentType>>(); \
+	s_ComponentSetsByID[ComponentType::s_ID] = s_ComponentSets[ComponentType::s_Name].get()
+
+/// For component types whose constructors are safe to run on worker threads.
+#define ASSIGN_THREAD_SAFE_COMPONENT_SET(ComponentType) \
+	ASSIGN_COMPONENT_SET(ComponentType);                \
+	s_ComponentSetsByID[ComponentType::s_ID]->setMainThreadOnly(false)
 
 void ECSFactory::FillEntity(Entity& entity, const JSON::json& entityJSON)
 {
@@ -40,17 +48,31 @@ void ECSFactory::FillEntity(Entity& entity, const JSON::json& entityJSON)
 		return;
 	}
 
-	JSON::json componentJSON;
+	EntityData entityData;
+	entityData.isEmpty = false;
+	entityData.script = entityJSON.value("script", JSON::json::object());
 	if (entityJSON.contains("components"))
 	{
-		componentJSON = entityJSON["components"];
+		for (auto&& [componentName, componentDescription] : entityJSON["components"].items())
+		{
+			entityData.components.push_back({ componentName, componentDescription });
+		}
 	}
+	FillEntity(entity, entityData);
+}
 
-	entity.setScriptJSON(entityJSON.value("script", JSON::json::object()));
+void ECSFactory::FillEntity(Entity& entity, const EntityData& entityData)
+{
+	if (entityData.isEmpty)
+	{
+		return;
+	}
+
+	entity.setScriptJSON(entityData.script);
 
-	for (auto&& [componentName, componentDescription] : componentJSON.items())
+	for (auto&& [componentName, componentDescription, componentRecord] : entityData.components)
 	{
-		if (!s_ComponentSets[componentName]->addComponent(entity, componentDescription, false))
+		if (!s_ComponentSets[componentName]->addComponent(entity, componentDescription, componentRecord.get(), false))
 		{
 			PRINT("Could not add " + componentName + " to " + entity.getName());
 		}
@@ -74,17 +96,15 @@ void ECSFactory::CopyEntity(Entity& entity, Entity& copyTarget)
 	FillEntity(entity, copyTarget.getJSON());
 }
 
-String ECSFactory::GetComponentNameByID(ComponentID componentID)
+const String& ECSFactory::GetComponentNameByID(ComponentID componentID)
 {
-	for (auto& componentData : s_ComponentSets)
+	if (componentID < MAX_COMPONENT_TYPES && s_ComponentSetsByID[componentID])
 	{
-		if (componentData.second->getID() == componentID)
-		{
-			return componentData.first;
-		}
+		return s_ComponentSetsByID[componentID]->getName();
 	}
+	static const String notFound = "";
 	WARN("Could not find component name with ID: " + std::to_string(componentID));
-	return "";
+	return notFound;
 }
 
 ComponentID ECSFactory::GetComponentIDByName(const String& componentName)
@@ -94,7 +114,7 @@ ComponentID ECSFactory::GetComponentIDByName(const String& componentName)
 
 bool ECSFactory::RemoveComponent(Entity& entity, ComponentID componentID)
 {
-	return s_ComponentSets[GetComponentNameByID(componentID)]->removeComponent(entity);
+	return s_ComponentSetsByID[componentID]->removeComponent(entity);
 }
 
 void ECSFactory::FillRootEntity(Entity& root)
@@ -109,46 +129,48 @@ void ECSFactory::FillRootEntity(Entity& root)
 
 void ECSFactory::Initialize()
 {
+	// Components creating UI documents, effects, player state or new material files are constructed on the main thread
 	ASSIGN_COMPONENT_SET(PlayerController);
 
-	ASSIGN_COMPONENT_SET(CameraComponent);
-	ASSIGN_COMPONENT_SET(TransformComponent);
-	ASSIGN_COMPONENT_SET(TransformAnimationComponent);
+	ASSIGN_THREAD_SAFE_COMPONENT_SET(CameraComponent);
+	ASSIGN_THREAD_SAFE_COMPONENT_SET(TransformComponent);
+	ASSIGN_THREAD_SAFE_COMPONENT_SET(TransformAnimationComponent);
 
-	ASSIGN_COMPONENT_SET(AudioListenerComponent);
+	ASSIGN_THREAD_SAFE_COMPONENT_SET(AudioListenerComponent);
+	// Audio sources create OpenAL buffers and pin their audio files while the audio systems may be streaming
 	ASSIGN_COMPONENT_SET(MusicComponent);
 	ASSIGN_COMPONENT_SET(ShortMusicComponent);
 
-	ASSIGN_COMPONENT_SET(BoxColliderComponent);
-	ASSIGN_COMPONENT_SET(CapsuleColliderComponent);
-	ASSIGN_COMPONENT_SET(SphereColliderComponent);
-	ASSIGN_COMPONENT_SET(StaticMeshColliderComponent);
-	ASSIGN_COMPONENT_SET(TriggerComponent);
+	ASSIGN_THREAD_SAFE_COMPONENT_SET(BoxColliderComponent);
+	ASSIGN_THREAD_SAFE_COMPONENT_SET(CapsuleColliderComponent);
+	ASSIGN_THREAD_SAFE_COMPONENT_SET(SphereColliderComponent);
+	ASSIGN_THREAD_SAFE_COMPONENT_SET(StaticMeshColliderComponent);
+	ASSIGN_THREAD_SAFE_COMPONENT_SET(TriggerComponent);
 
-	ASSIGN_COMPONENT_SET(ModelComponent);
+	ASSIGN_THREAD_SAFE_COMPONENT_SET(ModelComponent);
 	ASSIGN_COMPONENT_SET(AnimatedModelComponent);
-	ASSIGN_COMPONENT_SET(GridModelComponent);
+	ASSIGN_THREAD_SAFE_COMPONENT_SET(GridModelComponent);
 
-	ASSIGN_COMPONENT_SET(PointLightComponent);
-	ASSIGN_COMPONENT_SET(SpotLightComponent);
-	ASSIGN_COMPONENT_SET(DirectionalLightComponent);
-	ASSIGN_COMPONENT_SET(StaticPointLightComponent);
+	ASSIGN_THREAD_SAFE_COMPONENT_SET(PointLightComponent);
+	ASSIGN_THREAD_SAFE_COMPONENT_SET(SpotLightComponent);
+	ASSIGN_THREAD_SAFE_COMPONENT_SET(DirectionalLightComponent);
+	ASSIGN_THREAD_SAFE_COMPONENT_SET(StaticPointLightComponent);
 
 	ASSIGN_COMPONENT_SET(TextUIComponent);
 	ASSIGN_COMPONENT_SET(UIComponent);
 
-	ASSIGN_COMPONENT_SET(FogComponent);
-	ASSIGN_COMPONENT_SET(SkyComponent);
-	ASSIGN_COMPONENT_SET(CPUParticlesComponent);
+	ASSIGN_THREAD_SAFE_COMPONENT_SET(FogComponent);
+	ASSIGN_THREAD_SAFE_COMPONENT_SET(SkyComponent);
+	ASSIGN_THREAD_SAFE_COMPONENT_SET(CPUParticlesComponent);
 	ASSIGN_COMPONENT_SET(ParticleEffectComponent);
 }
 
 bool ECSFactory::AddComponent(Entity& entity, ComponentID componentID, const JSON::json& componentData, bool checks)
 {
-	return s_ComponentSets[GetComponentNameByID(componentID)]->addComponent(entity, componentData, checks);
+	return s_ComponentSetsByID[componentID]->addComponent(entity, componentData, checks);
 }
 
 bool ECSFactory::AddDefaultComponent(Entity& entity, ComponentID componentID, bool checks)
 {
-	return s_ComponentSets[GetComponentNameByID(componentID)]->addDefaultComponent(entity, checks);
+	return s_ComponentSetsByID[componentID]->addDefaultComponent(entity, checks);
 }
@@ -1,55 +1,392 @@
 #pragma once
 
 #include "common/common.h"
+#include "core/cooked_cache.h"
 #include "core/resource_files/text_resource_file.h"
+#include "os/thread.h"
 
 #include "scene.h"
 #include "entity.h"
 
-#define MAX_COMPONENT_ARRAY_SIZE 1000
+/// Number of component instances allocated together in one page of a ComponentSet
+#define COMPONENT_PAGE_SIZE 256
 
 typedef unsigned int ComponentID;
 class Component;
 
+/// Generational reference to a component instance inside a ComponentSet. Resolves to nullptr once the instance is removed.
+struct ComponentHandle
+{
+	/// Index of no slot, held by empty handles.
+	static constexpr unsigned int InvalidIndex = ~0u;
+
+	unsigned int index = InvalidIndex;
+	unsigned int generation = 0;
+
+	bool operator==(const ComponentHandle& other) const { return index == other.index && generation == other.generation; }
+	bool operator!=(const ComponentHandle& other) const { return !(*this == other); }
+};
+
+/// Live component instances of a type, kept in pages that never move. Iterating walks the pages in address order and
+/// skips freed slots, indexing goes through a dense list of the instances.
+template <class T>
+class ComponentArray
+{
+	struct Page
+	{
+		alignas(T) unsigned char storage[sizeof(T) * COMPONENT_PAGE_SIZE];
+	};
+
+	Vector<Ptr<Page>> m_Pages;
+	/// One per slot, set while an instance lives in the slot.
+	Vector<unsigned char> m_IsLive;
+	Vector<T*> m_Data;
+
+	T* getSlotAddress(unsigned int slot) const
+	{
+		return reinterpret_cast<T*>(m_Pages[slot / COMPONENT_PAGE_SIZE]->storage) + slot % COMPONENT_PAGE_SIZE;
+	}
+
+	template <class ComponentType>
+	friend class ComponentSet;
+
+public:
+	class Iterator
+	{
+		const ComponentArray* m_Array;
+		unsigned int m_Slot;
+
+		void skipFreed()
+		{
+			while (m_Slot < m_Array->m_IsLive.size() && !m_Array->m_IsLive[m_Slot])
+			{
+				++m_Slot;
+			}
+		}
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = T*;
+		using reference = T&;
+
+		Iterator(const ComponentArray* array, unsigned int slot)
+		    : m_Array(array)
+		    , m_Slot(slot)
+		{
+			skipFreed();
+		}
+
+		T& operator*() const { return *m_Array->getSlotAddress(m_Slot); }
+		T* operator->() const { return m_Array->getSlotAddress(m_Slot); }
+		Iterator& operator++()
+		{
+			++m_Slot;
+			skipFreed();
+			return *this;
+		}
+		Iterator operator++(int)
+		{
+			Iterator old = *this;
+			++*this;
+			return old;
+		}
+		bool operator==(const Iterator& other) const { return m_Slot == other.m_Slot; }
+		bool operator!=(const Iterator& other) const { return m_Slot != other.m_Slot; }
+	};
+
+	Iterator begin() const { return Iterator(this, 0); }
+	Iterator end() const { return Iterator(this, m_IsLive.size()); }
+
+	size_t size() const { return m_Data.size(); }
+	bool empty() const { return m_Data.empty(); }
+	T& front() const { return *m_Data.front(); }
+	T& operator[](size_t index) const { return *m_Data[index]; }
+	/// Contiguous array of instance pointers, valid until the next add or remove.
+	T* const* data() const { return m_Data.data(); }
+};
+
+/// Fields of a component as read from a cooked scene, for component types constructed from a typed record instead of
+/// JSON.
+class ComponentRecord
+{
+public:
+	virtual ~ComponentRecord() = default;
+};
+
+template <class Record>
+class TypedComponentRecord : public ComponentRecord
+{
+public:
+	Record record;
+
+	TypedComponentRecord(Record&& record)
+	    : record(std::move(record))
+	{
+	}
+};
+
+/// Component types declaring a Record, a constructor taking it and MakeRecord() to read it from JSON are cooked as
+/// records. Records that are not trivially copyable are cooked through WriteRecord() and ReadRecord().
+template <class T, class = void>
+struct HasComponentRecord : std::false_type
+{
+};
+
+template <class T>
+struct HasComponentRecord<T, std::void_t<typename T::Record>> : std::is_constructible<T, Entity&, const typename T::Record&>
+{
+};
+
 class BaseComponentSet
 {
+protected:
+	/// Incremented whenever an instance is added or removed.
+	unsigned int m_Version = 0;
+	bool m_IsMainThreadOnly = true;
+
 public:
-	virtual bool addComponent(Entity& owner, const JSON::json& componentData, bool checks = true) = 0;
+	virtual ~BaseComponentSet() = default;
+
+	unsigned int getVersion() const { return m_Version; }
+	/// Instances are constructed only on the main thread unless their constructors are safe to run on worker threads.
+	bool isMainThreadOnly() const { return m_IsMainThreadOnly; }
+	void setMainThreadOnly(bool isMainThreadOnly) { m_IsMainThreadOnly = isMainThreadOnly; }
+
+	bool addComponent(Entity& owner, const JSON::json& componentData, bool checks = true) { return addComponent(owner, componentData, nullptr, checks); }
+	/// Constructs from record instead of componentData if given.
+	virtual bool addComponent(Entity& owner, const JSON::json& componentData, const ComponentRecord* record, bool checks) = 0;
 	virtual bool addDefaultComponent(Entity& owner, bool checks) = 0;
 	virtual bool removeComponent(Entity& entity) = 0;
+
+	/// Reserve storage for an instance to be constructed later through constructAt().
+	virtual void* reserve(unsigned int& slot) = 0;
+	/// Construct an instance at reserved storage, from record instead of componentData if given. Leaves the set
+	/// untouched, so instances can be constructed on several threads at once while the set is used.
+	virtual Component* constructAt(void* storage, unsigned int slot, Entity& owner, const JSON::json& componentData, const ComponentRecord* record) = 0;
+	/// Add an instance constructed at reserved storage to the set and register it on its owner.
+	virtual void commit(Component* instance) = 0;
+	/// Add an instance constructed at reserved storage to the set, for an instance already registered on its owner.
+	virtual void insert(Component* instance) = 0;
+	/// Give back reserved storage, destroying the instance constructed at it if there is one.
+	virtual void discard(unsigned int slot, Component* instance) = 0;
+
+	/// True if instances are cooked as typed records, see HasComponentRecord.
+	virtual bool hasRecords() const = 0;
+	/// Write the record of an instance read from componentData, or record if given.
+	virtual void cookRecord(const JSON::json& componentData, const ComponentRecord* record, CookedWriter& writer) const = 0;
+	/// Returns nullptr if reader runs out before a whole record is read.
+	virtual Ref<ComponentRecord> loadRecord(CookedReader& reader) const = 0;
+
 	virtual const String& getName() const = 0;
 	virtual const String& getCategory() const = 0;
 	virtual const ComponentID& getID() const = 0;
 };
 
+/// Paged storage for all instances of a component type. Instances never move once constructed, removal swaps the last
+/// live instance into the freed dense position and slots are recycled with a bumped generation.
 template <class T>
 class ComponentSet : public BaseComponentSet
 {
-	Vector<T> m_Instances;
+	struct Slot
+	{
+		unsigned int generation = 0;
+		unsigned int denseIndex = ComponentHandle::InvalidIndex;
+	};
 
-public:
-	ComponentSet()
+	Vector<Slot> m_Slots;
+	Vector<unsigned int> m_FreeSlots;
+	Vector<unsigned int> m_DenseSlots;
+	ComponentArray<T> m_Instances;
+
+	T* getSlotAddress(unsigned int slot) const { return m_Instances.getSlotAddress(slot); }
+
+	template <class Record>
+	static void WriteRecord(CookedWriter& writer, const Record& record)
+	{
+		if constexpr (std::is_trivially_copyable<Record>::value)
+		{
+			writer.write(record);
+		}
+		else
+		{
+			T::WriteRecord(writer, record);
+		}
+	}
+
+	template <class Record>
+	static Record ReadRecord(CookedReader& reader)
+	{
+		if constexpr (std::is_trivially_copyable<Record>::value)
+		{
+			return reader.read<Record>();
+		}
+		else
+		{
+			return T::ReadRecord(reader);
+		}
+	}
+
+	unsigned int allocateSlot()
 	{
-		m_Instances.reserve(MAX_COMPONENT_ARRAY_SIZE); // To disallow resize if max size is detected later
+		if (!m_FreeSlots.empty())
+		{
+			unsigned int slot = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+			return slot;
+		}
+
+		unsigned int slot = m_Slots.size();
+		if (slot % COMPONENT_PAGE_SIZE == 0)
+		{
+			m_Instances.m_Pages.push_back(std::make_unique<typename ComponentArray<T>::Page>());
+		}
+		m_Slots.emplace_back();
+		m_Instances.m_IsLive.push_back(false);
+		return slot;
+	}
+
+	void releaseSlot(unsigned int slot)
+	{
+		Slot& freed = m_Slots[slot];
+		unsigned int denseIndex = freed.denseIndex;
+		unsigned int lastIndex = m_Instances.m_Data.size() - 1;
+
+		if (denseIndex != lastIndex)
+		{
+			m_Instances.m_Data[denseIndex] = m_Instances.m_Data[lastIndex];
+			m_DenseSlots[denseIndex] = m_DenseSlots[lastIndex];
+			m_Slots[m_DenseSlots[denseIndex]].denseIndex = denseIndex;
+		}
+		m_Instances.m_Data.pop_back();
+		m_DenseSlots.pop_back();
+
+		freed.generation++;
+		freed.denseIndex = ComponentHandle::InvalidIndex;
+		m_Instances.m_IsLive[slot] = false;
+		m_FreeSlots.push_back(slot);
 	}
+
+public:
+	ComponentSet() = default;
 	ComponentSet(const ComponentSet&) = delete;
 	ComponentSet& operator=(const ComponentSet&) = delete;
+	~ComponentSet()
+	{
+		for (T* instance : m_Instances.m_Data)
+		{
+			instance->~T();
+		}
+	}
 
-	Vector<T>& getAll() { return m_Instances; }
+	ComponentArray<T>& getAll() { return m_Instances; }
 
-	bool addComponent(Entity& owner, const JSON::json& componentData, bool checks) override
+	/// Returns an empty handle for nullptr.
+	ComponentHandle getHandle(const T* instance) const
 	{
-		if (m_Instances.size() == MAX_COMPONENT_ARRAY_SIZE)
+		if (!instance)
 		{
-			ERR("Component set for " + T::s_Name + " is full. Reduce component count or increase max size");
+			return {};
 		}
+		unsigned int slot = instance->m_SetSlot;
+		return { slot, m_Slots[slot].generation };
+	}
 
-		if (!owner.hasComponent(T::s_ID))
+	/// Returns nullptr if the handle is empty or refers to a removed instance.
+	T* get(const ComponentHandle& handle) const
+	{
+		if (handle.index >= m_Slots.size() || m_Slots[handle.index].generation != handle.generation || m_Slots[handle.index].denseIndex == ComponentHandle::InvalidIndex)
 		{
-			m_Instances.emplace_back(owner, componentData);
-			T& instance = m_Instances.back();
+			return nullptr;
+		}
+		return getSlotAddress(handle.index);
+	}
 
-			owner.registerComponent(&instance);
+	void* reserve(unsigned int& slot) override
+	{
+		slot = allocateSlot();
+		return getSlotAddress(slot);
+	}
+
+	Component* constructAt(void* storage, unsigned int slot, Entity& owner, const JSON::json& componentData, const ComponentRecord* record) override
+	{
+		T* instance = nullptr;
+		if constexpr (HasComponentRecord<T>::value)
+		{
+			if (record)
+			{
+				instance = new (storage) T(owner, static_cast<const TypedComponentRecord<typename T::Record>*>(record)->record);
+			}
+		}
+		if (!instance)
+		{
+			instance = new (storage) T(owner, componentData);
+		}
+		instance->m_SetSlot = slot;
+		return instance;
+	}
+
+	void commit(Component* component) override
+	{
+		insert(component);
+		static_cast<T*>(component)->getOwner().registerComponent(component);
+	}
+
+	void insert(Component* component) override
+	{
+		T* instance = static_cast<T*>(component);
+		const unsigned int slot = instance->m_SetSlot;
+		m_Slots[slot].denseIndex = m_Instances.m_Data.size();
+		m_Instances.m_Data.push_back(instance);
+		m_Instances.m_IsLive[slot] = true;
+		m_DenseSlots.push_back(slot);
+		m_Version++;
+	}
+
+	void discard(unsigned int slot, Component* instance) override
+	{
+		if (instance)
+		{
+			static_cast<T*>(instance)->~T();
+		}
+		m_Slots[slot].generation++;
+		m_FreeSlots.push_back(slot);
+	}
+
+	bool hasRecords() const override { return HasComponentRecord<T>::value; }
+
+	void cookRecord(const JSON::json& componentData, const ComponentRecord* record, CookedWriter& writer) const override
+	{
+		if constexpr (HasComponentRecord<T>::value)
+		{
+			typedef typename T::Record Record;
+			WriteRecord<Record>(writer, record ? static_cast<const TypedComponentRecord<Record>*>(record)->record : T::MakeRecord(componentData));
+		}
+	}
+
+	Ref<ComponentRecord> loadRecord(CookedReader& reader) const override
+	{
+		if constexpr (HasComponentRecord<T>::value)
+		{
+			typedef typename T::Record Record;
+			Record record = ReadRecord<Record>(reader);
+			if (reader.isValid())
+			{
+				return std::make_shared<TypedComponentRecord<Record>>(std::move(record));
+			}
+		}
+		return nullptr;
+	}
+
+	using BaseComponentSet::addComponent;
+	bool addComponent(Entity& owner, const JSON::json& componentData, const ComponentRecord* record, bool checks) override
+	{
+		if (!owner.hasComponent(T::s_ID))
+		{
+			unsigned int slot;
+			void* storage = reserve(slot);
+			commit(constructAt(storage, slot, owner, componentData, record));
 
 			if (checks && !owner.onAllComponentsAdded())
 			{
@@ -73,17 +410,18 @@ public:
 
 	bool removeComponent(Entity& entity) override
 	{
-		auto& findIt = std::find_if(m_Instances.begin(), m_Instances.end(), [&entity](T& c) {
-			return c.getOwner().getID() == entity.getID();
-		});
-
-		if (findIt != m_Instances.end())
+		T* instance = entity.getComponent<T>();
+		if (!instance)
 		{
-			findIt->onRemove();
-			m_Instances.erase(findIt);
-			return true;
+			return false;
 		}
-		return false;
+
+		unsigned int slot = instance->m_SetSlot;
+		instance->onRemove();
+		instance->~T();
+		releaseSlot(slot);
+		m_Version++;
+		return true;
 	}
 
 	const String& getName() const override { return T::s_Name; };
@@ -91,21 +429,159 @@ public:
 	const ComponentID& getID() const override { return T::s_ID; };
 };
 
+/// A component of an entity as read from a scene file.
+struct ComponentData
+{
+	String name;
+	/// Null for components read as typed records.
+	JSON::json data;
+	Ref<ComponentRecord> record;
+};
+
+/// Script and component data of an entity as read from a scene file, with components in the order they are added.
+struct EntityData
+{
+	/// Empty entities are left as they are instead of being filled.
+	bool isEmpty = true;
+	JSON::json script = JSON::json::object();
+	Vector<ComponentData> components;
+};
+
 namespace ECSFactory
 {
 extern HashMap<String, Ptr<BaseComponentSet>> s_ComponentSets;
+/// Component sets indexed by ComponentID, owned by s_ComponentSets.
+extern Array<BaseComponentSet*, MAX_COMPONENT_TYPES> s_ComponentSetsByID;
 
 void Initialize();
 
 void FillEntity(Entity& entity, const JSON::json& entityJSON);
+void FillEntity(Entity& entity, const EntityData& entityData);
 void FillEntityFromFile(Entity& entity, TextResourceFile* textResourceFile);
 void FillRootEntity(Entity& root);
 
 void CopyEntity(Entity& entity, Entity& copyTarget);
-String GetComponentNameByID(ComponentID componentID);
+const String& GetComponentNameByID(ComponentID componentID);
 ComponentID GetComponentIDByName(const String& componentName);
 
+/// Reference to instance which can be kept across frames, resolving to nullptr once the instance is removed.
+template <class ComponentType>
+ComponentHandle GetHandle(const ComponentType* instance)
+{
+	return ((ComponentSet<ComponentType>*)s_ComponentSetsByID[ComponentType::s_ID])->getHandle(instance);
+}
+
+/// Returns nullptr if the handle is empty or its instance has been removed.
+template <class ComponentType>
+ComponentType* Resolve(const ComponentHandle& handle)
+{
+	return ((ComponentSet<ComponentType>*)s_ComponentSetsByID[ComponentType::s_ID])->get(handle);
+}
+
 bool AddComponent(Entity& entity, ComponentID componentID, const JSON::json& componentData, bool checks = true);
 bool AddDefaultComponent(Entity& entity, ComponentID componentID, bool checks = true);
 bool RemoveComponent(Entity& entity, ComponentID componentID);
+
+/// Query over all entities that own every one of the requested component types. The list of matches is cached per
+/// type combination and rebuilt only after an instance of one of those types has been added or removed.
+/// Matches are refreshed on the calling thread, so query views from the main thread.
+template <class... ComponentTypes>
+class View
+{
+public:
+	typedef Tuple<ComponentTypes*...> Match;
+
+private:
+	static constexpr size_t TypeCount = sizeof...(ComponentTypes);
+
+	struct Cache
+	{
+		Vector<Match> matches;
+		Array<unsigned int, TypeCount> versions = {};
+		bool isBuilt = false;
+	};
+	static inline Cache s_Cache;
+
+	static ComponentSignature GetSignature()
+	{
+		ComponentSignature signature;
+		(signature.set(ComponentTypes::s_ID), ...);
+		return signature;
+	}
+
+	static Array<unsigned int, TypeCount> GetVersions()
+	{
+		return { s_ComponentSetsByID[ComponentTypes::s_ID]->getVersion()... };
+	}
+
+	template <class DriverType>
+	static void Collect(const ComponentSignature& signature)
+	{
+		for (auto& component : ((ComponentSet<DriverType>*)s_ComponentSetsByID[DriverType::s_ID])->getAll())
+		{
+			Entity& owner = component.getOwner();
+			if ((owner.getSignature() & signature) == signature)
+			{
+				s_Cache.matches.emplace_back(owner.getComponent<ComponentTypes>()...);
+			}
+		}
+	}
+
+	/// Walk only the smallest of the requested sets and test the rest through entity signatures.
+	static void Rebuild()
+	{
+		static const ComponentSignature signature = GetSignature();
+		const Array<size_t, TypeCount> sizes = { ((ComponentSet<ComponentTypes>*)s_ComponentSetsByID[ComponentTypes::s_ID])->getAll().size()... };
+		const size_t driver = std::min_element(sizes.begin(), sizes.end()) - sizes.begin();
+
+		s_Cache.matches.clear();
+		size_t index = 0;
+		((index++ == driver ? Collect<ComponentTypes>(signature) : void()), ...);
+
+		s_Cache.versions = GetVersions();
+		s_Cache.isBuilt = true;
+	}
+
+	template <class F, size_t... Indices>
+	static void Invoke(F& function, const Match& match, std::index_sequence<Indices...>)
+	{
+		function(*std::get<Indices>(match)...);
+	}
+
+public:
+	const Vector<Match>& getMatches()
+	{
+		if (!s_Cache.isBuilt || s_Cache.versions != GetVersions())
+		{
+			Rebuild();
+		}
+		return s_Cache.matches;
+	}
+
+	size_t size() { return getMatches().size(); }
+
+	/// Call function(ComponentTypes&...) for every matching entity.
+	template <class F>
+	void forEach(F&& function)
+	{
+		for (const Match& match : getMatches())
+		{
+			Invoke(function, match, std::index_sequence_for<ComponentTypes...>());
+		}
+	}
+
+	/// Call function(ComponentTypes&...) for every matching entity, splitting the matches into chunks of grainSize
+	/// processed concurrently on pool. Components must not be added or removed from inside function.
+	template <class F>
+	void forEachParallel(ThreadPool& pool, F&& function, size_t grainSize = 64)
+	{
+		const Vector<Match>& matches = getMatches();
+		pool.parallelFor(0, matches.size(), grainSize, [&matches, &function](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+			{
+				Invoke(function, matches[i], std::index_sequence_for<ComponentTypes...>());
+			}
+		});
+	}
+};
 };
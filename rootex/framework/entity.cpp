@@ -11,6 +11,7 @@
 Entity::Entity(Scene* scene)
     : m_Scene(scene)
 {
+	m_ComponentSlots.fill(nullptr);
 }
 
 Entity::~Entity()
@@ -25,7 +26,7 @@ JSON::json Entity::getJSON() const
 {
 	JSON::json j;
 	j["components"] = {};
-	for (auto&& [componentID, component] : m_Components)
+	for (auto& component : m_Components)
 	{
 		j["components"][component->getName()] = component->getJSON();
 	}
@@ -46,18 +47,44 @@ bool Entity::onAllComponentsAdded()
 	bool status = true;
 	for (auto& component : m_Components)
 	{
-		status = status && component.second->setup();
+		status = status && component->setup();
 	}
 	return status;
 }
 
+Vector<Component*> Entity::getComponentsInDependencyOrder() const
+{
+	Vector<Component*> ordered;
+	ComponentSignature visited;
+	Function<void(Component*)> visit = [&](Component* component) {
+		visited.set(component->getComponentID());
+		for (auto& dependency : component->getDependencies())
+		{
+			Component* dependedOn = dependency->getID() < MAX_COMPONENT_TYPES ? m_ComponentSlots[dependency->getID()] : nullptr;
+			if (dependedOn && !visited.test(dependency->getID()))
+			{
+				visit(dependedOn);
+			}
+		}
+		ordered.push_back(component);
+	};
+	for (auto& component : m_Components)
+	{
+		if (!visited.test(component->getComponentID()))
+		{
+			visit(component);
+		}
+	}
+	return ordered;
+}
+
 bool Entity::onAllEntitiesAdded()
 {
 	bool status = true;
 
-	for (auto& component : m_Components)
+	for (auto& component : getComponentsInDependencyOrder())
 	{
-		status = status && component.second->setupEntities();
+		status = status && component->setupEntities();
 	}
 
 	if (m_Script)
@@ -74,22 +101,20 @@ bool Entity::onAllEntitiesAdded()
 
 void Entity::clear()
 {
-	for (auto& [id, component] : m_Components)
+	for (auto& component : m_Components)
 	{
-		ECSFactory::RemoveComponent(*this, id);
+		ECSFactory::RemoveComponent(*this, component->getComponentID());
 	}
 	m_Components.clear();
+	m_ComponentSlots.fill(nullptr);
+	m_Signature.reset();
 }
 
 void Entity::destroy()
 {
 	call("destroy", { this });
 
-	for (auto& [componentID, component] : m_Components)
-	{
-		ECSFactory::RemoveComponent(*this, componentID);
-	}
-	m_Components.clear();
+	clear();
 }
 
 bool Entity::addDefaultComponent(const String& componentName)
@@ -104,15 +129,22 @@ bool Entity::addComponent(const String& componentName, const JSON::json& compone
 
 void Entity::registerComponent(Component* component)
 {
-	m_Components[component->getComponentID()] = component;
+	ComponentID componentID = component->getComponentID();
+	m_ComponentSlots[componentID] = component;
+	m_Components.push_back(component);
+	m_Signature.set(componentID);
 }
 
 bool Entity::removeComponent(ComponentID toRemoveComponentID, bool hardRemove)
 {
 	Component* toRemoveComponent = getComponentFromID(toRemoveComponentID);
+	if (!toRemoveComponent)
+	{
+		return false;
+	}
 	if (!hardRemove)
 	{
-		for (auto& [componentID, component] : m_Components)
+		for (auto& component : m_Components)
 		{
 			for (auto& dependency : component->getDependencies())
 			{
@@ -126,17 +158,14 @@ bool Entity::removeComponent(ComponentID toRemoveComponentID, bool hardRemove)
 	}
 
 	ECSFactory::RemoveComponent(*this, toRemoveComponentID);
-	m_Components.erase(toRemoveComponentID);
+	m_Components.erase(std::find(m_Components.begin(), m_Components.end(), toRemoveComponent));
+	m_ComponentSlots[toRemoveComponentID] = nullptr;
+	m_Signature.reset(toRemoveComponentID);
 
 	return true;
 }
 
-bool Entity::hasComponent(ComponentID componentID)
-{
-	return m_Components.find(componentID) != m_Components.end();
-}
-
-const HashMap<ComponentID, Component*>& Entity::getAllComponents() const
+const Vector<Component*>& Entity::getAllComponents() const
 {
 	return m_Components;
 }
@@ -3,6 +3,7 @@
 #include "common/common.h"
 #include "script/interpreter.h"
 #include "event_manager.h"
+#include "components/component_ids.h"
 
 class Component;
 class Scene;
@@ -11,6 +12,11 @@ class Script;
 typedef unsigned int ComponentID;
 typedef unsigned int SceneID;
 
+/// Maximum number of component types an entity can hold, one slot per ComponentIDs entry.
+#define MAX_COMPONENT_TYPES ((size_t)ComponentIDs::Count)
+/// One bit per component type, set when the entity has a component of that type.
+typedef Bitset<MAX_COMPONENT_TYPES> ComponentSignature;
+
 /// A collection of ECS style components that define an ECS style entity.
 class Entity
 {
@@ -18,7 +24,11 @@ class Entity
 
 protected:
 	Scene* m_Scene;
-	HashMap<ComponentID, Component*> m_Components;
+	/// Components indexed by their ComponentID, nullptr for absent component types.
+	Array<Component*, MAX_COMPONENT_TYPES> m_ComponentSlots;
+	/// Components in the order they were added.
+	Vector<Component*> m_Components;
+	ComponentSignature m_Signature;
 	Ref<Script> m_Script;
 
 public:
@@ -35,7 +45,8 @@ public:
 	bool addDefaultComponent(const String& componentName);
 	bool addComponent(const String& componentName, const JSON::json& componentData);
 	bool removeComponent(ComponentID toRemoveComponentID, bool hardRemove = false);
-	bool hasComponent(ComponentID componentID);
+	bool hasComponent(ComponentID componentID) const { return componentID < MAX_COMPONENT_TYPES && m_Signature.test(componentID); }
+	const ComponentSignature& getSignature() const { return m_Signature; }
 
 	/// Remove all components
 	void clear();
@@ -55,7 +66,9 @@ public:
 	const String& getName() const;
 	const SceneID getID() const;
 	const String& getFullName() const;
-	const HashMap<ComponentID, Component*>& getAllComponents() const;
+	const Vector<Component*>& getAllComponents() const;
+	/// Components ordered after the components they depend on, otherwise in the order they were added.
+	Vector<Component*> getComponentsInDependencyOrder() const;
 
 	void bind(const Event::Type& event, const sol::function& function);
 	bool call(const String& function, const Vector<Variant>& args);
@@ -76,12 +89,9 @@ inline ComponentType* Entity::getComponent()
 template <class ComponentType>
 inline ComponentType* Entity::getComponentFromID(ComponentID ID)
 {
-	auto findIt = m_Components.find(ID);
-	if (findIt != m_Components.end())
+	if (ID >= MAX_COMPONENT_TYPES)
 	{
-		Component* baseTypeComponent = findIt->second;
-		return dynamic_cast<ComponentType*>(baseTypeComponent);
+		return nullptr;
 	}
-
-	return nullptr;
+	return static_cast<ComponentType*>(m_ComponentSlots[ID]);
 }
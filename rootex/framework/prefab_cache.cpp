@@ -0,0 +1,255 @@
+#include "prefab_cache.h"
+
+#include "app/application.h"
+#include "resource_loader.h"
+#include "scene_cooker.h"
+#include "systems/script_system.h"
+#include "components/space/transform_component.h"
+
+/// Fill the entities of a pooled copy from the template it was spawned from, scene by scene.
+static void Refill(Scene& scene, const SceneData& sceneData)
+{
+	ECSFactory::FillEntity(scene.getEntity(), sceneData.entity);
+	for (int i = 0; i < sceneData.children.size(); i++)
+	{
+		Scene& child = *scene.getChildren()[i];
+		Refill(child, sceneData.children[i]);
+		// Children stay attached in the pool, so they enter the scene tree along with their parent
+		ScriptSystem::GetSingleton()->addEnterScriptEntity(&child.getEntity());
+	}
+}
+
+/// Remove the components and scripts of a copy going back to its pool.
+static void Empty(Scene& scene)
+{
+	Entity& entity = scene.getEntity();
+	entity.destroy();
+	entity.setScript("");
+	ScriptSystem::GetSingleton()->removeInitScriptEntity(&entity);
+	ScriptSystem::GetSingleton()->removeEnterScriptEntity(&entity);
+	for (auto& child : scene.getChildren())
+	{
+		Empty(*child);
+	}
+}
+
+/// If scene still has the scenes its template creates, so it can be filled from the template again.
+static bool HasShape(Scene& scene, const SceneData& sceneData)
+{
+	if (scene.getChildren().size() != sceneData.children.size())
+	{
+		return false;
+	}
+	for (int i = 0; i < sceneData.children.size(); i++)
+	{
+		if (!HasShape(*scene.getChildren()[i], sceneData.children[i]))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+PrefabCache* PrefabCache::GetSingleton()
+{
+	static PrefabCache singleton;
+	return &singleton;
+}
+
+PrefabCache::Prefab* PrefabCache::getPrefab(const String& sceneFile)
+{
+	auto&& found = m_Prefabs.find(sceneFile);
+	if (found != m_Prefabs.end() && found->second.file->getLastReadTime() == found->second.readTime)
+	{
+		return &found->second;
+	}
+
+	Ref<TextResourceFile> file = ResourceLoader::CreateTextResourceFile(sceneFile);
+	if (!file)
+	{
+		return nullptr;
+	}
+	// Pooled copies of an older template are dropped with it
+	Prefab prefab;
+	prefab.file = file;
+	prefab.readTime = file->getLastReadTime();
+	{
+		ResourceLoader::DependencyScope dependencies(*file);
+		if (!SceneCooker::Read(sceneFile, *file, prefab.sceneData))
+		{
+			WARN("Could not read prefab: " + sceneFile);
+			return nullptr;
+		}
+	}
+	prefab.sceneData.importStyle = Scene::ImportStyle::External;
+	prefab.sceneData.sceneFile = sceneFile;
+
+	Prefab& stored = m_Prefabs[sceneFile];
+	stored = std::move(prefab);
+	return &stored;
+}
+
+Vector<Scene*> PrefabCache::spawnMany(const String& sceneFile, Scene* parent, int count, const Vector<Matrix>& transforms)
+{
+	Vector<Scene*> spawned;
+	if (!parent)
+	{
+		WARN("Tried to spawn " + sceneFile + " without a parent scene. Denied.");
+		return spawned;
+	}
+	Prefab* prefab = getPrefab(sceneFile);
+	if (!prefab)
+	{
+		return spawned;
+	}
+	ZoneScoped;
+
+	ResourceLoader::DependencyScope dependencies(*prefab->file);
+
+	// Copies not taken from the pool are all staged first so their components are constructed together
+	const int pooled = std::min(count, (int)prefab->pool.size());
+	Vector<Ptr<SceneBuilder>> builders;
+	for (int i = pooled; i < count; i++)
+	{
+		builders.emplace_back(new SceneBuilder(prefab->sceneData, true));
+		builders.back()->stage(&Application::GetSingleton()->getThreadPool());
+	}
+
+	spawned.reserve(count);
+	for (int i = 0; i < count; i++)
+	{
+		Ptr<Scene> copy;
+		if (i < pooled)
+		{
+			copy = std::move(prefab->pool.back());
+			prefab->pool.pop_back();
+			Refill(*copy, prefab->sceneData);
+		}
+		else
+		{
+			SceneBuilder& builder = *builders[i - pooled];
+			while (builder.createNext())
+			{
+			}
+			copy = std::move(builder.getRoot());
+		}
+
+		if (i < transforms.size())
+		{
+			if (TransformComponent* transform = copy->getEntity().getComponent<TransformComponent>())
+			{
+				transform->setLocalTransform(transforms[i]);
+			}
+		}
+
+		Scene* added = copy.get();
+		if (!parent->addChild(copy))
+		{
+			continue;
+		}
+		added->onLoad();
+		m_Spawned[added->getID()] = sceneFile;
+		spawned.push_back(added);
+	}
+	return spawned;
+}
+
+void PrefabCache::despawn(Scene* scene)
+{
+	if (!scene)
+	{
+		return;
+	}
+	if (m_Despawning.empty())
+	{
+		EventManager::GetSingleton()->defer([this]() { despawnPending(); });
+	}
+	m_Despawning.push_back(scene->getID());
+}
+
+void PrefabCache::despawnPending()
+{
+	if (m_Despawning.empty())
+	{
+		return;
+	}
+	ZoneScoped;
+
+	// Found in one pass over all scenes, since copies may have been deleted since they were passed in
+	HashMap<SceneID, Scene*> despawning;
+	for (auto& id : m_Despawning)
+	{
+		despawning[id] = nullptr;
+	}
+	m_Despawning.clear();
+	for (auto& scene : Scene::FindAllScenes())
+	{
+		auto&& found = despawning.find(scene->getID());
+		if (found != despawning.end() && scene->getParent())
+		{
+			found->second = scene;
+		}
+	}
+
+	// Copies inside other copies being despawned leave along with them
+	for (auto& [id, scene] : despawning)
+	{
+		for (Scene* ancestor = scene ? scene->getParent() : nullptr; ancestor; ancestor = ancestor->getParent())
+		{
+			auto&& found = despawning.find(ancestor->getID());
+			if (found != despawning.end() && found->second == ancestor)
+			{
+				m_Spawned.erase(id);
+				scene = nullptr;
+				break;
+			}
+		}
+	}
+
+	for (auto& [id, scene] : despawning)
+	{
+		if (!scene)
+		{
+			continue;
+		}
+		Prefab* prefab = nullptr;
+		auto&& spawned = m_Spawned.find(id);
+		if (spawned != m_Spawned.end())
+		{
+			auto&& found = m_Prefabs.find(spawned->second);
+			prefab = found != m_Prefabs.end() ? &found->second : nullptr;
+			m_Spawned.erase(spawned);
+		}
+
+		Scene* parent = scene->getParent();
+		if (!prefab || !HasShape(*scene, prefab->sceneData))
+		{
+			parent->removeChild(scene);
+			continue;
+		}
+		Empty(*scene);
+		prefab->pool.push_back(parent->detachChild(scene));
+	}
+}
+
+void PrefabCache::clearPools()
+{
+	m_Spawned.clear();
+	m_Despawning.clear();
+	for (auto& [sceneFile, prefab] : m_Prefabs)
+	{
+		prefab.pool.clear();
+	}
+}
+
+void PrefabCache::clear()
+{
+	clearPools();
+	m_Prefabs.clear();
+}
+
+int PrefabCache::getPooledCount(const String& sceneFile) const
+{
+	auto&& found = m_Prefabs.find(sceneFile);
+	return found != m_Prefabs.end() ? found->second.pool.size() : 0;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "common/common.h"
+#include "scene_reader.h"
+
+class TextResourceFile;
+
+/// Spawns copies of scene files from templates read once and kept in memory, instead of reading the scene file again
+/// for every copy. Despawned copies go back to a pool per scene file with their scenes kept and their components
+/// removed, and are filled from the template again when the scene file is spawned next. Every copy still constructs
+/// all of its components, hot component types from typed records of the cooked scene and the rest from JSON.
+class PrefabCache
+{
+	struct Prefab
+	{
+		Ref<TextResourceFile> file;
+		FileTimePoint readTime;
+		SceneData sceneData;
+		/// Despawned copies, out of the scene tree and emptied of components.
+		Vector<Ptr<Scene>> pool;
+	};
+
+	HashMap<String, Prefab> m_Prefabs;
+	/// Scene file each spawned copy in the scene tree was spawned from, by scene ID.
+	HashMap<SceneID, String> m_Spawned;
+	/// Copies to despawn at the end of the frame.
+	Vector<SceneID> m_Despawning;
+
+	PrefabCache() = default;
+	PrefabCache(PrefabCache&) = delete;
+	~PrefabCache() = default;
+
+	/// Template of sceneFile, read again if the file has changed. Returns nullptr if it could not be read.
+	Prefab* getPrefab(const String& sceneFile);
+
+public:
+	static PrefabCache* GetSingleton();
+
+	/// Add count copies of the scene in sceneFile as children of parent. Copy i is placed at transforms[i] if there is
+	/// one, else where the scene file places it. Returns the copies added.
+	Vector<Scene*> spawnMany(const String& sceneFile, Scene* parent, int count, const Vector<Matrix>& transforms = {});
+	/// Take a copy spawned through spawnMany out of the scene tree at the end of the frame and keep it for the next spawn
+	/// of its scene file. Other scenes are deleted.
+	void despawn(Scene* scene);
+	/// Despawn the copies passed to despawn() so far. Only call when no scene tree is being walked.
+	void despawnPending();
+
+	/// Forget spawned copies and delete pooled ones. Called when scene IDs start over.
+	void clearPools();
+	/// Drop templates along with the pools.
+	void clear();
+
+	int getPooledCount(const String& sceneFile) const;
+};
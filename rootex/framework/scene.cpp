@@ -1,12 +1,18 @@
 #include "scene.h"
 
+#include "app/application.h"
 #include "ecs_factory.h"
 #include "resource_loader.h"
 #include "scene_loader.h"
+#include "scene_cooker.h"
 #include "systems/script_system.h"
 
+/// Components constructed by one task when a scene is created on several threads.
+#define SCENE_CONSTRUCTION_GRAIN 64
+
 static SceneID NextSceneID = ROOT_SCENE_ID + 1;
 Vector<Scene*> Scene::s_Scenes;
+unsigned int Scene::s_HierarchyVersion = 0;
 
 void to_json(JSON::json& j, const SceneSettings& s)
 {
@@ -43,32 +49,28 @@ void from_json(const JSON::json& j, Scene::ImportStyle& s)
 	s = (Scene::ImportStyle)(int)j;
 }
 
-void Scene::ResetNextID()
+void Scene::SetNextID(SceneID nextID)
 {
-	NextSceneID = ROOT_SCENE_ID + 1;
+	NextSceneID = nextID;
 }
 
-Ptr<Scene> Scene::Create(const JSON::json& sceneData, const bool assignNewIDs)
+static SceneID DecideSceneID(bool hasID, SceneID id, bool assignNewIDs, SceneID& nextID)
 {
-	// Decide ID
-	SceneID thisSceneID;
-	if (sceneData.contains("ID"))
+	if (hasID)
 	{
-		NextSceneID = std::max(NextSceneID, (SceneID)sceneData["ID"]);
+		nextID = std::max(nextID, id);
 		if (!assignNewIDs)
 		{
-			thisSceneID = sceneData["ID"];
-		}
-		else
-		{
-			thisSceneID = NextSceneID;
+			nextID++;
+			return id;
 		}
 	}
-	else
-	{
-		thisSceneID = NextSceneID;
-	}
-	NextSceneID++;
+	return nextID++;
+}
+
+Ptr<Scene> Scene::Create(const JSON::json& sceneData, const bool assignNewIDs)
+{
+	const SceneID thisSceneID = DecideSceneID(sceneData.contains("ID"), sceneData.value("ID", (SceneID)0), assignNewIDs, NextSceneID);
 
 	// Decide how to import
 	if (sceneData.contains("importStyle") && sceneData["importStyle"] != ImportStyle::Local && sceneData.value("sceneFile", "") == "")
@@ -101,17 +103,234 @@ Ptr<Scene> Scene::Create(const JSON::json& sceneData, const bool assignNewIDs)
 	return thisScene;
 }
 
+Ptr<Scene> Scene::Create(const SceneData& sceneData, const bool assignNewIDs)
+{
+	SceneBuilder builder(sceneData, assignNewIDs);
+	builder.stage(&Application::GetSingleton()->getThreadPool());
+	while (builder.createNext())
+	{
+	}
+	return std::move(builder.getRoot());
+}
+
+SceneBuilder::SceneBuilder(const SceneData& sceneData, bool assignNewIDs, bool deferCommit)
+    : m_SceneData(sceneData)
+    , m_AssignNewIDs(assignNewIDs)
+    , m_DeferCommit(deferCommit)
+{
+}
+
+SceneBuilder::~SceneBuilder()
+{
+	if (m_Constructing)
+	{
+		m_Pool->wait(m_Constructing);
+	}
+	// Created scenes still held here are deleted like any other, which needs their components in the sets
+	if (m_Root)
+	{
+		commit();
+	}
+	// Storage of scenes never created goes back to the sets before the scenes are destroyed
+	for (size_t i = m_CreatedCount; i < m_Scenes.size(); i++)
+	{
+		for (unsigned int c = m_Scenes[i].firstComponent; c < m_Scenes[i].lastComponent; c++)
+		{
+			m_Components[c].set->discard(m_Components[c].slot, m_Components[c].instance);
+		}
+	}
+}
+
+void SceneBuilder::stageScene(const SceneData& sceneData, int parent)
+{
+	const SceneID thisSceneID = DecideSceneID(sceneData.hasID, sceneData.id, m_AssignNewIDs, m_HasOwnIDs ? m_NextID : NextSceneID);
+	if (sceneData.importStyle != Scene::ImportStyle::Local && sceneData.sceneFile.empty())
+	{
+		ERR("Found empty scene file path for an externally imported scene");
+	}
+
+	StagedScene staged;
+	staged.data = &sceneData;
+	staged.parent = parent;
+	staged.owned = std::make_unique<Scene>(
+	    thisSceneID,
+	    sceneData.name,
+	    sceneData.settings,
+	    sceneData.importStyle,
+	    sceneData.sceneFile);
+	staged.scene = staged.owned.get();
+	staged.firstComponent = m_Components.size();
+
+	if (!sceneData.entity.isEmpty)
+	{
+		ComponentSignature staging;
+		for (auto& componentData : sceneData.entity.components)
+		{
+			auto&& found = ECSFactory::s_ComponentSets.find(componentData.name);
+			if (found == ECSFactory::s_ComponentSets.end() || staging.test(found->second->getID()))
+			{
+				PRINT("Could not add " + componentData.name + " to " + staged.scene->getEntity().getName());
+				continue;
+			}
+			staging.set(found->second->getID());
+
+			StagedComponent component;
+			component.set = found->second.get();
+			component.storage = component.set->reserve(component.slot);
+			component.data = &componentData;
+			component.instance = nullptr;
+			m_Components.push_back(component);
+		}
+	}
+	staged.lastComponent = m_Components.size();
+
+	const int index = m_Scenes.size();
+	m_Scenes.push_back(std::move(staged));
+	for (auto& child : sceneData.children)
+	{
+		stageScene(child, index);
+	}
+}
+
+void SceneBuilder::construct(size_t first, size_t last, const Optional<ResourceKey>& loadingFile)
+{
+	// Files loaded by components are recorded as dependencies of the file the scene is loaded from
+	Optional<ResourceLoader::DependencyScope> dependencies;
+	if (loadingFile)
+	{
+		dependencies.emplace(*loadingFile);
+	}
+
+	for (size_t i = first; i < last; i++)
+	{
+		Entity& entity = m_Scenes[i].scene->getEntity();
+		for (unsigned int c = m_Scenes[i].firstComponent; c < m_Scenes[i].lastComponent; c++)
+		{
+			StagedComponent& component = m_Components[c];
+			if (!component.set->isMainThreadOnly())
+			{
+				component.instance = component.set->constructAt(component.storage, component.slot, entity, component.data->data, component.data->record.get());
+			}
+		}
+	}
+}
+
+void SceneBuilder::stage(ThreadPool* pool)
+{
+	if (m_IsStaged)
+	{
+		return;
+	}
+	ZoneScoped;
+
+	// Scenes are allocated here on one thread so scene IDs come out the same as when creating serially
+	stageScene(m_SceneData, -1);
+	m_IsStaged = true;
+
+	const Optional<ResourceKey> loadingFile = ResourceLoader::GetLoadingFile();
+	if (!pool || m_Components.size() <= SCENE_CONSTRUCTION_GRAIN)
+	{
+		construct(0, m_Scenes.size(), loadingFile);
+		return;
+	}
+
+	// Runs of consecutive scenes, cut only between scenes so every entity is constructed on a single thread
+	Vector<Ref<Task>> tasks;
+	size_t first = 0;
+	for (size_t i = 0; i < m_Scenes.size(); i++)
+	{
+		const bool isLast = i + 1 == m_Scenes.size();
+		if (isLast || m_Scenes[i + 1].firstComponent - m_Scenes[first].firstComponent >= SCENE_CONSTRUCTION_GRAIN)
+		{
+			const size_t last = i + 1;
+			tasks.push_back(std::make_shared<Task>([this, first, last, loadingFile]() { construct(first, last, loadingFile); }));
+			first = last;
+		}
+	}
+	m_Pool = pool;
+	m_Constructing = pool->submit(tasks);
+}
+
+bool SceneBuilder::createNext()
+{
+	stage(nullptr);
+	if (m_CreatedCount == m_Scenes.size())
+	{
+		return false;
+	}
+	if (m_Constructing)
+	{
+		m_Pool->wait(m_Constructing);
+	}
+
+	StagedScene& staged = m_Scenes[m_CreatedCount];
+	Entity& entity = staged.scene->getEntity();
+	if (!staged.data->entity.isEmpty)
+	{
+		entity.setScriptJSON(staged.data->entity.script);
+
+		for (unsigned int c = staged.firstComponent; c < staged.lastComponent; c++)
+		{
+			StagedComponent& component = m_Components[c];
+			if (!component.instance)
+			{
+				component.instance = component.set->constructAt(component.storage, component.slot, entity, component.data->data, component.data->record.get());
+			}
+			entity.registerComponent(component.instance);
+		}
+	}
+	m_CreatedCount++;
+	if (!m_DeferCommit)
+	{
+		commit();
+	}
+
+	if (staged.parent == -1)
+	{
+		m_Root = std::move(staged.owned);
+	}
+	else if (!m_Scenes[staged.parent].scene->addChild(staged.owned))
+	{
+		WARN("Could not add child scene to " + m_Scenes[staged.parent].scene->getName() + " scene");
+	}
+	return true;
+}
+
+void SceneBuilder::commit()
+{
+	for (; m_CommittedCount < m_CreatedCount; m_CommittedCount++)
+	{
+		const StagedScene& staged = m_Scenes[m_CommittedCount];
+		if (staged.data->entity.isEmpty)
+		{
+			continue;
+		}
+
+		Entity& entity = staged.scene->getEntity();
+		for (unsigned int c = staged.firstComponent; c < staged.lastComponent; c++)
+		{
+			m_Components[c].set->insert(m_Components[c].instance);
+		}
+		if (!entity.onAllComponentsAdded())
+		{
+			ERR("Entity was not setup properly: " + std::to_string(entity.getID()));
+		}
+		PRINT("Filled entity: " + entity.getFullName());
+	}
+}
+
 Ptr<Scene> Scene::CreateFromFile(const String& sceneFile)
 {
 	if (Ref<TextResourceFile> t = ResourceLoader::CreateTextResourceFile(sceneFile))
 	{
-		if (t->isDirty())
+		ResourceLoader::DependencyScope dependencies(*t);
+		SceneData importedScene;
+		if (!SceneCooker::Read(sceneFile, *t, importedScene))
 		{
-			t->reimport();
+			return nullptr;
 		}
-		JSON::json importedScene = JSON::json::parse(t->getString());
-		importedScene["importStyle"] = ImportStyle::External;
-		importedScene["sceneFile"] = sceneFile;
+		importedScene.importStyle = ImportStyle::External;
+		importedScene.sceneFile = sceneFile;
 		return Create(importedScene, true);
 	}
 	return nullptr;
@@ -124,7 +343,7 @@ Ptr<Scene> Scene::CreateEmpty()
 
 Ptr<Scene> Scene::CreateEmptyAtPath(const String& sceneFile)
 {
-	return Create({ { "entity", {} }, { "sceneFile", sceneFile } }, false);
+	return Create(JSON::json { { "entity", {} }, { "sceneFile", sceneFile } }, false);
 }
 
 Ptr<Scene> Scene::CreateRootScene()
@@ -200,22 +419,21 @@ void Scene::reimport()
 	Ref<TextResourceFile> t = ResourceLoader::CreateTextResourceFile(m_SceneFile);
 	t->reimport();
 
-	const JSON::json& sceneData = JSON::json::parse(t->getString());
-	m_Entity.clear();
-	if (sceneData.contains("entity"))
+	SceneData sceneData;
+	if (!SceneCooker::Read(m_SceneFile, *t, sceneData))
 	{
-		ECSFactory::FillEntity(m_Entity, sceneData["entity"]);
+		return;
 	}
+	m_Entity.clear();
+	ECSFactory::FillEntity(m_Entity, sceneData.entity);
 
 	m_ChildrenScenes.clear();
-	if (sceneData.contains("children"))
+	s_HierarchyVersion++;
+	for (auto& childScene : sceneData.children)
 	{
-		for (auto& childScene : sceneData["children"])
+		if (!addChild(Create(childScene, false)))
 		{
-			if (!addChild(Create(childScene, false)))
-			{
-				WARN("Could not add child scene to " + getName() + " scene");
-			}
+			WARN("Could not add child scene to " + getName() + " scene");
 		}
 	}
 }
@@ -246,6 +464,7 @@ bool Scene::snatchChild(Scene* child)
 		}
 	}
 	child->m_ParentScene = this;
+	s_HierarchyVersion++;
 	return true;
 }
 
@@ -275,6 +494,7 @@ bool Scene::addChild(Ptr<Scene>& child)
 	{
 		child->m_ParentScene = this;
 		m_ChildrenScenes.emplace_back(std::move(child));
+		s_HierarchyVersion++;
 		ScriptSystem::GetSingleton()->addEnterScriptEntity(&m_ChildrenScenes.back()->getEntity());
 	}
 	else
@@ -292,12 +512,29 @@ bool Scene::removeChild(Scene* toRemove)
 		if ((*child).get() == toRemove)
 		{
 			m_ChildrenScenes.erase(child);
+			s_HierarchyVersion++;
 			return true;
 		}
 	}
 	return false;
 }
 
+Ptr<Scene> Scene::detachChild(Scene* child)
+{
+	for (auto& found = m_ChildrenScenes.begin(); found != m_ChildrenScenes.end(); found++)
+	{
+		if ((*found).get() == child)
+		{
+			Ptr<Scene> detached = std::move(*found);
+			m_ChildrenScenes.erase(found);
+			detached->m_ParentScene = nullptr;
+			s_HierarchyVersion++;
+			return detached;
+		}
+	}
+	return nullptr;
+}
+
 void Scene::setName(const String& name)
 {
 	m_Name = name;
@@ -348,6 +585,7 @@ Scene::~Scene()
 	}
 	s_Scenes.erase(s_Scenes.begin() + index);
 	m_ChildrenScenes.clear();
+	s_HierarchyVersion++;
 	PRINT("Deleted scene: " + getFullName());
 }
 
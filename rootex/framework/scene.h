@@ -3,8 +3,13 @@
 #include "common/common.h"
 #include "entity.h"
 #include "core/input/input_manager.h"
+#include "core/resource_dependency_graph.h"
+#include "os/thread.h"
 
 class Entity;
+class BaseComponentSet;
+struct ComponentData;
+struct SceneData;
 
 #define ROOT_SCENE_ID 1
 
@@ -37,6 +42,8 @@ public:
 
 private:
 	static Vector<Scene*> s_Scenes;
+	/// Bumped whenever a scene is added to, removed from or moved within a scene tree.
+	static unsigned int s_HierarchyVersion;
 
 	SceneID m_ID;
 	String m_Name;
@@ -53,9 +60,12 @@ private:
 	bool checkCycle(Scene* child);
 
 public:
-	static void ResetNextID();
+	/// Hand out scene IDs from nextID on.
+	static void SetNextID(SceneID nextID);
 
+	/// Create from a JSON tree, used by the editor to copy scenes. Files are read through SceneReader instead.
 	static Ptr<Scene> Create(const JSON::json& sceneData, const bool assignNewIDs);
+	static Ptr<Scene> Create(const SceneData& sceneData, const bool assignNewIDs);
 	static Ptr<Scene> CreateFromFile(const String& sceneFile);
 	static Ptr<Scene> CreateEmpty();
 	static Ptr<Scene> CreateEmptyAtPath(const String& sceneFile);
@@ -64,6 +74,7 @@ public:
 	static Vector<Scene*> FindScenesByName(const String& name);
 	static Scene* FindSceneByID(const SceneID& id);
 	static const Vector<Scene*>& FindAllScenes();
+	static unsigned int GetHierarchyVersion() { return s_HierarchyVersion; }
 
 	Scene(SceneID id, const String& name, const SceneSettings& settings, ImportStyle importStyle, const String& sceneFile);
 	~Scene();
@@ -75,6 +86,8 @@ public:
 	bool snatchChild(Scene* child);
 	bool addChild(Ptr<Scene>& child);
 	bool removeChild(Scene* toRemove);
+	/// Take child out of the children of this scene without destroying it. Returns nullptr if it is not a child.
+	Ptr<Scene> detachChild(Scene* child);
 
 	void setName(const String& name);
 
@@ -89,3 +102,84 @@ public:
 	const String& getFullName() const { return m_FullName; }
 	SceneSettings& getSettings() { return m_Settings; }
 };
+
+/// Creates the scenes of a SceneData tree in phases, so a large tree can be created over several frames and the
+/// components of independent subtrees can be constructed on several threads at once.
+/// Scenes and component storage are allocated first, then components are constructed, then scenes are set up and added
+/// to their parent one at a time, depth first.
+class SceneBuilder
+{
+	/// A component with storage reserved in its set, constructed before its scene is committed.
+	struct StagedComponent
+	{
+		BaseComponentSet* set;
+		unsigned int slot;
+		void* storage;
+		const ComponentData* data;
+		Component* instance;
+	};
+
+	/// A scene created but not yet set up and added to its parent.
+	struct StagedScene
+	{
+		const SceneData* data;
+		/// Index of the parent in m_Scenes, -1 for the scene of the whole tree.
+		int parent;
+		/// Owns the scene until it is committed.
+		Ptr<Scene> owned;
+		Scene* scene;
+		/// Components of the scene, a range of m_Components.
+		unsigned int firstComponent;
+		unsigned int lastComponent;
+	};
+
+	const SceneData& m_SceneData;
+	bool m_AssignNewIDs;
+	bool m_DeferCommit;
+	/// Scene IDs are counted here instead of by the shared counter when set.
+	bool m_HasOwnIDs = false;
+	SceneID m_NextID = ROOT_SCENE_ID + 1;
+	bool m_IsStaged = false;
+	Vector<StagedScene> m_Scenes;
+	Vector<StagedComponent> m_Components;
+	ThreadPool* m_Pool = nullptr;
+	Ref<TaskCounter> m_Constructing;
+	Ptr<Scene> m_Root;
+	int m_CreatedCount = 0;
+	int m_CommittedCount = 0;
+
+	void stageScene(const SceneData& sceneData, int parent);
+	/// Construct the components of scenes [first, last), leaving out components of main thread only sets.
+	void construct(size_t first, size_t last, const Optional<ResourceKey>& loadingFile);
+
+public:
+	/// sceneData should outlive the builder. If deferCommit is set, components of created scenes are kept out of their
+	/// sets and their entities are not set up until commit() is called.
+	SceneBuilder(const SceneData& sceneData, bool assignNewIDs, bool deferCommit = false);
+	SceneBuilder(SceneBuilder&) = delete;
+	~SceneBuilder();
+
+	/// Count scene IDs from the first one after the root, leaving the shared counter alone, for a scene that is to
+	/// replace the current one. Call before staging, and pass getNextID() to Scene::SetNextID() once the current scene
+	/// is gone.
+	void startIDsOver() { m_HasOwnIDs = true; }
+	SceneID getNextID() const { return m_NextID; }
+
+	/// Create every scene and reserve storage for every component on the calling thread, then construct components on
+	/// pool in runs of whole subtrees. Constructs on the calling thread if pool is nullptr.
+	void stage(ThreadPool* pool);
+	/// Returns true once staged components have been constructed and scenes can be committed without waiting.
+	bool isConstructed() const { return m_IsStaged && (!m_Constructing || m_Constructing->isDone()); }
+
+	/// Set up the next scene and add it to its parent, staging first if needed. Returns false if every scene has
+	/// already been created.
+	bool createNext();
+	/// Add the components of scenes created so far to their sets and set up their entities. Needed before the root is
+	/// destroyed, once it has been taken out of a builder deferring commits.
+	void commit();
+
+	bool isDone() const { return m_IsStaged && m_CreatedCount == m_Scenes.size(); }
+	int getCreatedCount() const { return m_CreatedCount; }
+	/// Scene of the whole tree, empty until the first scene is created.
+	Ptr<Scene>& getRoot() { return m_Root; }
+};
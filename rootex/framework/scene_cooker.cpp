@@ -0,0 +1,305 @@
+#include "scene_cooker.h"
+
+#include "core/cooked_cache.h"
+#include "core/resource_files/text_resource_file.h"
+
+#define SCENE_COOKED_MAGIC 0x4e435352 // "RSCN"
+/// Bump when the cooked layout, the way scene files are read or the Record of a component type changes.
+#define SCENE_COOKED_VERSION 3
+
+#define COOKED_SCENE_HAS_ID 1
+#define COOKED_SCENE_HAS_ENTITY 2
+
+/// Kinds of component blocks.
+#define COOKED_COMPONENTS_MSGPACK 0
+#define COOKED_COMPONENTS_RECORDS 1
+
+/// String table, data blob and records of a scene being cooked.
+struct SceneCookingTables
+{
+	String strings;
+	HashMap<String, CookedRange> stringRanges;
+	String data;
+	Vector<CookedSceneRecord> scenes;
+	/// Ordered by name, so components are added to entities in the order they are read from scene files.
+	Map<String, Vector<CookedComponentRecord>> components;
+
+	CookedRange addString(const String& value)
+	{
+		auto&& found = stringRanges.find(value);
+		if (found != stringRanges.end())
+		{
+			return found->second;
+		}
+		const CookedRange range = { (unsigned int)strings.size(), (unsigned int)value.size() };
+		strings += value;
+		stringRanges[value] = range;
+		return range;
+	}
+
+	CookedRange addData(const JSON::json& value)
+	{
+		const Vector<std::uint8_t>& encoded = JSON::json::to_msgpack(value);
+		const CookedRange range = { (unsigned int)data.size(), (unsigned int)encoded.size() };
+		data.append((const char*)encoded.data(), encoded.size());
+		return range;
+	}
+
+	CookedRange addComponent(const ComponentData& component)
+	{
+		auto&& found = ECSFactory::s_ComponentSets.find(component.name);
+		if (found == ECSFactory::s_ComponentSets.end() || !found->second->hasRecords())
+		{
+			return addData(component.data);
+		}
+		CookedWriter writer;
+		found->second->cookRecord(component.data, component.record.get(), writer);
+		const CookedRange range = { (unsigned int)data.size(), (unsigned int)writer.getBuffer().size() };
+		data.append((const char*)writer.getBuffer().data(), writer.getBuffer().size());
+		return range;
+	}
+
+	void addScene(const SceneData& scene, int parent)
+	{
+		const unsigned int index = scenes.size();
+		CookedSceneRecord record = {};
+		record.parent = parent;
+		record.id = scene.id;
+		record.flags = (scene.hasID ? COOKED_SCENE_HAS_ID : 0) | (scene.entity.isEmpty ? 0 : COOKED_SCENE_HAS_ENTITY);
+		record.importStyle = (int)scene.importStyle;
+		record.childCount = scene.children.size();
+		record.name = addString(scene.name);
+		record.sceneFile = addString(scene.sceneFile);
+		record.settings = addData(scene.settings);
+		record.script = addData(scene.entity.script);
+		scenes.push_back(record);
+
+		for (auto& component : scene.entity.components)
+		{
+			components[component.name].push_back({ index, addComponent(component) });
+		}
+		for (auto& child : scene.children)
+		{
+			addScene(child, index);
+		}
+	}
+};
+
+static bool IsInside(const CookedRange& range, size_t size)
+{
+	return (size_t)range.offset + range.size <= size;
+}
+
+static bool Decode(const char* data, const CookedRange& range, JSON::json& value)
+{
+	value = JSON::json::from_msgpack(data + range.offset, data + range.offset + range.size, true, false);
+	return !value.is_discarded();
+}
+
+static unsigned int GetBlockKind(const String& componentName)
+{
+	auto&& found = ECSFactory::s_ComponentSets.find(componentName);
+	return found != ECSFactory::s_ComponentSets.end() && found->second->hasRecords() ? COOKED_COMPONENTS_RECORDS : COOKED_COMPONENTS_MSGPACK;
+}
+
+bool SceneCooker::Cook(const String& sceneFile, const SceneData& sceneData, const Vector<String>& resourcePaths)
+{
+	SceneCookingTables tables;
+	tables.addScene(sceneData, -1);
+
+	// Every string goes in the table before it is written
+	Vector<CookedRange> resourceRanges;
+	for (auto& path : resourcePaths)
+	{
+		resourceRanges.push_back(tables.addString(path));
+	}
+	Vector<CookedRange> componentNames;
+	for (auto& [componentName, records] : tables.components)
+	{
+		componentNames.push_back(tables.addString(componentName));
+	}
+
+	CookedWriter writer;
+	writer.writeString(tables.strings);
+	writer.writeString(tables.data);
+	writer.writeArray(tables.scenes);
+	writer.writeArray(resourceRanges);
+	writer.write((unsigned int)tables.components.size());
+	int block = 0;
+	for (auto& [componentName, records] : tables.components)
+	{
+		writer.write(componentNames[block++]);
+		writer.write(GetBlockKind(componentName));
+		writer.writeArray(records);
+	}
+	return CookedCache::Save(sceneFile, SCENE_COOKED_EXTENSION, SCENE_COOKED_MAGIC, SCENE_COOKED_VERSION, 0, writer);
+}
+
+bool SceneCooker::Load(const String& sceneFile, SceneData& sceneData, Vector<String>* resourcePaths)
+{
+	Ref<MappedFile> cookedFile = CookedCache::Open(sceneFile, SCENE_COOKED_EXTENSION, SCENE_COOKED_MAGIC, SCENE_COOKED_VERSION, 0);
+	if (!cookedFile)
+	{
+		return false;
+	}
+
+	CookedReader reader = CookedCache::GetReader(*cookedFile);
+
+	struct ComponentBlock
+	{
+		CookedRange name;
+		unsigned int kind;
+		const CookedComponentRecord* records;
+		size_t recordCount;
+	};
+
+	size_t stringsSize = 0;
+	const char* strings = reader.readArray<char>(stringsSize);
+	size_t dataSize = 0;
+	const char* data = reader.readArray<char>(dataSize);
+	size_t sceneCount = 0;
+	const CookedSceneRecord* scenes = reader.readArray<CookedSceneRecord>(sceneCount);
+	size_t resourceCount = 0;
+	const CookedRange* resources = reader.readArray<CookedRange>(resourceCount);
+	const unsigned int blockCount = reader.read<unsigned int>();
+	Vector<ComponentBlock> blocks(std::min(blockCount, (unsigned int)MAX_COMPONENT_TYPES));
+	for (auto& block : blocks)
+	{
+		block.name = reader.read<CookedRange>();
+		block.kind = reader.read<unsigned int>();
+		block.records = reader.readArray<CookedComponentRecord>(block.recordCount);
+	}
+
+	// Check every record before building anything, so a damaged file falls back to reading the scene file
+	bool isValid = reader.isValid() && blockCount <= MAX_COMPONENT_TYPES && sceneCount > 0;
+	Vector<unsigned int> childCounts(sceneCount, 0);
+	for (size_t i = 0; isValid && i < sceneCount; i++)
+	{
+		const CookedSceneRecord& scene = scenes[i];
+		isValid = (i == 0 ? scene.parent == -1 : scene.parent >= 0 && scene.parent < (int)i)
+		    && IsInside(scene.name, stringsSize) && IsInside(scene.sceneFile, stringsSize)
+		    && IsInside(scene.settings, dataSize) && IsInside(scene.script, dataSize);
+		if (isValid && scene.parent >= 0)
+		{
+			childCounts[scene.parent]++;
+		}
+	}
+	for (size_t i = 0; isValid && i < sceneCount; i++)
+	{
+		isValid = childCounts[i] == scenes[i].childCount;
+	}
+	for (size_t i = 0; isValid && i < resourceCount; i++)
+	{
+		isValid = IsInside(resources[i], stringsSize);
+	}
+	for (auto& block : blocks)
+	{
+		isValid = isValid && IsInside(block.name, stringsSize) && (block.kind == COOKED_COMPONENTS_MSGPACK || block.kind == COOKED_COMPONENTS_RECORDS);
+		for (size_t i = 0; isValid && i < block.recordCount; i++)
+		{
+			isValid = block.records[i].scene < sceneCount && IsInside(block.records[i].data, dataSize);
+		}
+	}
+	if (!isValid)
+	{
+		WARN("Cooked scene is damaged, reading the scene file: " + sceneFile);
+		return false;
+	}
+
+	// Children lists are reserved up front, so scenes never move once added
+	SceneData root;
+	Vector<SceneData*> built(sceneCount, nullptr);
+	JSON::json settings;
+	for (size_t i = 0; i < sceneCount; i++)
+	{
+		const CookedSceneRecord& record = scenes[i];
+		SceneData* scene = &root;
+		if (record.parent >= 0)
+		{
+			built[record.parent]->children.emplace_back();
+			scene = &built[record.parent]->children.back();
+		}
+		built[i] = scene;
+
+		scene->children.reserve(record.childCount);
+		scene->hasID = record.flags & COOKED_SCENE_HAS_ID;
+		scene->id = record.id;
+		scene->name = String(strings + record.name.offset, record.name.size);
+		scene->importStyle = (Scene::ImportStyle)record.importStyle;
+		scene->sceneFile = String(strings + record.sceneFile.offset, record.sceneFile.size);
+		scene->entity.isEmpty = !(record.flags & COOKED_SCENE_HAS_ENTITY);
+		if (!Decode(data, record.settings, settings) || !Decode(data, record.script, scene->entity.script))
+		{
+			WARN("Cooked scene is damaged, reading the scene file: " + sceneFile);
+			return false;
+		}
+		scene->settings = settings.get<SceneSettings>();
+	}
+
+	for (auto& block : blocks)
+	{
+		const String componentName(strings + block.name.offset, block.name.size);
+		BaseComponentSet* set = nullptr;
+		if (block.kind == COOKED_COMPONENTS_RECORDS)
+		{
+			// Records are only readable by the component type that wrote them
+			auto&& found = ECSFactory::s_ComponentSets.find(componentName);
+			if (found == ECSFactory::s_ComponentSets.end() || !found->second->hasRecords())
+			{
+				WARN("Cooked scene holds records of an unknown component type, reading the scene file: " + sceneFile);
+				return false;
+			}
+			set = found->second.get();
+		}
+		for (size_t i = 0; i < block.recordCount; i++)
+		{
+			const CookedRange& range = block.records[i].data;
+			ComponentData component = { componentName };
+			if (set)
+			{
+				CookedReader recordReader(data + range.offset, range.size);
+				component.record = set->loadRecord(recordReader);
+			}
+			if (set ? !component.record : !Decode(data, range, component.data))
+			{
+				WARN("Cooked scene is damaged, reading the scene file: " + sceneFile);
+				return false;
+			}
+			built[block.records[i].scene]->entity.components.push_back(std::move(component));
+		}
+	}
+
+	if (resourcePaths)
+	{
+		for (size_t i = 0; i < resourceCount; i++)
+		{
+			resourcePaths->emplace_back(strings + resources[i].offset, resources[i].size);
+		}
+	}
+	sceneData = std::move(root);
+	return true;
+}
+
+bool SceneCooker::Read(const String& sceneFile, const TextResourceFile& file, SceneData& sceneData, Vector<String>* resourcePaths)
+{
+	if (Load(sceneFile, sceneData, resourcePaths))
+	{
+		return true;
+	}
+
+	Vector<String> foundPaths;
+	if (!SceneReader::Read(file.getString(), sceneData, &foundPaths))
+	{
+		return false;
+	}
+	// Scenes only found in paks are cooked when exported, since there is no scene file on disk to cook from here
+	if (OS::IsExists(sceneFile))
+	{
+		Cook(sceneFile, sceneData, foundPaths);
+	}
+	if (resourcePaths)
+	{
+		resourcePaths->insert(resourcePaths->end(), foundPaths.begin(), foundPaths.end());
+	}
+	return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "common/common.h"
+
+#include "scene_reader.h"
+
+#define SCENE_COOKED_EXTENSION ".rscene"
+
+class TextResourceFile;
+
+/// Range of bytes in the string table or the data blob of a cooked scene.
+struct CookedRange
+{
+	unsigned int offset;
+	unsigned int size;
+};
+
+/// A scene in the flat array of a cooked scene file. Scenes are stored depth first, so children follow their parent
+/// in order.
+struct CookedSceneRecord
+{
+	/// Index of the parent scene, -1 for the scene of the file.
+	int parent;
+	SceneID id;
+	unsigned int flags;
+	int importStyle;
+	unsigned int childCount;
+	/// Into the string table.
+	CookedRange name;
+	CookedRange sceneFile;
+	/// MessagePack encoded, into the data blob.
+	CookedRange settings;
+	CookedRange script;
+};
+
+/// A component in the block of its type, in the data blob. Components of types with typed records are stored as those
+/// records, the rest are MessagePack encoded.
+struct CookedComponentRecord
+{
+	unsigned int scene;
+	CookedRange data;
+};
+
+/// Cooks scene files into binary .rscene files in the cooked cache. A cooked scene holds a string table, the scenes
+/// in a flat array and the components grouped in one block per type, and is read in place from the mapped file.
+/// JSON scene files stay the source, a cooked scene reads back into the SceneData read from its scene file, with the
+/// components of hot types read as typed records instead of JSON.
+/// Cooked scenes are checked against the size and write time of their scene file like other cooked files, and are
+/// trusted as is when the scene file is only found in a pak.
+class SceneCooker
+{
+public:
+	SceneCooker() = delete;
+
+	/// Write the cooked file for sceneFile from sceneData, read from the scene file on disk.
+	static bool Cook(const String& sceneFile, const SceneData& sceneData, const Vector<String>& resourcePaths);
+	/// Read the cooked file for sceneFile. Returns false if there is none or if it is stale.
+	static bool Load(const String& sceneFile, SceneData& sceneData, Vector<String>* resourcePaths = nullptr);
+	/// Read a scene from its cooked file, or from the contents of file and then cook it if the cooked file is missing
+	/// or stale.
+	static bool Read(const String& sceneFile, const TextResourceFile& file, SceneData& sceneData, Vector<String>* resourcePaths = nullptr);
+};
@@ -1,8 +1,11 @@
 #include "scene_loader.h"
 
 #include "resource_loader.h"
+#include "app/application.h"
 #include "event_manager.h"
+#include "prefab_cache.h"
 #include "scene.h"
+#include "scene_cooker.h"
 #include "system.h"
 
 SceneLoader::SceneLoader()
@@ -17,23 +20,58 @@ SceneLoader* SceneLoader::GetSingleton()
 	return &singleton;
 }
 
-Vector<String> SceneLoader::findResourcePaths(const JSON::json& sceneJSON)
+Ref<SceneData> SceneLoader::readScene(const String& sceneFile, const TextResourceFile& file, Vector<String>* resourcePaths, bool keep)
 {
-	Vector<String> resources;
-	JSON::json flat = sceneJSON.flatten();
+	// Held while reading too, so a scene file is never cooked by two threads at once
+	std::lock_guard<Mutex> lock(m_ReadScenesMutex);
 
-	for (auto& [key, value] : flat.items())
+	const FileTimePoint& readTime = file.getLastReadTime();
+	auto&& found = m_ReadScenes.find(sceneFile);
+	if (found != m_ReadScenes.end() && found->second.first == readTime && !resourcePaths)
 	{
-		if (value.is_string())
+		Ref<SceneData> sceneData = found->second.second;
+		if (!keep)
 		{
-			String assetPath = (String)value;
-			if (assetPath.find("assets/") != String::npos)
-			{
-				resources.push_back(assetPath);
-			}
+			m_ReadScenes.erase(found);
 		}
+		return sceneData;
+	}
+
+	Ref<SceneData> sceneData = std::make_shared<SceneData>();
+	if (!SceneCooker::Read(sceneFile, file, *sceneData, resourcePaths))
+	{
+		m_ReadScenes.erase(sceneFile);
+		return nullptr;
+	}
+	if (keep)
+	{
+		m_ReadScenes[sceneFile] = { readTime, sceneData };
+	}
+	else if (found != m_ReadScenes.end() && found->second.first != readTime)
+	{
+		m_ReadScenes.erase(found);
+	}
+	return sceneData;
+}
+
+void SceneLoader::addPreloads(const String& sceneFile, const TextResourceFile& file, const SceneData& sceneData, const Vector<String>& resourcePaths)
+{
+	const ResourceCollection& preloads = sceneData.settings.preloads;
+	for (auto& [type, path] : preloads)
+	{
+		ResourceLoader::AddDependency(file, type, path);
+	}
+
+	int notPreloaded = 0;
+	for (auto& path : resourcePaths)
+	{
+		auto&& isPreloaded = std::find_if(preloads.begin(), preloads.end(), [&path](const Pair<ResourceFile::Type, String>& preload) { return preload.second == path; });
+		notPreloaded += isPreloaded == preloads.end() ? 1 : 0;
+	}
+	if (notPreloaded)
+	{
+		PRINT(std::to_string(notPreloaded) + " resource references in " + sceneFile + " are not preloaded and will be loaded while the scene is created");
 	}
-	return resources;
 }
 
 Variant SceneLoader::deleteScene(const Event* event)
@@ -52,58 +90,256 @@ Variant SceneLoader::deleteScene(const Event* event)
 
 int SceneLoader::preloadScene(const String& sceneFile, Atomic<int>& progress)
 {
-	const SceneSettings& sceneJSON = JSON::json::parse(ResourceLoader::CreateTextResourceFile(sceneFile)->getString()).value("settings", SceneSettings());
-	return ResourceLoader::Preload(sceneJSON.preloads, progress);
+	Ref<TextResourceFile> sceneResFile = ResourceLoader::CreateTextResourceFile(sceneFile);
+	Vector<String> resourcePaths;
+	Ref<SceneData> sceneData = readScene(sceneFile, *sceneResFile, &resourcePaths, true);
+	if (!sceneData)
+	{
+		return 0;
+	}
+	addPreloads(sceneFile, *sceneResFile, *sceneData, resourcePaths);
+	return ResourceLoader::Preload(sceneData->settings.preloads, progress);
 }
 
 void SceneLoader::loadPreloadedScene(const String& sceneFile, const Vector<String>& arguments)
 {
-	EventManager::GetSingleton()->defer([this, sceneFile, arguments]() {
-		endSystems();
-		m_RootScene->removeChild(m_CurrentScene);
-		Scene::ResetNextID();
+	Ref<SceneStream> stream = std::make_shared<SceneStream>();
+	stream->sceneFile = sceneFile;
+	stream->arguments = arguments;
+	stream->shouldPreload = false;
+	startStream(stream);
+}
+
+void SceneLoader::loadScene(const String& sceneFile, const Vector<String>& arguments)
+{
+	Ref<SceneStream> stream = std::make_shared<SceneStream>();
+	stream->sceneFile = sceneFile;
+	stream->arguments = arguments;
+	startStream(stream);
+}
+
+void SceneLoader::streamScene(const String& sceneFile, Scene* parent, const Function<void(Scene*)>& onStreamed)
+{
+	Ref<SceneStream> stream = std::make_shared<SceneStream>();
+	stream->sceneFile = sceneFile;
+	stream->parent = parent ? parent->getID() : ROOT_SCENE_ID;
+	stream->onStreamed = onStreamed;
+	startStream(stream);
+}
 
-		ResourceLoader::ClearDeadResources();
-		Ref<TextResourceFile> sceneResFile = ResourceLoader::CreateTextResourceFile(sceneFile);
-		if (sceneResFile->isDirty())
+void SceneLoader::startStream(const Ref<SceneStream>& stream)
+{
+	if (!stream->parent)
+	{
+		// Only the scene loaded last replaces the current scene
+		for (auto& other : m_Streams)
 		{
-			sceneResFile->reimport();
+			other->isCancelled = other->isCancelled || !other->parent;
 		}
-		Ptr<Scene>& scene = Scene::Create(JSON::json::parse(sceneResFile->getString()), false);
-		m_CurrentScene = scene.get();
-		m_RootScene->addChild(scene);
-		setArguments(arguments);
+	}
+	m_Streams.push_back(stream);
 
-		for (auto& systems : System::GetSystems())
+	stream->file = ResourceLoader::CreateTextResourceFile(stream->sceneFile);
+	if (!stream->file)
+	{
+		stream->stage = SceneStream::Stage::Failed;
+		return;
+	}
+
+	Ref<Task> reading = std::make_shared<Task>([this, stream]() {
+		// Scenes loaded after preloading reuse the scene read while preloading, unless the file changed since
+		Vector<String> resourcePaths;
+		stream->sceneData = readScene(stream->sceneFile, *stream->file, stream->shouldPreload ? &resourcePaths : nullptr, false);
+		if (!stream->sceneData)
 		{
-			for (auto& system : systems)
-			{
-				system->setConfig(m_CurrentScene->getSettings());
-			}
+			return;
+		}
+		if (stream->shouldPreload)
+		{
+			addPreloads(stream->sceneFile, *stream->file, *stream->sceneData, resourcePaths);
+		}
+		if (stream->parent)
+		{
+			stream->sceneData->importStyle = Scene::ImportStyle::External;
+			stream->sceneData->sceneFile = stream->sceneFile;
+		}
+	});
+	stream->reading = Application::GetSingleton()->getThreadPool().submit({ reading });
+}
+
+bool SceneLoader::updateStream(SceneStream& stream, const Timer& frameTimer)
+{
+	switch (stream.stage)
+	{
+	case SceneStream::Stage::Reading:
+		if (!stream.reading->isDone())
+		{
+			return false;
+		}
+		if (!stream.sceneData)
+		{
+			stream.stage = SceneStream::Stage::Failed;
+			return true;
+		}
+		if (stream.shouldPreload && !stream.isCancelled)
+		{
+			stream.totalProgress = ResourceLoader::Preload(stream.sceneData->settings.preloads, stream.progress);
+		}
+		stream.stage = SceneStream::Stage::Preloading;
+		[[fallthrough]];
+	case SceneStream::Stage::Preloading:
+		// Preloading tasks count progress in the stream, so it is kept until they are done even if cancelled
+		if (stream.progress.load() != stream.totalProgress)
+		{
+			return false;
+		}
+		if (stream.isCancelled)
+		{
+			return true;
+		}
+		// Streamed in scenes get new IDs like scenes added from files, a loaded scene keeps the IDs in its file. Systems
+		// would see components of scenes out of the tree with wrong transforms, so they are committed once it is attached.
+		stream.builder.reset(new SceneBuilder(*stream.sceneData, stream.parent != 0, true));
+		if (!stream.parent)
+		{
+			// The current scene keeps using the shared counter until it is replaced
+			stream.builder->startIDsOver();
+		}
+		stream.stage = SceneStream::Stage::Creating;
+		[[fallthrough]];
+	case SceneStream::Stage::Creating:
+	{
+		if (stream.isCancelled)
+		{
+			return true;
+		}
+		// Everything loaded while the scene is created is recorded as a dependency of the scene file. Components are
+		// constructed on the thread pool first, then at least one scene is set up each frame, so streams still finish
+		// when the budget is used up by others.
+		ResourceLoader::DependencyScope dependencies(*stream.file);
+		stream.builder->stage(&Application::GetSingleton()->getThreadPool());
+		if (!stream.builder->isConstructed())
+		{
+			return false;
 		}
-		m_CurrentScene->onLoad();
-		PRINT("Loaded scene: " + m_CurrentScene->getFullName());
+		do
+		{
+			stream.builder->createNext();
+		} while (!stream.builder->isDone() && frameTimer.getTimeMs() < m_StreamingBudgetMs);
+		return stream.builder->isDone();
+	}
+	case SceneStream::Stage::Failed:
+		return true;
+	}
+	return true;
+}
 
-		ResourceLoader::ClearPersistentResources();
+void SceneLoader::updateStreams()
+{
+	if (m_Streams.empty())
+	{
+		return;
+	}
+	ZoneScoped;
 
-		beginSystems();
-		EventManager::GetSingleton()->deferredCall(RootexEvents::OpenedScene);
-	});
+	const Timer frameTimer;
+	Vector<Ref<SceneStream>> finished;
+	for (auto& stream : m_Streams)
+	{
+		if (updateStream(*stream, frameTimer))
+		{
+			finished.push_back(stream);
+		}
+	}
+
+	// Finished after all streams are updated, since finishing a stream may start or cancel others
+	for (auto& stream : finished)
+	{
+		auto&& found = std::find(m_Streams.begin(), m_Streams.end(), stream);
+		if (found != m_Streams.end())
+		{
+			m_Streams.erase(found);
+			finishStream(*stream);
+		}
+	}
 }
 
-void SceneLoader::loadScene(const String& sceneFile, const Vector<String>& arguments)
+void SceneLoader::finishStream(SceneStream& stream)
 {
-	Atomic<int> progress;
-	int totalProgress = preloadScene(sceneFile, progress);
+	if (stream.isCancelled)
+	{
+		PRINT("Stopped loading scene: " + stream.sceneFile);
+		return;
+	}
 
-	PRINT("Waiting for " + std::to_string(totalProgress) + " resources to load...");
-	while (progress.load() != totalProgress)
+	Ptr<Scene> scene = stream.builder ? std::move(stream.builder->getRoot()) : nullptr;
+	if (!scene)
 	{
-		;
+		WARN("Could not load scene: " + stream.sceneFile);
+		if (stream.onStreamed)
+		{
+			stream.onStreamed(nullptr);
+		}
+		return;
+	}
+
+	if (!stream.parent)
+	{
+		openScene(scene, stream.arguments, *stream.builder);
+		return;
+	}
+
+	Scene* parent = m_RootScene->findScene(stream.parent);
+	if (!parent)
+	{
+		WARN("Scene to stream " + stream.sceneFile + " into was deleted while streaming");
+		stream.builder->commit();
+		if (stream.onStreamed)
+		{
+			stream.onStreamed(nullptr);
+		}
+		return;
+	}
+	Scene* streamed = scene.get();
+	parent->addChild(scene);
+	stream.builder->commit();
+	streamed->onLoad();
+	PRINT("Streamed in scene: " + streamed->getFullName() + " (" + std::to_string(stream.builder->getCreatedCount()) + " scenes)");
+
+	if (stream.onStreamed)
+	{
+		stream.onStreamed(streamed);
+	}
+	EventManager::GetSingleton()->call(RootexEvents::SceneStreamed, streamed);
+}
+
+void SceneLoader::openScene(Ptr<Scene>& scene, const Vector<String>& arguments, SceneBuilder& builder)
+{
+	endSystems();
+	m_RootScene->removeChild(m_CurrentScene);
+	// IDs start over with the scene file. Pooled copies would keep IDs the new scene hands out again.
+	PrefabCache::GetSingleton()->clearPools();
+	Scene::SetNextID(builder.getNextID());
+
+	m_CurrentScene = scene.get();
+	m_RootScene->addChild(scene);
+	builder.commit();
+	setArguments(arguments);
+
+	for (auto& systems : System::GetSystems())
+	{
+		for (auto& system : systems)
+		{
+			system->setConfig(m_CurrentScene->getSettings());
+		}
 	}
-	PRINT("Preloaded scene file (" + std::to_string(totalProgress) + " new resources)");
+	m_CurrentScene->onLoad();
+	PRINT("Loaded scene: " + m_CurrentScene->getFullName());
+
+	ResourceLoader::ClearPersistentResources();
 
-	loadPreloadedScene(sceneFile, arguments);
+	beginSystems();
+	EventManager::GetSingleton()->deferredCall(RootexEvents::OpenedScene);
 }
 
 bool SceneLoader::saveScene(Scene* scene)
@@ -123,6 +359,19 @@ bool SceneLoader::saveSceneAtFile(Scene* scene, const String& filePath)
 
 void SceneLoader::destroyAllScenes()
 {
+	// Worker threads may still be reading or preloading for streams
+	ThreadPool& pool = Application::GetSingleton()->getThreadPool();
+	for (auto& stream : m_Streams)
+	{
+		if (stream->reading)
+		{
+			pool.wait(stream->reading);
+		}
+		pool.waitUntil([&stream]() { return stream->progress.load() == stream->totalProgress; });
+	}
+	m_Streams.clear();
+	PrefabCache::GetSingleton()->clear();
+
 	m_CurrentScene = nullptr;
 	m_RootScene.reset();
 }
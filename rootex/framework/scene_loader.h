@@ -2,11 +2,51 @@
 
 #include "common/common.h"
 #include "event_manager.h"
+#include "os/timer.h"
 
 class Scene;
+class SceneBuilder;
+class TaskCounter;
+class TextResourceFile;
+struct SceneData;
+
+typedef unsigned int SceneID;
+
+/// Milliseconds of each frame spent creating scenes that are being streamed in.
+#define SCENE_STREAMING_BUDGET_MS 4.0f
 
 class SceneLoader
 {
+	/// A scene file streamed in over several frames. The file is read and its resources preloaded on worker threads,
+	/// then its scenes are created on the main thread a few at a time, within the streaming budget of each frame.
+	struct SceneStream
+	{
+		enum class Stage
+		{
+			Reading,
+			Preloading,
+			Creating,
+			Failed
+		};
+
+		String sceneFile;
+		Ref<TextResourceFile> file;
+		/// Scene the streamed scene is added under, 0 to replace the current scene.
+		SceneID parent = 0;
+		Vector<String> arguments;
+		Function<void(Scene*)> onStreamed;
+		bool shouldPreload = true;
+		/// Set when another scene is loaded to replace the current scene before this one is done.
+		bool isCancelled = false;
+
+		Stage stage = Stage::Reading;
+		Ref<TaskCounter> reading;
+		Ref<SceneData> sceneData;
+		Atomic<int> progress = 0;
+		int totalProgress = 0;
+		Ptr<SceneBuilder> builder;
+	};
+
 	EventBinder<SceneLoader> m_Binder;
 
 	Scene* m_CurrentScene = nullptr;
@@ -14,13 +54,34 @@ class SceneLoader
 
 	Vector<String> m_SceneArguments;
 
+	/// Scenes read while preloading, kept until they are loaded so their files are read once. Checked against the time
+	/// the file was last read in case it was reimported in between.
+	HashMap<String, Pair<FileTimePoint, Ref<SceneData>>> m_ReadScenes;
+	/// Scenes are read on worker threads while streaming.
+	Mutex m_ReadScenesMutex;
+
+	/// In the order they were started.
+	Vector<Ref<SceneStream>> m_Streams;
+	float m_StreamingBudgetMs = SCENE_STREAMING_BUDGET_MS;
+
 	SceneLoader();
 
 	void beginSystems();
 	void endSystems();
 
 	void setArguments(const Vector<String>& arguments) { m_SceneArguments = arguments; }
-	Vector<String> findResourcePaths(const JSON::json& sceneJSON);
+	/// Read the scene in sceneFile, or take the scene kept from reading it last unless resourcePaths are asked for. The
+	/// scene read is kept for the next read if keep is set. Returns nullptr if it could not be read.
+	Ref<SceneData> readScene(const String& sceneFile, const TextResourceFile& file, Vector<String>* resourcePaths, bool keep);
+	/// Record the preloads of a scene as dependencies of its file and report resources it uses without preloading.
+	void addPreloads(const String& sceneFile, const TextResourceFile& file, const SceneData& sceneData, const Vector<String>& resourcePaths);
+
+	void startStream(const Ref<SceneStream>& stream);
+	/// Advance stream as far as it can go this frame. Returns true once it has finished, successfully or not.
+	bool updateStream(SceneStream& stream, const Timer& frameTimer);
+	void finishStream(SceneStream& stream);
+	/// Swap the current scene for scene, committing the components builder created for it once it is in the tree.
+	void openScene(Ptr<Scene>& scene, const Vector<String>& arguments, SceneBuilder& builder);
 
 	Variant deleteScene(const Event* event);
 
@@ -28,8 +89,21 @@ public:
 	static SceneLoader* GetSingleton();
 
 	int preloadScene(const String& sceneFile, Atomic<int>& progress);
+	/// Replace the current scene with a scene already preloaded through preloadScene.
 	void loadPreloadedScene(const String& sceneFile, const Vector<String>& arguments);
+	/// Replace the current scene with the scene in sceneFile. The current scene keeps running while the new one is
+	/// streamed in. Replaces any other scene being loaded.
 	void loadScene(const String& sceneFile, const Vector<String>& arguments);
+	/// Stream in the scene in sceneFile as a child of parent, without changing the current scene. Calls onStreamed
+	/// with the added scene, or with nullptr if it could not be streamed in, and publishes RootexEvents::SceneStreamed.
+	void streamScene(const String& sceneFile, Scene* parent, const Function<void(Scene*)>& onStreamed = nullptr);
+	/// Continue streaming scenes in. Called once per frame.
+	void updateStreams();
+	bool isStreaming() const { return !m_Streams.empty(); }
+
+	void setStreamingBudget(float milliseconds) { m_StreamingBudgetMs = milliseconds; }
+	float getStreamingBudget() const { return m_StreamingBudgetMs; }
+
 	bool saveScene(Scene* scene);
 	bool saveSceneAtFile(Scene* scene, const String& filePath);
 	void destroyAllScenes();
@@ -0,0 +1,292 @@
+#include "scene_reader.h"
+
+void to_json(JSON::json& j, const SceneData& sceneData)
+{
+	if (sceneData.hasID)
+	{
+		j["ID"] = sceneData.id;
+	}
+	j["name"] = sceneData.name;
+	j["importStyle"] = (int)sceneData.importStyle;
+	j["sceneFile"] = sceneData.sceneFile;
+	if (!sceneData.entity.isEmpty)
+	{
+		JSON::json& entity = j["entity"];
+		entity["components"] = {};
+		for (auto& component : sceneData.entity.components)
+		{
+			entity["components"][component.name] = component.data;
+		}
+		entity["script"] = sceneData.entity.script;
+	}
+	j["settings"] = sceneData.settings;
+
+	j["children"] = JSON::json::array();
+	for (auto& child : sceneData.children)
+	{
+		j["children"].push_back(child);
+	}
+}
+
+SceneReader::SceneReader(SceneData& root, Vector<String>* resourcePaths)
+    : m_Root(root)
+    , m_ResourcePaths(resourcePaths)
+{
+}
+
+bool SceneReader::Read(const String& text, SceneData& root, Vector<String>* resourcePaths)
+{
+	SceneReader reader(root, resourcePaths);
+	if (!JSON::json::sax_parse(text, &reader))
+	{
+		WARN("Could not read scene: " + reader.m_Error);
+		return false;
+	}
+	return true;
+}
+
+void SceneReader::startCapture(JSON::json&& container, const Function<void(JSON::json&)>& onCaptured)
+{
+	m_Capture = std::move(container);
+	m_CaptureStack.push_back(&m_Capture);
+	m_OnCaptured = onCaptured;
+}
+
+JSON::json* SceneReader::capture(JSON::json&& value)
+{
+	// Only containers that are still open are referenced, and those never move while values are added to them
+	JSON::json* parent = m_CaptureStack.back();
+	if (parent->is_array())
+	{
+		parent->push_back(std::move(value));
+		return &parent->back();
+	}
+	JSON::json& element = (*parent)[m_Key];
+	element = std::move(value);
+	return &element;
+}
+
+void SceneReader::endContainer()
+{
+	if (isCapturing())
+	{
+		m_CaptureStack.pop_back();
+		if (!isCapturing())
+		{
+			m_OnCaptured(m_Capture);
+			m_OnCaptured = nullptr;
+		}
+		return;
+	}
+
+	Frame& frame = m_Frames.back();
+	if (frame.context == Context::Components)
+	{
+		// Components are added in the order a JSON object iterates them in
+		Vector<ComponentData>& components = frame.scene->entity.components;
+		std::sort(components.begin(), components.end(), [](const ComponentData& a, const ComponentData& b) { return a.name < b.name; });
+	}
+	m_Frames.pop_back();
+}
+
+Function<void(JSON::json&)> SceneReader::getCapture() const
+{
+	SceneData* scene = m_Frames.back().scene;
+	switch (m_Frames.back().context)
+	{
+	case Context::Scene:
+		if (m_Key == "settings")
+		{
+			return [scene](JSON::json& value) { scene->settings = value.get<SceneSettings>(); };
+		}
+		break;
+	case Context::Entity:
+		if (m_Key == "script")
+		{
+			return [scene](JSON::json& value) { scene->entity.script = std::move(value); };
+		}
+		break;
+	case Context::Components:
+		return [scene, name = m_Key](JSON::json& value) {
+			Vector<ComponentData>& components = scene->entity.components;
+			auto&& found = std::find_if(components.begin(), components.end(), [&name](const ComponentData& component) { return component.name == name; });
+			if (found != components.end())
+			{
+				// Later duplicates win, like they do when parsing into a JSON object
+				found->data = std::move(value);
+			}
+			else
+			{
+				components.push_back({ name, std::move(value) });
+			}
+		};
+	default:
+		break;
+	}
+	return nullptr;
+}
+
+bool SceneReader::scalar(JSON::json&& value)
+{
+	if (isCapturing())
+	{
+		capture(std::move(value));
+		return true;
+	}
+	if (m_Frames.empty())
+	{
+		return true;
+	}
+	if (Function<void(JSON::json&)> onCaptured = getCapture())
+	{
+		onCaptured(value);
+		return true;
+	}
+
+	const Frame& frame = m_Frames.back();
+	if (frame.context == Context::Scene)
+	{
+		SceneData& scene = *frame.scene;
+		if (m_Key == "ID")
+		{
+			scene.hasID = true;
+			scene.id = value;
+		}
+		else if (m_Key == "name")
+		{
+			scene.name = value;
+		}
+		else if (m_Key == "importStyle")
+		{
+			scene.importStyle = (Scene::ImportStyle)(int)value;
+		}
+		else if (m_Key == "sceneFile")
+		{
+			scene.sceneFile = value;
+		}
+	}
+	return true;
+}
+
+bool SceneReader::startContainer(JSON::json&& container)
+{
+	if (isCapturing())
+	{
+		m_CaptureStack.push_back(capture(std::move(container)));
+		return true;
+	}
+	if (m_Frames.empty())
+	{
+		m_Frames.push_back({ container.is_object() ? Context::Scene : Context::Skipped, &m_Root });
+		return true;
+	}
+
+	const Frame& frame = m_Frames.back();
+	if (frame.context == Context::Skipped)
+	{
+		m_Frames.push_back(frame);
+		return true;
+	}
+	if (Function<void(JSON::json&)> onCaptured = getCapture())
+	{
+		startCapture(std::move(container), onCaptured);
+		return true;
+	}
+
+	SceneData* scene = frame.scene;
+	if (frame.context == Context::Scene && m_Key == "entity" && container.is_object())
+	{
+		m_Frames.push_back({ Context::Entity, scene });
+	}
+	else if (frame.context == Context::Scene && m_Key == "children" && container.is_array())
+	{
+		m_Frames.push_back({ Context::Children, scene });
+	}
+	else if (frame.context == Context::Children && container.is_object())
+	{
+		// Earlier children are complete by now, so they may move when the list grows
+		scene->children.emplace_back();
+		m_Frames.push_back({ Context::Scene, &scene->children.back() });
+	}
+	else if (frame.context == Context::Entity && m_Key == "components" && container.is_object())
+	{
+		m_Frames.push_back({ Context::Components, scene });
+	}
+	else
+	{
+		m_Frames.push_back({ Context::Skipped, scene });
+	}
+	return true;
+}
+
+bool SceneReader::null()
+{
+	return scalar(nullptr);
+}
+
+bool SceneReader::boolean(bool value)
+{
+	return scalar(value);
+}
+
+bool SceneReader::number_integer(number_integer_t value)
+{
+	return scalar(value);
+}
+
+bool SceneReader::number_unsigned(number_unsigned_t value)
+{
+	return scalar(value);
+}
+
+bool SceneReader::number_float(number_float_t value, const string_t& text)
+{
+	return scalar(value);
+}
+
+bool SceneReader::string(string_t& value)
+{
+	if (m_ResourcePaths && value.find("assets/") != String::npos)
+	{
+		m_ResourcePaths->push_back(value);
+	}
+	return scalar(std::move(value));
+}
+
+bool SceneReader::start_object(std::size_t elements)
+{
+	return startContainer(JSON::json::object());
+}
+
+bool SceneReader::key(string_t& value)
+{
+	m_Key = std::move(value);
+	if (!isCapturing() && m_Frames.back().context == Context::Entity)
+	{
+		m_Frames.back().scene->entity.isEmpty = false;
+	}
+	return true;
+}
+
+bool SceneReader::end_object()
+{
+	endContainer();
+	return true;
+}
+
+bool SceneReader::start_array(std::size_t elements)
+{
+	return startContainer(JSON::json::array());
+}
+
+bool SceneReader::end_array()
+{
+	endContainer();
+	return true;
+}
+
+bool SceneReader::parse_error(std::size_t position, const std::string& lastToken, const JSON::detail::exception& exception)
+{
+	m_Error = exception.what();
+	return false;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "common/common.h"
+
+#include "ecs_factory.h"
+#include "scene.h"
+
+/// Contents of a scene and its children as read from a scene file, ready to be instantiated by Scene::Create.
+struct SceneData
+{
+	bool hasID = false;
+	SceneID id = 0;
+	String name = "Untitled";
+	Scene::ImportStyle importStyle = Scene::ImportStyle::Local;
+	String sceneFile;
+	SceneSettings settings;
+	EntityData entity;
+	Vector<SceneData> children;
+};
+
+/// Write sceneData the way Scene::getJSON writes scenes. Components read as typed records from cooked scenes are
+/// written as null.
+void to_json(JSON::json& j, const SceneData& sceneData);
+
+/// Reads scene files in one streaming pass without building a JSON tree of the whole file. Only the data of each
+/// component and script is kept as JSON, since that is what components are constructed from.
+class SceneReader : public JSON::json_sax<JSON::json>
+{
+	enum class Context
+	{
+		Scene,
+		Children,
+		Entity,
+		Components,
+		/// Value not used by scenes, skipped along with everything inside it.
+		Skipped
+	};
+
+	struct Frame
+	{
+		Context context;
+		SceneData* scene;
+	};
+
+	SceneData& m_Root;
+	Vector<String>* m_ResourcePaths;
+	Vector<Frame> m_Frames;
+	String m_Key;
+
+	/// JSON value being captured and the containers open inside it.
+	JSON::json m_Capture;
+	Vector<JSON::json*> m_CaptureStack;
+	/// Where the captured value goes once complete.
+	Function<void(JSON::json&)> m_OnCaptured;
+	String m_Error;
+
+	SceneReader(SceneData& root, Vector<String>* resourcePaths);
+
+	bool isCapturing() const { return !m_CaptureStack.empty(); }
+	/// Where a value at the current position goes if it is kept as JSON, empty if it is not.
+	Function<void(JSON::json&)> getCapture() const;
+	void startCapture(JSON::json&& container, const Function<void(JSON::json&)>& onCaptured);
+	/// Add a value to the captured container, returning it if it is a container itself.
+	JSON::json* capture(JSON::json&& value);
+	void endContainer();
+
+	bool scalar(JSON::json&& value);
+	bool startContainer(JSON::json&& container);
+
+public:
+	/// Parse text into root. Strings naming files under an assets directory are appended to resourcePaths if given.
+	/// Returns false and leaves root partially filled if the text is not valid JSON.
+	static bool Read(const String& text, SceneData& root, Vector<String>* resourcePaths = nullptr);
+
+	bool null() override;
+	bool boolean(bool value) override;
+	bool number_integer(number_integer_t value) override;
+	bool number_unsigned(number_unsigned_t value) override;
+	bool number_float(number_float_t value, const string_t& text) override;
+	bool string(string_t& value) override;
+	bool start_object(std::size_t elements) override;
+	bool key(string_t& value) override;
+	bool end_object() override;
+	bool start_array(std::size_t elements) override;
+	bool end_array() override;
+	bool parse_error(std::size_t position, const std::string& lastToken, const JSON::detail::exception& exception) override;
+};
@@ -2,6 +2,36 @@
 
 Vector<Vector<System*>> System::s_Systems;
 
+bool System::Access::conflictsWith(const Access& other) const
+{
+	if (!isDeclared || !other.isDeclared)
+	{
+		return true;
+	}
+
+	if ((writes & (other.reads | other.writes)).any() || (other.writes & reads).any())
+	{
+		return true;
+	}
+
+	for (auto& resource : writeResources)
+	{
+		if (std::find(other.readResources.begin(), other.readResources.end(), resource) != other.readResources.end()
+		    || std::find(other.writeResources.begin(), other.writeResources.end(), resource) != other.writeResources.end())
+		{
+			return true;
+		}
+	}
+	for (auto& resource : other.writeResources)
+	{
+		if (std::find(readResources.begin(), readResources.end(), resource) != readResources.end())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
 System::System(const String& name, const UpdateOrder& order, bool isGameplay)
     : m_SystemName(name)
     , m_UpdateOrder(order)
@@ -47,6 +77,24 @@ void System::end()
 {
 }
 
+void System::declareWriteAll()
+{
+	m_Access.writes.set();
+	m_Access.isDeclared = true;
+}
+
+void System::declareReadResource(const String& resource)
+{
+	m_Access.readResources.push_back(resource);
+	m_Access.isDeclared = true;
+}
+
+void System::declareWriteResource(const String& resource)
+{
+	m_Access.writeResources.push_back(resource);
+	m_Access.isDeclared = true;
+}
+
 void System::setActive(bool enabled)
 {
 	m_IsActive = enabled;
@@ -61,5 +109,15 @@ void System::draw()
 	ImGui::Text("%s", m_SystemName.c_str());
 	ImGui::NextColumn();
 
+	ImGui::Text("Update Time");
+	ImGui::NextColumn();
+	ImGui::Text("%.3f ms", m_LastUpdateTime);
+	ImGui::NextColumn();
+
+	ImGui::Text("Thread");
+	ImGui::NextColumn();
+	ImGui::Text("%s", m_IsMainThreadOnly ? "Main" : "Any");
+	ImGui::NextColumn();
+
 	ImGui::Columns(1);
 }
@@ -27,14 +27,50 @@ public:
 		End
 	};
 
+	/// Component types and shared resources touched during update(), used to find systems that can run concurrently.
+	struct Access
+	{
+		ComponentSignature reads;
+		ComponentSignature writes;
+		Vector<String> readResources;
+		Vector<String> writeResources;
+		/// Systems which have not declared their access conflict with every other system.
+		bool isDeclared = false;
+
+		bool conflictsWith(const Access& other) const;
+	};
+
 protected:
 	static Vector<Vector<System*>> s_Systems;
 
 	friend class Entity;
+	friend class SystemScheduler;
 
 	String m_SystemName;
 	UpdateOrder m_UpdateOrder;
 	bool m_IsActive;
+	Access m_Access;
+	bool m_IsMainThreadOnly = true;
+	float m_LastUpdateTime = 0.0f;
+
+	template <class ComponentType>
+	void declareRead()
+	{
+		m_Access.reads.set(ComponentType::s_ID);
+		m_Access.isDeclared = true;
+	}
+	template <class ComponentType>
+	void declareWrite()
+	{
+		m_Access.writes.set(ComponentType::s_ID);
+		m_Access.isDeclared = true;
+	}
+	/// For systems whose update can reach any component, such as those running scripts.
+	void declareWriteAll();
+	void declareReadResource(const String& resource);
+	void declareWriteResource(const String& resource);
+	/// Allow update() to be called from a worker thread.
+	void setMainThreadOnly(bool isMainThreadOnly) { m_IsMainThreadOnly = isMainThreadOnly; }
 
 public:
 	static const Vector<Vector<System*>>& GetSystems() { return s_Systems; }
@@ -53,6 +89,10 @@ public:
 	String getName() const { return m_SystemName; }
 	const UpdateOrder& getUpdateOrder() const { return m_UpdateOrder; }
 	bool isActive() const { return m_IsActive; }
+	const Access& getAccess() const { return m_Access; }
+	bool isMainThreadOnly() const { return m_IsMainThreadOnly; }
+	/// Time taken by the last update() in milliseconds.
+	float getLastUpdateTime() const { return m_LastUpdateTime; }
 
 	void setActive(bool enabled);
 
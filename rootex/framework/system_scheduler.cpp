@@ -0,0 +1,178 @@
+#include "system_scheduler.h"
+
+#include "system.h"
+
+void SystemScheduler::refresh()
+{
+	Vector<System*> activeSystems;
+	for (auto& systems : System::GetSystems())
+	{
+		for (auto& system : systems)
+		{
+			if (system->isActive())
+			{
+				activeSystems.push_back(system);
+			}
+		}
+	}
+
+	if (activeSystems == m_ScheduledSystems)
+	{
+		return;
+	}
+	m_ScheduledSystems = activeSystems;
+
+	m_Nodes.clear();
+	for (int i = 0; i < activeSystems.size(); i++)
+	{
+		Node node;
+		node.system = activeSystems[i];
+		for (int j = 0; j < i; j++)
+		{
+			if (activeSystems[j]->getAccess().conflictsWith(node.system->getAccess()))
+			{
+				node.predecessors.push_back(j);
+			}
+		}
+		m_Nodes.push_back(node);
+	}
+	m_IsDone.reset(new Atomic<bool>[m_Nodes.size()]);
+}
+
+void SystemScheduler::runNode(int index, const TimePoint& frameStart, float deltaMilliseconds)
+{
+	Node& node = m_Nodes[index];
+	Timer timer;
+	node.startTime = (float)(Timer::Now() - frameStart).count() * NS_TO_MS;
+	node.system->update(deltaMilliseconds);
+	node.system->m_LastUpdateTime = timer.getTimeMs();
+	m_IsDone[index].store(true, std::memory_order_release);
+}
+
+void SystemScheduler::update(ThreadPool& pool, float deltaMilliseconds)
+{
+	ZoneScoped;
+	refresh();
+
+	const TimePoint frameStart = Timer::Now();
+	const int nodeCount = m_Nodes.size();
+	for (int i = 0; i < nodeCount; i++)
+	{
+		m_IsDone[i].store(false, std::memory_order_relaxed);
+	}
+
+	// Worker systems become tasks. Main thread systems get an empty gate task released after they have run,
+	// which lets worker systems depend on them.
+	Vector<Ref<Task>> tasks(nodeCount);
+	Vector<Ref<Task>> gates(nodeCount);
+	Vector<Ref<Task>> workerTasks;
+	for (int i = 0; i < nodeCount; i++)
+	{
+		if (m_Nodes[i].system->isMainThreadOnly())
+		{
+			gates[i] = std::make_shared<Task>([]() {});
+			continue;
+		}
+
+		tasks[i] = std::make_shared<Task>([this, i, &frameStart, deltaMilliseconds]() { runNode(i, frameStart, deltaMilliseconds); });
+		for (int predecessor : m_Nodes[i].predecessors)
+		{
+			(tasks[predecessor] ? tasks[predecessor] : gates[predecessor])->precede(tasks[i]);
+		}
+		workerTasks.push_back(tasks[i]);
+	}
+
+	Vector<Ref<TaskCounter>> counters = { pool.submit(workerTasks) };
+	for (int i = 0; i < nodeCount; i++)
+	{
+		if (!gates[i])
+		{
+			continue;
+		}
+
+		const Vector<int>& predecessors = m_Nodes[i].predecessors;
+		pool.waitUntil([this, &predecessors]() {
+			for (int predecessor : predecessors)
+			{
+				if (!m_IsDone[predecessor].load(std::memory_order_acquire))
+				{
+					return false;
+				}
+			}
+			return true;
+		});
+
+		runNode(i, frameStart, deltaMilliseconds);
+		counters.push_back(pool.submit({ gates[i] }));
+	}
+
+	for (auto& counter : counters)
+	{
+		pool.wait(counter);
+	}
+
+	m_FrameTime = (float)(Timer::Now() - frameStart).count() * NS_TO_MS;
+	findCriticalPath();
+}
+
+void SystemScheduler::findCriticalPath()
+{
+	int last = -1;
+	for (int i = 0; i < m_Nodes.size(); i++)
+	{
+		Node& node = m_Nodes[i];
+		node.pathTime = 0.0f;
+		node.pathPredecessor = -1;
+		for (int predecessor : node.predecessors)
+		{
+			if (m_Nodes[predecessor].pathTime > node.pathTime)
+			{
+				node.pathTime = m_Nodes[predecessor].pathTime;
+				node.pathPredecessor = predecessor;
+			}
+		}
+		node.pathTime += node.system->getLastUpdateTime();
+
+		if (last == -1 || node.pathTime > m_Nodes[last].pathTime)
+		{
+			last = i;
+		}
+	}
+
+	m_CriticalPath.clear();
+	m_CriticalPathTime = last == -1 ? 0.0f : m_Nodes[last].pathTime;
+	for (int i = last; i != -1; i = m_Nodes[i].pathPredecessor)
+	{
+		m_CriticalPath.push_back(m_Nodes[i].system);
+	}
+	std::reverse(m_CriticalPath.begin(), m_CriticalPath.end());
+}
+
+void SystemScheduler::draw()
+{
+	ImGui::Text("Frame: %.3f ms", m_FrameTime);
+	ImGui::Text("Critical path: %.3f ms", m_CriticalPathTime);
+
+	ImGui::Columns(4);
+	ImGui::Text("System");
+	ImGui::NextColumn();
+	ImGui::Text("Start (ms)");
+	ImGui::NextColumn();
+	ImGui::Text("Update (ms)");
+	ImGui::NextColumn();
+	ImGui::Text("Thread");
+	ImGui::NextColumn();
+	for (auto& node : m_Nodes)
+	{
+		bool isCritical = std::find(m_CriticalPath.begin(), m_CriticalPath.end(), node.system) != m_CriticalPath.end();
+		ImGui::Text("%s%s", node.system->getName().c_str(), isCritical ? " *" : "");
+		ImGui::NextColumn();
+		ImGui::Text("%.3f", node.startTime);
+		ImGui::NextColumn();
+		ImGui::Text("%.3f", node.system->getLastUpdateTime());
+		ImGui::NextColumn();
+		ImGui::Text("%s", node.system->isMainThreadOnly() ? "Main" : "Any");
+		ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "common/common.h"
+#include "os/thread.h"
+#include "os/timer.h"
+
+class System;
+
+/// Runs the active systems every frame as a graph built from the accesses they declare. Systems are ordered by
+/// UpdateOrder and registration, but a system only waits on the earlier systems it conflicts with. Systems allowed
+/// off the main thread are dispatched on the thread pool, the rest run on the calling thread.
+class SystemScheduler
+{
+	struct Node
+	{
+		System* system;
+		/// Indices of earlier nodes this node has to wait on.
+		Vector<int> predecessors;
+		/// Milliseconds from the frame start to the start of the last update.
+		float startTime = 0.0f;
+		/// Longest chain of update times ending at this node in the last frame.
+		float pathTime = 0.0f;
+		/// Predecessor on the longest chain, -1 if none.
+		int pathPredecessor = -1;
+	};
+
+	Vector<Node> m_Nodes;
+	Vector<System*> m_ScheduledSystems;
+	Ptr<Atomic<bool>[]> m_IsDone;
+	Vector<System*> m_CriticalPath;
+	float m_CriticalPathTime = 0.0f;
+	float m_FrameTime = 0.0f;
+
+	/// Rebuild the graph if the set of active systems changed.
+	void refresh();
+	void runNode(int index, const TimePoint& frameStart, float deltaMilliseconds);
+	void findCriticalPath();
+
+public:
+	SystemScheduler() = default;
+	SystemScheduler(SystemScheduler&) = delete;
+	~SystemScheduler() = default;
+
+	/// Update all active systems once, returning when all of them have finished.
+	void update(ThreadPool& pool, float deltaMilliseconds);
+
+	/// Chain of systems whose update times added up to the longest path through the last frame's graph.
+	const Vector<System*>& getCriticalPath() const { return m_CriticalPath; }
+	float getCriticalPathTime() const { return m_CriticalPathTime; }
+	/// Wall time taken by the last update in milliseconds.
+	float getFrameTime() const { return m_FrameTime; }
+
+	void draw();
+};
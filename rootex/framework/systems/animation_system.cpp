@@ -12,6 +12,7 @@ AnimationSystem* AnimationSystem::GetSingleton()
 AnimationSystem::AnimationSystem()
     : System("AnimationSystem", UpdateOrder::Editor, true)
 {
+	declareWrite<AnimatedModelComponent>();
 }
 
 void AnimationSystem::update(float deltaMilliseconds)
@@ -6,7 +6,6 @@
 #include "framework/ecs_factory.h"
 #include "components/audio/music_component.h"
 #include "components/audio/short_music_component.h"
-#include "components/physics/rigid_body_component.h"
 #include "core/audio/audio_source.h"
 #include "core/audio/static_audio_buffer.h"
 #include "core/audio/streaming_audio_buffer.h"
@@ -114,16 +113,6 @@ void AudioSystem::update(float deltaMilliseconds)
 	for (auto& mc : ECSFactory::GetAllMusicComponent())
 	{
 		mc.getAudioSource()->queueNewBuffers();
-		mc.update();
-	}
-	for (auto& smc : ECSFactory::GetAllShortMusicComponent())
-	{
-		smc.update();
-	}
-
-	if (m_Listener)
-	{
-		m_Listener->update();
 	}
 }
 
@@ -145,9 +134,14 @@ void AudioSystem::end()
 	}
 }
 
+AudioListenerComponent* AudioSystem::getListener() const
+{
+	return ECSFactory::Resolve<AudioListenerComponent>(m_Listener);
+}
+
 void AudioSystem::setListener(AudioListenerComponent* listenerComponent)
 {
-	m_Listener = listenerComponent;
+	m_Listener = ECSFactory::GetHandle(listenerComponent);
 }
 
 void AudioSystem::setConfig(const SceneSettings& sceneSettings)
@@ -185,6 +179,9 @@ void AudioSystem::shutDown()
 }
 
 AudioSystem::AudioSystem()
-    : System("AudioSystem", UpdateOrder::Async, true)
+    : System("AudioSystem", UpdateOrder::Update, true)
 {
+	declareWrite<MusicComponent>();
+	declareWriteResource("OpenAL");
+	setMainThreadOnly(false);
 }
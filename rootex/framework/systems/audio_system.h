@@ -9,6 +9,7 @@
 #include "alc.h"
 #include "alut.h"
 
+#include "framework/ecs_factory.h"
 #include "system.h"
 
 #ifndef ALUT_CHECK
@@ -46,13 +47,14 @@ class StreamingAudioSource;
 
 class ResourceFile;
 
-/// Audio System responsible for streaming and static audio
+/// Audio System responsible for streaming and static audio. Sources and the listener are placed by SpatialAudioSystem.
 class AudioSystem : public System
 {
 	ALCdevice* m_Device = nullptr;
 	ALCcontext* m_Context = nullptr;
 
-	AudioListenerComponent* m_Listener = nullptr;
+	/// Resolves to nullptr once the listener is removed.
+	ComponentHandle m_Listener;
 
 	AudioSystem();
 	AudioSystem(AudioSystem&) = delete;
@@ -72,7 +74,7 @@ public:
 	/// Wrapper over alutGetError function.
 	static void CheckALUTError(const char* msg, const char* fname, int line);
 
-	AudioListenerComponent* getListener() const { return m_Listener; }
+	AudioListenerComponent* getListener() const;
 	void setListener(AudioListenerComponent* listenerComponent);
 
 	void restoreListener();
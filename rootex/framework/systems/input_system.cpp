@@ -6,6 +6,11 @@ InputSystem::InputSystem()
     : System("InputSystem", UpdateOrder::Input, true)
 {
 	m_Binder.bind(RootexEvents::WindowResized, this, &InputSystem::windowResized);
+
+	// Input events are handled by scripts
+	declareWriteAll();
+	declareWriteResource("Lua");
+	declareWriteResource("Input");
 }
 
 Variant InputSystem::windowResized(const Event* event)
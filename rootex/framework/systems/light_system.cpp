@@ -9,8 +9,17 @@
 #include "framework/systems/render_system.h"
 
 LightSystem::LightSystem()
-    : System("LightSystem", UpdateOrder::Async, false)
+    : System("LightSystem", UpdateOrder::PostUpdate, true)
 {
+	// Absolute transforms left dirty by gameplay are recomputed on first read
+	declareWrite<TransformComponent>();
+	declareRead<CameraComponent>();
+	declareRead<PointLightComponent>();
+	declareRead<StaticPointLightComponent>();
+	declareRead<DirectionalLightComponent>();
+	declareRead<SpotLightComponent>();
+	declareWriteResource("Lights");
+	setMainThreadOnly(false);
 }
 
 LightSystem* LightSystem::GetSingleton()
@@ -22,7 +31,7 @@ LightSystem* LightSystem::GetSingleton()
 StaticPointLightsInfo LightSystem::getStaticPointLights()
 {
 	StaticPointLightsInfo staticLights;
-	Vector<StaticPointLightComponent>& staticPointLightComponents = ECSFactory::GetAllStaticPointLightComponent();
+	ComponentArray<StaticPointLightComponent>& staticPointLightComponents = ECSFactory::GetAllStaticPointLightComponent();
 
 	int i = 0;
 	for (; i < staticPointLightComponents.size() && i < MAX_STATIC_POINT_LIGHTS; i++)
@@ -43,26 +52,33 @@ StaticPointLightsInfo LightSystem::getStaticPointLights()
 	return staticLights;
 }
 
-LightsInfo LightSystem::getDynamicLights()
+void LightSystem::update(float deltaMilliseconds)
+{
+	ZoneScoped;
+	m_DynamicLights = findDynamicLights();
+}
+
+LightsInfo LightSystem::findDynamicLights()
 {
 	LightsInfo lights;
 
 	Vector3 cameraPos = RenderSystem::GetSingleton()->getCamera()->getAbsolutePosition();
 	lights.cameraPos = cameraPos;
 
-	static auto pointLightSortingLambda = [&cameraPos](PointLightComponent& a, PointLightComponent& b) -> bool {
-		Vector3& aa = a.getTransformComponent()->getAbsoluteTransform().Translation();
-		Vector3& bb = b.getTransformComponent()->getAbsoluteTransform().Translation();
+	auto pointLightSortingLambda = [&cameraPos](PointLightComponent* a, PointLightComponent* b) -> bool {
+		Vector3& aa = a->getTransformComponent()->getAbsoluteTransform().Translation();
+		Vector3& bb = b->getTransformComponent()->getAbsoluteTransform().Translation();
 		return Vector3::DistanceSquared(cameraPos, aa) < Vector3::DistanceSquared(cameraPos, bb);
 	};
 
-	Vector<PointLightComponent>& pointLightComponents = ECSFactory::GetAllPointLightComponent();
+	ComponentArray<PointLightComponent>& allPointLights = ECSFactory::GetAllPointLightComponent();
+	Vector<PointLightComponent*> pointLightComponents(allPointLights.data(), allPointLights.data() + allPointLights.size());
 	sort(pointLightComponents.begin(), pointLightComponents.end(), pointLightSortingLambda);
 
 	int i = 0;
 	for (; i < pointLightComponents.size() && i < MAX_DYNAMIC_POINT_LIGHTS; i++)
 	{
-		PointLightComponent& light = pointLightComponents[i];
+		PointLightComponent& light = *pointLightComponents[i];
 		Vector3 transformedPosition = light.getAbsoluteTransform().Translation();
 		const PointLight& pointLight = light.getPointLight();
 
@@ -77,7 +93,7 @@ LightsInfo LightSystem::getDynamicLights()
 	}
 	lights.pointLightCount = i;
 
-	Vector<DirectionalLightComponent>& directionalLightComponents = ECSFactory::GetAllDirectionalLightComponent();
+	ComponentArray<DirectionalLightComponent>& directionalLightComponents = ECSFactory::GetAllDirectionalLightComponent();
 	if (directionalLightComponents.size() > 0)
 	{
 		if (directionalLightComponents.size() > 1)
@@ -98,19 +114,20 @@ LightsInfo LightSystem::getDynamicLights()
 		lights.directionalLightPresent = 1;
 	}
 
-	static auto spotLightSortingLambda = [&cameraPos](SpotLightComponent& a, SpotLightComponent& b) -> bool {
-		Vector3& aa = a.getTransformComponent()->getAbsoluteTransform().Translation();
-		Vector3& bb = b.getTransformComponent()->getAbsoluteTransform().Translation();
+	auto spotLightSortingLambda = [&cameraPos](SpotLightComponent* a, SpotLightComponent* b) -> bool {
+		Vector3& aa = a->getTransformComponent()->getAbsoluteTransform().Translation();
+		Vector3& bb = b->getTransformComponent()->getAbsoluteTransform().Translation();
 		return Vector3::DistanceSquared(cameraPos, aa) < Vector3::DistanceSquared(cameraPos, bb);
 	};
 
-	Vector<SpotLightComponent>& spotLightComponents = ECSFactory::GetAllSpotLightComponent();
+	ComponentArray<SpotLightComponent>& allSpotLights = ECSFactory::GetAllSpotLightComponent();
+	Vector<SpotLightComponent*> spotLightComponents(allSpotLights.data(), allSpotLights.data() + allSpotLights.size());
 	sort(spotLightComponents.begin(), spotLightComponents.end(), spotLightSortingLambda);
 
 	i = 0;
 	for (; i < spotLightComponents.size() && i < MAX_DYNAMIC_SPOT_LIGHTS; i++)
 	{
-		SpotLightComponent& light = spotLightComponents[i];
+		SpotLightComponent& light = *spotLightComponents[i];
 		Matrix transform = light.getAbsoluteTransform();
 		const SpotLight& spotLight = light.getSpotLight();
 
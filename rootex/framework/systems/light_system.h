@@ -6,11 +6,18 @@
 /// Interface for setting up point, directional and spot lights.
 class LightSystem : public System
 {
+	/// Dynamic lights closest to the camera, gathered in the last update.
+	LightsInfo m_DynamicLights;
+
 	LightSystem();
 
+	LightsInfo findDynamicLights();
+
 public:
 	static LightSystem* GetSingleton();
 
 	StaticPointLightsInfo getStaticPointLights();
-	LightsInfo getDynamicLights();
+	const LightsInfo& getDynamicLights() const { return m_DynamicLights; }
+
+	void update(float deltaMilliseconds) override;
 };
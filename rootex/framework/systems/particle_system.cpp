@@ -39,6 +39,11 @@ ParticleSystem::ParticleSystem()
     : System("ParticleSystem", UpdateOrder::Render, true)
     , m_TargetUPS(0.0f)
 {
+	declareWrite<ParticleEffectComponent>();
+	declareRead<TransformComponent>();
+	declareRead<CameraComponent>();
+	declareWriteResource("Device");
+	declareWriteResource("OpenAL");
 }
 
 ParticleSystem::~ParticleSystem()
@@ -5,6 +5,7 @@
 #include "core/resource_files/lua_text_resource_file.h"
 
 #include "components/physics/collision_component.h"
+#include "components/physics/static_mesh_collider_component.h"
 #include "script/script.h"
 
 #include "os/timer.h"
@@ -21,6 +22,10 @@ PhysicsSystem* PhysicsSystem::GetSingleton()
 PhysicsSystem::PhysicsSystem()
     : System("PhysicsSystem", UpdateOrder::Update, true)
 {
+	// Collisions call hit() on the scripts of the entities involved
+	declareWriteAll();
+	declareWriteResource("Lua");
+	declareWriteResource("Bullet");
 }
 
 void PhysicsSystem::assignPhysicsMaterials()
@@ -138,6 +143,10 @@ void PhysicsSystem::debugDrawComponent(const btTransform& worldTransform, const
 void PhysicsSystem::update(float deltaMilliseconds)
 {
 	ZoneScoped;
+	for (auto& collider : ECSFactory::GetAllStaticMeshColliderComponent())
+	{
+		collider.refreshCollisionMesh();
+	}
 	m_DynamicsWorld->stepSimulation(deltaMilliseconds * MS_TO_S, 10);
 }
 
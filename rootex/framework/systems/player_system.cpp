@@ -1,10 +1,18 @@
 #include "player_system.h"
 
 #include "components/game/player_controller.h"
+#include "components/physics/capsule_collider_component.h"
+#include "components/visual/model/animated_model_component.h"
 
 PlayerSystem::PlayerSystem()
     : System("PlayerSystem", UpdateOrder::PostUpdate, true)
 {
+	declareWrite<PlayerController>();
+	declareWrite<TransformComponent>();
+	declareWrite<CapsuleColliderComponent>();
+	declareWrite<AnimatedModelComponent>();
+	declareReadResource("Input");
+	declareWriteResource("Bullet");
 }
 
 PlayerSystem* PlayerSystem::GetSingleton()
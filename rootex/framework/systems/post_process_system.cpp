@@ -5,6 +5,8 @@
 PostProcessSystem::PostProcessSystem()
     : System("PostProcessSystem", UpdateOrder::PostRender, true)
 {
+	declareRead<CameraComponent>();
+	declareWriteResource("Device");
 }
 
 PostProcessSystem* PostProcessSystem::GetSingleton()
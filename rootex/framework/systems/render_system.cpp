@@ -5,6 +5,7 @@
 #include "components/visual/effect/sky_component.h"
 #include "components/visual/model/grid_model_component.h"
 #include "components/visual/effect/cpu_particles_component.h"
+#include "components/space/transform_hierarchy.h"
 #include "renderer/shaders/register_locations_vertex_shader.h"
 #include "renderer/shaders/register_locations_pixel_shader.h"
 #include "light_system.h"
@@ -27,7 +28,19 @@ RenderSystem::RenderSystem()
 {
 	m_Binder.bind(RootexEvents::OpenedScene, this, &RenderSystem::onOpenedScene);
 
-	m_Camera = SceneLoader::GetSingleton()->getRootScene()->getEntity().getComponent<CameraComponent>();
+	// Absolute transforms are brought up to date here and renderables update their state before drawing
+	declareWrite<TransformComponent>();
+	declareWrite<ModelComponent>();
+	declareWrite<AnimatedModelComponent>();
+	declareWrite<GridModelComponent>();
+	declareWrite<CPUParticlesComponent>();
+	declareRead<CameraComponent>();
+	declareRead<FogComponent>();
+	declareRead<SkyComponent>();
+	declareReadResource("Lights");
+	declareWriteResource("Device");
+
+	m_Camera = ECSFactory::GetHandle(SceneLoader::GetSingleton()->getRootScene()->getEntity().getComponent<CameraComponent>());
 	m_TransformationStack.push_back(Matrix::Identity);
 
 	m_LineMaterial = ResourceLoader::CreateBasicMaterialResourceFile("rootex/assets/materials/line.basic.rmat");
@@ -71,108 +84,34 @@ void RenderSystem::setConfig(const SceneSettings& sceneSettings)
 
 void RenderSystem::calculateTransforms(Scene* scene)
 {
-	Entity& entity = scene->getEntity();
-	if (TransformComponent* transform = entity.getComponent<TransformComponent>())
-	{
-		int passDown = transform->getPassDowns();
-
-		if (passDown == (int)TransformPassDown::All)
-		{
-			pushMatrix(transform->getLocalTransform());
-		}
-		else
-		{
-			Matrix matrix = Matrix::Identity;
-			if (passDown & (int)TransformPassDown::Position)
-			{
-				matrix = Matrix::CreateTranslation(transform->getPosition()) * matrix;
-			}
-			if (passDown & (int)TransformPassDown::Rotation)
-			{
-				matrix = Matrix::CreateFromQuaternion(transform->getRotation()) * matrix;
-			}
-			if (passDown & (int)TransformPassDown::Scale)
-			{
-				matrix = Matrix::CreateScale(transform->getScale()) * matrix;
-			}
-			pushMatrix(matrix);
-		}
-	}
-	else
-	{
-		pushMatrix(Matrix::Identity);
-	}
-
-	for (auto& child : scene->getChildren())
-	{
-		Entity& childEntity = child->getEntity();
-		if (TransformComponent* childTransform = childEntity.getComponent<TransformComponent>())
-		{
-			childTransform->setParentAbsoluteTransform(getCurrentMatrix());
-		}
-
-		calculateTransforms(child.get());
-	}
-	popMatrix();
+	TransformHierarchy::GetSingleton()->update(scene, Application::GetSingleton()->getThreadPool());
 }
 
-void RenderSystem::renderPassRender(float deltaMilliseconds, RenderPass renderPass)
+template <class RenderableType>
+static void RenderAll(float deltaMilliseconds, RenderPass renderPass, const Vector3& cameraPosition)
 {
-	for (auto& mc : ECSFactory::GetAllModelComponent())
-	{
-		if (mc.getRenderPass() & (unsigned int)renderPass)
-		{
-			mc.preRender(deltaMilliseconds);
-			if (mc.isVisible())
-			{
-				Vector3 viewDistance = mc.getTransformComponent()->getAbsolutePosition() - m_Camera->getAbsolutePosition();
-				mc.render(viewDistance.Length());
-			}
-			mc.postRender();
-		}
-	}
-
-	for (auto& mc : ECSFactory::GetAllGridModelComponent())
-	{
+	ECSFactory::View<RenderableType, TransformComponent>().forEach([&](RenderableType& mc, TransformComponent& transform) {
 		if (mc.getRenderPass() & (unsigned int)renderPass)
 		{
 			mc.preRender(deltaMilliseconds);
 			if (mc.isVisible())
 			{
-				Vector3 viewDistance = mc.getTransformComponent()->getAbsolutePosition() - m_Camera->getAbsolutePosition();
+				Vector3 viewDistance = transform.getAbsolutePosition() - cameraPosition;
 				mc.render(viewDistance.Length());
 			}
 			mc.postRender();
 		}
-	}
+	});
+}
 
-	for (auto& mc : ECSFactory::GetAllCPUParticlesComponent())
-	{
-		if (mc.getRenderPass() & (unsigned int)renderPass)
-		{
-			mc.preRender(deltaMilliseconds);
-			if (mc.isVisible())
-			{
-				Vector3 viewDistance = mc.getTransformComponent()->getAbsolutePosition() - m_Camera->getAbsolutePosition();
-				mc.render(viewDistance.Length());
-			}
-			mc.postRender();
-		}
-	}
+void RenderSystem::renderPassRender(float deltaMilliseconds, RenderPass renderPass)
+{
+	const Vector3 cameraPosition = getCamera()->getAbsolutePosition();
 
-	for (auto& mc : ECSFactory::GetAllAnimatedModelComponent())
-	{
-		if (mc.getRenderPass() & (unsigned int)renderPass)
-		{
-			mc.preRender(deltaMilliseconds);
-			if (mc.isVisible())
-			{
-				Vector3 viewDistance = mc.getTransformComponent()->getAbsolutePosition() - m_Camera->getAbsolutePosition();
-				mc.render(viewDistance.Length());
-			}
-			mc.postRender();
-		}
-	}
+	RenderAll<ModelComponent>(deltaMilliseconds, renderPass, cameraPosition);
+	RenderAll<GridModelComponent>(deltaMilliseconds, renderPass, cameraPosition);
+	RenderAll<CPUParticlesComponent>(deltaMilliseconds, renderPass, cameraPosition);
+	RenderAll<AnimatedModelComponent>(deltaMilliseconds, renderPass, cameraPosition);
 }
 
 void RenderSystem::update(float deltaMilliseconds)
@@ -481,11 +420,20 @@ void RenderSystem::setCamera(CameraComponent* camera)
 {
 	if (camera)
 	{
-		m_Camera = camera;
+		m_Camera = ECSFactory::GetHandle(camera);
 		setPerCameraVSCBs();
 	}
 }
 
+CameraComponent* RenderSystem::getCamera() const
+{
+	if (CameraComponent* camera = ECSFactory::Resolve<CameraComponent>(m_Camera))
+	{
+		return camera;
+	}
+	return SceneLoader::GetSingleton()->getRootScene()->getEntity().getComponent<CameraComponent>();
+}
+
 void RenderSystem::restoreCamera()
 {
 	if (SceneLoader::GetSingleton()->getRootScene())
@@ -23,7 +23,8 @@ class RenderSystem : public System
 		Vector<unsigned short> m_Indices;
 	};
 
-	CameraComponent* m_Camera;
+	/// Resolves to nullptr if the camera is removed without the camera being restored.
+	ComponentHandle m_Camera;
 
 	Ptr<Renderer> m_Renderer;
 	Vector<Matrix> m_TransformationStack;
@@ -85,7 +86,8 @@ public:
 	void enableLineRenderMode();
 	void resetRenderMode();
 
-	CameraComponent* getCamera() const { return m_Camera; }
+	/// Falls back to the camera of the root scene if the camera set has been removed.
+	CameraComponent* getCamera() const;
 	const Matrix& getCurrentMatrix() const;
 	Renderer* getRenderer() const { return m_Renderer.get(); }
 
@@ -8,6 +8,9 @@ RenderUISystem::RenderUISystem()
     : System("RenderUISystem", UpdateOrder::RenderUI, true)
 {
 	m_UITransformationStack.push_back(Matrix::Identity);
+
+	declareWrite<TextUIComponent>();
+	declareWriteResource("Device");
 }
 
 RenderUISystem* RenderUISystem::GetSingleton()
@@ -7,6 +7,8 @@ ScriptSystem::ScriptSystem()
     : System("ScriptSystem", UpdateOrder::Update, true)
     , m_FluxTweener(LuaInterpreter::GetSingleton()->getLuaState().require_file("flux", "rootex/vendor/Flux/flux.lua"))
 {
+	declareWriteAll();
+	declareWriteResource("Lua");
 }
 
 ScriptSystem* ScriptSystem::GetSingleton()
@@ -59,28 +61,49 @@ void CallUpdateForScene(Scene* scene, float deltaMilliseconds)
 	}
 }
 
+/// Scenes still being streamed in are created outside the scene tree and join it once complete.
+static bool IsInSceneTree(Scene* scene)
+{
+	while (scene->getParent())
+	{
+		scene = scene->getParent();
+	}
+	return scene == SceneLoader::GetSingleton()->getRootScene();
+}
+
 void ScriptSystem::update(float deltaMilliseconds)
 {
 	ZoneScoped;
 
+	// Entities outside the scene tree wait for their scene to be added to it
+	Vector<Entity*> waitingToInit;
 	for (auto& entity : m_ScriptEntitiesToInit)
 	{
-		if (entity)
+		if (entity && !IsInSceneTree(entity->getScene()))
+		{
+			waitingToInit.push_back(entity);
+		}
+		else if (entity)
 		{
 			entity->evaluateScriptOverrides();
 			entity->call("begin", { entity });
 		}
 	}
-	m_ScriptEntitiesToInit.clear();
+	m_ScriptEntitiesToInit = std::move(waitingToInit);
 
+	Vector<Entity*> waitingToEnter;
 	for (auto& entity : m_ScriptEntitiesToEnter)
 	{
-		if (entity)
+		if (entity && !IsInSceneTree(entity->getScene()))
+		{
+			waitingToEnter.push_back(entity);
+		}
+		else if (entity)
 		{
 			entity->call("enterScene", { entity });
 		}
 	}
-	m_ScriptEntitiesToEnter.clear();
+	m_ScriptEntitiesToEnter = std::move(waitingToEnter);
 
 	Scene* root = SceneLoader::GetSingleton()->getRootScene();
 	CallUpdateForScene(root, deltaMilliseconds);
@@ -0,0 +1,50 @@
+#include "spatial_audio_system.h"
+
+#include "framework/ecs_factory.h"
+#include "components/audio/music_component.h"
+#include "components/audio/short_music_component.h"
+#include "components/physics/box_collider_component.h"
+#include "components/physics/sphere_collider_component.h"
+#include "components/physics/capsule_collider_component.h"
+#include "audio_system.h"
+
+SpatialAudioSystem::SpatialAudioSystem()
+    : System("SpatialAudioSystem", UpdateOrder::PostUpdate, true)
+{
+	// Absolute transforms left dirty by gameplay are recomputed on first read
+	declareWrite<TransformComponent>();
+	declareRead<AudioListenerComponent>();
+	declareRead<BoxColliderComponent>();
+	declareRead<SphereColliderComponent>();
+	declareRead<CapsuleColliderComponent>();
+	declareWrite<MusicComponent>();
+	declareWrite<ShortMusicComponent>();
+	declareReadResource("Bullet");
+	declareWriteResource("OpenAL");
+	setMainThreadOnly(false);
+}
+
+SpatialAudioSystem* SpatialAudioSystem::GetSingleton()
+{
+	static SpatialAudioSystem singleton;
+	return &singleton;
+}
+
+void SpatialAudioSystem::update(float deltaMilliseconds)
+{
+	ZoneScoped;
+
+	for (auto& mc : ECSFactory::GetAllMusicComponent())
+	{
+		mc.update();
+	}
+	for (auto& smc : ECSFactory::GetAllShortMusicComponent())
+	{
+		smc.update();
+	}
+
+	if (AudioListenerComponent* listener = AudioSystem::GetSingleton()->getListener())
+	{
+		listener->update();
+	}
+}
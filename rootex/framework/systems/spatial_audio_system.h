@@ -0,0 +1,18 @@
+#pragma once
+
+#include "common/common.h"
+#include "framework/system.h"
+
+/// Moves audio sources and the listener to where their entities are, once gameplay has moved them for the frame.
+/// Kept apart from AudioSystem so that streaming does not wait on transforms.
+class SpatialAudioSystem : public System
+{
+	SpatialAudioSystem();
+	SpatialAudioSystem(const SpatialAudioSystem&) = delete;
+	virtual ~SpatialAudioSystem() = default;
+
+public:
+	static SpatialAudioSystem* GetSingleton();
+
+	void update(float deltaMilliseconds) override;
+};
@@ -12,6 +12,9 @@ TransformAnimationSystem* TransformAnimationSystem::GetSingleton()
 TransformAnimationSystem::TransformAnimationSystem()
     : System("TransformationAnimationSystem", UpdateOrder::Update, true)
 {
+	declareWrite<TransformAnimationComponent>();
+	declareWrite<TransformComponent>();
+	setMainThreadOnly(false);
 }
 
 void TransformAnimationSystem::begin()
@@ -6,6 +6,10 @@
 TriggerSystem::TriggerSystem()
     : System("TriggerSystem", UpdateOrder::PostUpdate, true)
 {
+	// Entering and exiting triggers calls into the scripts of the trigger entities
+	declareWriteAll();
+	declareWriteResource("Lua");
+	declareReadResource("Bullet");
 }
 
 TriggerSystem* TriggerSystem::GetSingleton()
@@ -47,6 +47,11 @@ UISystem::UISystem()
 {
 	m_Binder.bind(RootexEvents::UISystemEnableDebugger, this, &UISystem::enableDebugger);
 	m_Binder.bind(RootexEvents::UISystemDisableDebugger, this, &UISystem::disableDebugger);
+
+	// Documents can run Lua event listeners
+	declareWriteAll();
+	declareWriteResource("Lua");
+	declareWriteResource("Device");
 }
 
 Variant UISystem::enableDebugger(const Event* event)
@@ -0,0 +1,297 @@
+#include "file_watcher.h"
+
+#include "common/common.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::~FileWatcher()
+{
+	stop();
+}
+
+bool FileWatcher::start(const FilePath& directory)
+{
+	stop();
+
+	m_Directory = directory;
+	if (!openBackend())
+	{
+		WARN("Could not watch for file changes in " + directory.generic_string());
+		closeBackend();
+		return false;
+	}
+
+	m_IsRunning = true;
+	m_Thread = std::thread(&FileWatcher::loop, this);
+	return true;
+}
+
+void FileWatcher::stop()
+{
+	// The watching thread stops by itself if the directory can no longer be watched
+	if (!m_Thread.joinable())
+	{
+		return;
+	}
+
+	m_IsRunning = false;
+	signalStop();
+	m_Thread.join();
+	closeBackend();
+	m_PendingChanges.clear();
+}
+
+Vector<String> FileWatcher::drainChanges()
+{
+	std::lock_guard<Mutex> lock(m_ChangesMutex);
+	Vector<String> changes(m_Changes.begin(), m_Changes.end());
+	m_Changes.clear();
+	return changes;
+}
+
+void FileWatcher::onChange(const String& path)
+{
+	m_PendingChanges[path] = Clock::now();
+}
+
+void FileWatcher::settleChanges()
+{
+	const Clock::time_point now = Clock::now();
+	std::lock_guard<Mutex> lock(m_ChangesMutex);
+	for (auto change = m_PendingChanges.begin(); change != m_PendingChanges.end();)
+	{
+		if (now - change->second >= std::chrono::milliseconds(FILE_WATCH_SETTLE_MS))
+		{
+			m_Changes.insert(change->first);
+			change = m_PendingChanges.erase(change);
+		}
+		else
+		{
+			change++;
+		}
+	}
+}
+
+void FileWatcher::loop()
+{
+	while (m_IsRunning)
+	{
+		// Sleeps until something changes, and wakes up only to settle changes while there are some
+		readChanges(m_PendingChanges.empty() ? -1 : FILE_WATCH_SETTLE_MS);
+		settleChanges();
+	}
+}
+
+#ifdef __linux__
+
+bool FileWatcher::openBackend()
+{
+	m_Inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_Inotify < 0 || pipe(m_StopPipe) != 0)
+	{
+		return false;
+	}
+
+	// inotify does not watch subdirectories, every directory is watched on its own
+	watchDirectory("");
+	std::error_code error;
+	for (auto& entry : std::filesystem::recursive_directory_iterator(m_Directory, std::filesystem::directory_options::skip_permission_denied, error))
+	{
+		if (entry.is_directory())
+		{
+			watchDirectory(entry.path().lexically_relative(m_Directory).generic_string());
+		}
+	}
+	return true;
+}
+
+void FileWatcher::closeBackend()
+{
+	for (int handle : { m_Inotify, m_StopPipe[0], m_StopPipe[1] })
+	{
+		if (handle >= 0)
+		{
+			close(handle);
+		}
+	}
+	m_Inotify = -1;
+	m_StopPipe[0] = -1;
+	m_StopPipe[1] = -1;
+	m_WatchedDirectories.clear();
+}
+
+void FileWatcher::signalStop()
+{
+	const char stop = 0;
+	if (write(m_StopPipe[1], &stop, 1) != 1)
+	{
+		WARN("Could not stop watching for file changes");
+	}
+}
+
+void FileWatcher::watchDirectory(const String& directory)
+{
+	const int watch = inotify_add_watch(m_Inotify, (m_Directory / directory).c_str(), IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM);
+	if (watch >= 0)
+	{
+		m_WatchedDirectories[watch] = directory;
+	}
+}
+
+void FileWatcher::readChanges(int timeoutMs)
+{
+	pollfd handles[2] = { { m_Inotify, POLLIN, 0 }, { m_StopPipe[0], POLLIN, 0 } };
+	if (poll(handles, 2, timeoutMs) <= 0 || !(handles[0].revents & POLLIN))
+	{
+		return;
+	}
+
+	alignas(inotify_event) char buffer[16 * 1024];
+	while (true)
+	{
+		const ssize_t length = read(m_Inotify, buffer, sizeof(buffer));
+		if (length <= 0)
+		{
+			break;
+		}
+
+		const inotify_event* event = nullptr;
+		for (const char* at = buffer; at < buffer + length; at += sizeof(inotify_event) + event->len)
+		{
+			event = (const inotify_event*)at;
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				WARN("Too many file changes at once, some were missed");
+				continue;
+			}
+
+			auto&& directory = m_WatchedDirectories.find(event->wd);
+			if (directory == m_WatchedDirectories.end() || event->len == 0)
+			{
+				continue;
+			}
+
+			const String name = event->name;
+			const String path = directory->second.empty() ? name : directory->second + "/" + name;
+			if (event->mask & IN_ISDIR)
+			{
+				if (event->mask & (IN_CREATE | IN_MOVED_TO))
+				{
+					watchDirectory(path);
+				}
+				continue;
+			}
+			onChange(path);
+		}
+	}
+}
+
+#else
+
+bool FileWatcher::openBackend()
+{
+	m_DirectoryHandle = CreateFileW(
+	    m_Directory.wstring().c_str(),
+	    FILE_LIST_DIRECTORY,
+	    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+	    nullptr,
+	    OPEN_EXISTING,
+	    FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+	    nullptr);
+	m_ChangeEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+	m_StopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+	if (m_DirectoryHandle == INVALID_HANDLE_VALUE || !m_ChangeEvent || !m_StopEvent)
+	{
+		return false;
+	}
+
+	m_Buffer.resize(16 * 1024);
+	return requestChanges();
+}
+
+void FileWatcher::closeBackend()
+{
+	if (m_DirectoryHandle != INVALID_HANDLE_VALUE)
+	{
+		// The pending read writes to m_Buffer until it is cancelled
+		DWORD bytes = 0;
+		if (CancelIoEx(m_DirectoryHandle, &m_Overlapped))
+		{
+			GetOverlappedResult(m_DirectoryHandle, &m_Overlapped, &bytes, TRUE);
+		}
+		CloseHandle(m_DirectoryHandle);
+		m_DirectoryHandle = INVALID_HANDLE_VALUE;
+	}
+	for (HANDLE* event : { &m_ChangeEvent, &m_StopEvent })
+	{
+		if (*event)
+		{
+			CloseHandle(*event);
+			*event = nullptr;
+		}
+	}
+}
+
+void FileWatcher::signalStop()
+{
+	SetEvent(m_StopEvent);
+}
+
+bool FileWatcher::requestChanges()
+{
+	m_Overlapped = {};
+	m_Overlapped.hEvent = m_ChangeEvent;
+	return ReadDirectoryChangesW(
+	    m_DirectoryHandle,
+	    m_Buffer.data(),
+	    m_Buffer.size() * sizeof(DWORD),
+	    TRUE,
+	    FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE,
+	    nullptr,
+	    &m_Overlapped,
+	    nullptr);
+}
+
+void FileWatcher::readChanges(int timeoutMs)
+{
+	HANDLE events[2] = { m_ChangeEvent, m_StopEvent };
+	if (WaitForMultipleObjects(2, events, FALSE, timeoutMs < 0 ? INFINITE : timeoutMs) != WAIT_OBJECT_0)
+	{
+		return;
+	}
+
+	DWORD bytes = 0;
+	if (GetOverlappedResult(m_DirectoryHandle, &m_Overlapped, &bytes, FALSE))
+	{
+		if (bytes == 0)
+		{
+			WARN("Too many file changes at once, some were missed");
+		}
+
+		const char* at = (const char*)m_Buffer.data();
+		while (bytes)
+		{
+			const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)at;
+			const std::wstring name(info->FileName, info->FileNameLength / sizeof(WCHAR));
+			onChange(FilePath(WideStringToString(name)).generic_string());
+
+			if (info->NextEntryOffset == 0)
+			{
+				break;
+			}
+			at += info->NextEntryOffset;
+		}
+	}
+
+	if (!requestChanges())
+	{
+		WARN("Stopped watching for file changes in " + m_Directory.generic_string());
+		m_IsRunning = false;
+	}
+}
+
+#endif
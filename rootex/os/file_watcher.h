@@ -0,0 +1,65 @@
+#pragma once
+
+#include <thread>
+#include <chrono>
+
+#include "common/types.h"
+
+/// Milliseconds a file has to go without changing before it is reported, so a burst of writes reports it once.
+#define FILE_WATCH_SETTLE_MS 100
+
+/// Watches a directory tree on a background thread and collects the files changed in it as root relative paths,
+/// instead of polling the timestamp of every file. Uses ReadDirectoryChangesW on Windows and inotify on Linux.
+class FileWatcher
+{
+	typedef std::chrono::steady_clock Clock;
+
+	std::thread m_Thread;
+	Atomic<bool> m_IsRunning = false;
+	FilePath m_Directory;
+
+	Mutex m_ChangesMutex;
+	HashSet<String> m_Changes;
+	/// Files still changing, with the time of their last change. Only touched by the watching thread.
+	HashMap<String, Clock::time_point> m_PendingChanges;
+
+#ifdef __linux__
+	int m_Inotify = -1;
+	int m_StopPipe[2] = { -1, -1 };
+	HashMap<int, String> m_WatchedDirectories;
+
+	void watchDirectory(const String& directory);
+#else
+	HANDLE m_DirectoryHandle = INVALID_HANDLE_VALUE;
+	HANDLE m_ChangeEvent = nullptr;
+	HANDLE m_StopEvent = nullptr;
+	OVERLAPPED m_Overlapped = {};
+	/// Receives FILE_NOTIFY_INFORMATION records, which need DWORD alignment.
+	Vector<DWORD> m_Buffer;
+
+	bool requestChanges();
+#endif
+
+	bool openBackend();
+	void closeBackend();
+	void signalStop();
+	/// Wait up to timeoutMs for changes and add them to the pending changes. Waits until a change or stop if negative.
+	void readChanges(int timeoutMs);
+	void onChange(const String& path);
+	/// Move the pending changes that have settled to the changes reported by drainChanges().
+	void settleChanges();
+	void loop();
+
+public:
+	FileWatcher() = default;
+	FileWatcher(FileWatcher&) = delete;
+	~FileWatcher();
+
+	/// Start watching every file under directory. Returns false if the directory could not be watched.
+	bool start(const FilePath& directory);
+	void stop();
+
+	bool isRunning() const { return m_IsRunning; }
+	/// Returns the files whose changes have settled since the last call, each once.
+	Vector<String> drainChanges();
+};
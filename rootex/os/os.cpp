@@ -5,6 +5,7 @@
 #include <codecvt>
 
 #include "event_manager.h"
+#include "virtual_file_system.h"
 
 #include <commdlg.h>
 #include <commctrl.h>
@@ -526,13 +527,13 @@ FileBuffer OS::LoadFileContents(String stringPath)
 
 JSON::json OS::LoadFileContentsToJSONObject(String stringPath)
 {
-	const FileBuffer& fileBuffer = LoadFileContents(stringPath);
-	String fileString(fileBuffer.begin(), fileBuffer.end());
+	// Parsed in place from the mapped file
+	const FileView& file = VirtualFileSystem::LoadFile(stringPath);
 
 	JSON::json j = JSON::json::object();
 	try
 	{
-		j = JSON::json::parse(fileString);
+		j = JSON::json::parse(file.getContents().begin(), file.getContents().end());
 	}
 	catch (std::exception j)
 	{
@@ -570,6 +571,16 @@ FileBuffer OS::LoadFileContentsAbsolute(String absPath)
 	return FileBuffer(buffer);
 }
 
+Ref<MappedFile> OS::MapFile(String stringPath)
+{
+	Ref<MappedFile> mappedFile(new MappedFile());
+	if (!mappedFile->open(GetAbsolutePath(stringPath)))
+	{
+		return nullptr;
+	}
+	return mappedFile;
+}
+
 bool OS::IsExistsAbsolute(String absPath)
 {
 	return std::filesystem::exists(absPath);
@@ -749,3 +760,62 @@ bool OS::SaveFileAbsolute(const FilePath& absFilePath, const char* fileBuffer, s
 	outFile.close();
 	return true;
 }
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const FilePath& absPath)
+{
+	close();
+
+	m_File = CreateFileW(absPath.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_File == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_File, &size) || size.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+	m_Size = size.QuadPart;
+
+	m_Mapping = CreateFileMappingW(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_Mapping)
+	{
+		close();
+		return false;
+	}
+
+	m_Data = (const char*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!m_Data)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (m_Data)
+	{
+		UnmapViewOfFile(m_Data);
+		m_Data = nullptr;
+	}
+	if (m_Mapping)
+	{
+		CloseHandle(m_Mapping);
+		m_Mapping = nullptr;
+	}
+	if (m_File != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_File);
+		m_File = INVALID_HANDLE_VALUE;
+	}
+	m_Size = 0;
+}
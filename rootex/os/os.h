@@ -17,6 +17,28 @@ typedef std::chrono::time_point<std::filesystem::file_time_type::clock> FileTime
 std::wstring StringToWideString(const String& str);
 String WideStringToString(const std::wstring& wstr);
 
+/// Read-only view of a whole file mapped into the address space. Pages are loaded on first access.
+class MappedFile
+{
+	HANDLE m_File = INVALID_HANDLE_VALUE;
+	HANDLE m_Mapping = nullptr;
+	const char* m_Data = nullptr;
+	size_t m_Size = 0;
+
+public:
+	MappedFile() = default;
+	MappedFile(MappedFile&) = delete;
+	~MappedFile();
+
+	/// Map the file at absPath. Returns false if the file could not be opened or mapped.
+	bool open(const FilePath& absPath);
+	void close();
+
+	bool isOpen() const { return m_Data != nullptr; }
+	const char* getData() const { return m_Data; }
+	size_t getSize() const { return m_Size; }
+};
+
 /// Provides features that are provided directly by the OS.
 class OS
 {
@@ -66,6 +88,8 @@ public:
 	static FileBuffer LoadFileContents(String stringPath);
 	static JSON::json LoadFileContentsToJSONObject(String stringPath);
 	static FileBuffer LoadFileContentsAbsolute(String absPath);
+	/// Map a file into memory instead of reading it. Returns nullptr if the file could not be mapped.
+	static Ref<MappedFile> MapFile(String stringPath);
 	static FilePath GetAbsolutePath(String stringPath);
 	static FilePath GetRootRelativePath(String stringPath);
 	static FilePath GetRelativePath(String stringPath, String base);
@@ -0,0 +1,426 @@
+#include "pak_file.h"
+
+#include "common/common.h"
+
+#include <compressapi.h>
+
+/// Compressors and decompressors are kept per thread and codec, as creating one allocates its working memory.
+template <class Handle, BOOL(WINAPI* Create)(DWORD, PCOMPRESS_ALLOCATION_ROUTINES, Handle*), BOOL(WINAPI* Close)(Handle)>
+class CodecHandles
+{
+	Handle m_Handles[3] = {};
+
+public:
+	~CodecHandles()
+	{
+		for (auto& handle : m_Handles)
+		{
+			if (handle)
+			{
+				Close(handle);
+			}
+		}
+	}
+
+	Handle get(PakCodec codec)
+	{
+		Handle& handle = m_Handles[(int)codec];
+		if (!handle && !Create(codec == PakCodec::Fast ? COMPRESS_ALGORITHM_XPRESS : COMPRESS_ALGORITHM_LZMS, nullptr, &handle))
+		{
+			handle = nullptr;
+		}
+		return handle;
+	}
+};
+
+static thread_local CodecHandles<COMPRESSOR_HANDLE, CreateCompressor, CloseCompressor> s_Compressors;
+static thread_local CodecHandles<DECOMPRESSOR_HANDLE, CreateDecompressor, CloseDecompressor> s_Decompressors;
+
+/// Compress a block. Returns false if it could not be compressed to fewer bytes.
+static bool CompressBlock(PakCodec codec, const char* data, size_t size, FileBuffer& compressed)
+{
+	COMPRESSOR_HANDLE compressor = s_Compressors.get(codec);
+	compressed.resize(size);
+	SIZE_T compressedSize = 0;
+	if (!compressor || !Compress(compressor, data, size, compressed.data(), compressed.size(), &compressedSize) || compressedSize >= size)
+	{
+		return false;
+	}
+	compressed.resize(compressedSize);
+	return true;
+}
+
+static unsigned long long AlignUp(unsigned long long offset, unsigned long long alignment)
+{
+	return (offset + alignment - 1) / alignment * alignment;
+}
+
+/// Offset an entry of the given size is written at when the pak has been written up to offset.
+static unsigned long long GetEntryOffset(unsigned long long offset, unsigned long long size)
+{
+	if (size >= PAK_ENTRY_ALIGNMENT)
+	{
+		return AlignUp(offset, PAK_ENTRY_ALIGNMENT);
+	}
+
+	offset = AlignUp(offset, PAK_SMALL_ENTRY_ALIGNMENT);
+	if (size && offset / PAK_ENTRY_ALIGNMENT != (offset + size - 1) / PAK_ENTRY_ALIGNMENT)
+	{
+		return AlignUp(offset, PAK_ENTRY_ALIGNMENT);
+	}
+	return offset;
+}
+
+static unsigned long long GetBlockCount(unsigned long long size, unsigned long long blockSize)
+{
+	return (size + blockSize - 1) / blockSize;
+}
+
+unsigned long long PakFile::HashPath(const String& path)
+{
+	unsigned long long hash = 14695981039346656037ull;
+	for (char ch : path)
+	{
+		hash = (hash ^ (unsigned char)ch) * 1099511628211ull;
+	}
+	return hash;
+}
+
+bool PakFile::open(const FilePath& absPath)
+{
+	Ref<MappedFile> file(new MappedFile());
+	if (!file->open(absPath))
+	{
+		WARN("Could not open pak file: " + absPath.generic_string());
+		return false;
+	}
+
+	const unsigned long long fileSize = file->getSize();
+	PakHeader header;
+	if (fileSize < sizeof(PakHeader))
+	{
+		WARN("Not a pak file: " + absPath.generic_string());
+		return false;
+	}
+	memcpy(&header, file->getData(), sizeof(PakHeader));
+	if (header.magic != PAK_MAGIC || header.version != PAK_VERSION)
+	{
+		WARN("Not a pak file or an unsupported pak version: " + absPath.generic_string());
+		return false;
+	}
+
+	if (header.tocOffset % alignof(PakEntry) != 0
+	    || header.tocOffset > fileSize
+	    || header.entryCount > (fileSize - header.tocOffset) / sizeof(PakEntry)
+	    || header.namesOffset > fileSize
+	    || header.namesSize > fileSize - header.namesOffset)
+	{
+		WARN("Pak file is damaged: " + absPath.generic_string());
+		return false;
+	}
+
+	m_File = file;
+
+	// Validated once here so lookups and decompression can trust the table of contents
+	const PakEntry* entries = (const PakEntry*)(file->getData() + header.tocOffset);
+	for (unsigned int i = 0; i < header.entryCount; i++)
+	{
+		if (!isValidEntry(entries[i], fileSize, header.namesSize) || (i > 0 && entries[i - 1].pathHash > entries[i].pathHash))
+		{
+			WARN("Pak file is damaged: " + absPath.generic_string());
+			m_File.reset();
+			return false;
+		}
+	}
+
+	m_Path = absPath;
+	m_Entries = entries;
+	m_EntryCount = header.entryCount;
+	m_Names = file->getData() + header.namesOffset;
+	return true;
+}
+
+bool PakFile::isValidEntry(const PakEntry& entry, unsigned long long fileSize, unsigned long long namesSize) const
+{
+	const unsigned int knownFlags = (unsigned int)PakEntryFlag::NullTerminated;
+	if ((entry.flags & ~knownFlags) != 0
+	    || entry.codec > PakCodec::Dense
+	    || entry.offset > fileSize
+	    || entry.storedSize > fileSize - entry.offset
+	    || (unsigned long long)entry.nameOffset + entry.nameSize > namesSize)
+	{
+		return false;
+	}
+
+	if (!entry.isCompressed())
+	{
+		return entry.storedSize == entry.size + (entry.hasFlag(PakEntryFlag::NullTerminated) ? 1 : 0);
+	}
+
+	if (entry.offset % alignof(unsigned long long) != 0 || entry.storedSize < sizeof(PakBlockIndex))
+	{
+		return false;
+	}
+	PakBlockIndex index;
+	memcpy(&index, m_File->getData() + entry.offset, sizeof(PakBlockIndex));
+	const unsigned long long indexSize = sizeof(PakBlockIndex) + (index.blockCount + 1ull) * sizeof(unsigned long long);
+	if (index.blockSize == 0 || index.blockCount != GetBlockCount(entry.size, index.blockSize) || indexSize > entry.storedSize)
+	{
+		return false;
+	}
+
+	const unsigned long long* offsets = getBlockOffsets(entry);
+	if (offsets[0] != indexSize || offsets[index.blockCount] != entry.storedSize)
+	{
+		return false;
+	}
+	for (unsigned int block = 0; block < index.blockCount; block++)
+	{
+		const unsigned long long rawSize = std::min<unsigned long long>(index.blockSize, entry.size - (unsigned long long)block * index.blockSize);
+		if (offsets[block + 1] < offsets[block] || offsets[block + 1] - offsets[block] > rawSize)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+const unsigned long long* PakFile::getBlockOffsets(const PakEntry& entry) const
+{
+	return (const unsigned long long*)(m_File->getData() + entry.offset + sizeof(PakBlockIndex));
+}
+
+const PakEntry* PakFile::find(const String& path) const
+{
+	const unsigned long long hash = HashPath(path);
+	const PakEntry* end = m_Entries + m_EntryCount;
+	const PakEntry* entry = std::lower_bound(m_Entries, end, hash, [](const PakEntry& entry, unsigned long long hash) {
+		return entry.pathHash < hash;
+	});
+
+	for (; entry != end && entry->pathHash == hash; entry++)
+	{
+		if (getName(*entry) == path)
+		{
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+std::string_view PakFile::getName(const PakEntry& entry) const
+{
+	return std::string_view(m_Names + entry.nameOffset, entry.nameSize);
+}
+
+std::string_view PakFile::getContents(const PakEntry& entry) const
+{
+	return std::string_view(m_File->getData() + entry.offset, entry.size);
+}
+
+bool PakFile::decompress(const PakEntry& entry, char* destination, ThreadPool* threadPool) const
+{
+	PakBlockIndex index;
+	memcpy(&index, m_File->getData() + entry.offset, sizeof(PakBlockIndex));
+
+	Atomic<bool> isDamaged = false;
+	auto decompressBlocks = [&](size_t begin, size_t end) {
+		for (size_t block = begin; block < end && !isDamaged; block++)
+		{
+			if (!decompressBlock(entry, block, destination + block * index.blockSize))
+			{
+				isDamaged = true;
+			}
+		}
+	};
+	// Every block is written straight to its place in destination
+	if (threadPool && index.blockCount > 1)
+	{
+		threadPool->parallelFor(0, index.blockCount, 1, decompressBlocks);
+	}
+	else
+	{
+		decompressBlocks(0, index.blockCount);
+	}
+
+	if (isDamaged)
+	{
+		WARN("Pak entry is damaged: " + String(getName(entry)));
+		return false;
+	}
+	return true;
+}
+
+bool PakFile::decompressBlock(const PakEntry& entry, unsigned int block, char* destination) const
+{
+	PakBlockIndex index;
+	memcpy(&index, m_File->getData() + entry.offset, sizeof(PakBlockIndex));
+	const unsigned long long* offsets = getBlockOffsets(entry);
+	const char* stored = m_File->getData() + entry.offset + offsets[block];
+	const size_t storedSize = offsets[block + 1] - offsets[block];
+	const size_t rawSize = std::min<unsigned long long>(index.blockSize, entry.size - (unsigned long long)block * index.blockSize);
+
+	if (storedSize == rawSize)
+	{
+		memcpy(destination, stored, rawSize);
+		return true;
+	}
+
+	DECOMPRESSOR_HANDLE decompressor = s_Decompressors.get(entry.codec);
+	SIZE_T decompressedSize = 0;
+	return decompressor && Decompress(decompressor, stored, storedSize, destination, rawSize, &decompressedSize) && decompressedSize == rawSize;
+}
+
+void PakWriter::addFile(const String& path, unsigned int flags, PakCodec codec)
+{
+	m_Sources.push_back({ FilePath(path).lexically_normal().generic_string(), flags, codec });
+}
+
+bool PakWriter::save(const FilePath& absPath, ThreadPool* threadPool)
+{
+	// Data is laid out by path to keep files of a directory together, the table of contents is sorted by hash
+	std::sort(m_Sources.begin(), m_Sources.end(), [](const Source& a, const Source& b) { return a.path < b.path; });
+	m_Sources.erase(std::unique(m_Sources.begin(), m_Sources.end(), [](const Source& a, const Source& b) { return a.path == b.path; }), m_Sources.end());
+
+	FilePath temporaryPath = absPath;
+	temporaryPath += ".tmp";
+	std::ofstream pak(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!pak)
+	{
+		WARN("Could not write pak file: " + absPath.generic_string());
+		return false;
+	}
+
+	const Vector<char> padding(PAK_ENTRY_ALIGNMENT, 0);
+	unsigned long long offset = sizeof(PakHeader);
+	pak.write(padding.data(), offset);
+
+	Vector<PakEntry> entries;
+	String names;
+	for (auto& source : m_Sources)
+	{
+		std::error_code error;
+		const unsigned long long size = std::filesystem::file_size(OS::GetAbsolutePath(source.path), error);
+		Ref<MappedFile> sourceFile = size ? OS::MapFile(source.path) : nullptr;
+		if (error || (size && !sourceFile))
+		{
+			WARN("Could not read file to add to pak: " + source.path);
+			pak.close();
+			std::filesystem::remove(temporaryPath, error);
+			return false;
+		}
+
+		PakEntry entry = {};
+		entry.pathHash = PakFile::HashPath(source.path);
+		entry.size = size;
+		entry.nameOffset = names.size();
+		entry.nameSize = source.path.size();
+		entry.flags = source.flags;
+		entry.codec = source.codec;
+
+		Vector<FileBuffer> blocks;
+		Vector<unsigned long long> blockOffsets;
+		if (entry.isCompressed())
+		{
+			blocks.resize(GetBlockCount(size, PAK_BLOCK_SIZE));
+			auto compressBlocks = [&](size_t begin, size_t end) {
+				for (size_t block = begin; block < end; block++)
+				{
+					const char* raw = sourceFile->getData() + block * PAK_BLOCK_SIZE;
+					const size_t rawSize = std::min<unsigned long long>(PAK_BLOCK_SIZE, size - block * PAK_BLOCK_SIZE);
+					if (!CompressBlock(entry.codec, raw, rawSize, blocks[block]))
+					{
+						blocks[block].assign(raw, raw + rawSize);
+					}
+				}
+			};
+			if (threadPool && blocks.size() > 1)
+			{
+				threadPool->parallelFor(0, blocks.size(), 1, compressBlocks);
+			}
+			else
+			{
+				compressBlocks(0, blocks.size());
+			}
+
+			blockOffsets.push_back(sizeof(PakBlockIndex) + (blocks.size() + 1) * sizeof(unsigned long long));
+			for (auto& block : blocks)
+			{
+				blockOffsets.push_back(blockOffsets.back() + block.size());
+			}
+			entry.storedSize = blockOffsets.back();
+
+			// Not worth decompressing, keep it readable in place
+			if (entry.storedSize >= size)
+			{
+				entry.codec = PakCodec::None;
+			}
+		}
+		if (!entry.isCompressed())
+		{
+			entry.storedSize = size + (entry.hasFlag(PakEntryFlag::NullTerminated) ? 1 : 0);
+		}
+
+		const unsigned long long entryOffset = GetEntryOffset(offset, entry.storedSize);
+		pak.write(padding.data(), entryOffset - offset);
+		entry.offset = entryOffset;
+		if (entry.isCompressed())
+		{
+			const PakBlockIndex index = { PAK_BLOCK_SIZE, (unsigned int)blocks.size() };
+			pak.write((const char*)&index, sizeof(PakBlockIndex));
+			pak.write((const char*)blockOffsets.data(), blockOffsets.size() * sizeof(unsigned long long));
+			for (auto& block : blocks)
+			{
+				pak.write(block.data(), block.size());
+			}
+		}
+		else
+		{
+			if (size)
+			{
+				pak.write(sourceFile->getData(), size);
+			}
+			if (entry.hasFlag(PakEntryFlag::NullTerminated))
+			{
+				pak.put('\0');
+			}
+		}
+		offset = entryOffset + entry.storedSize;
+
+		names += source.path;
+		entries.push_back(entry);
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const PakEntry& a, const PakEntry& b) { return a.pathHash < b.pathHash; });
+
+	PakHeader header = {};
+	header.magic = PAK_MAGIC;
+	header.version = PAK_VERSION;
+	header.entryCount = entries.size();
+	header.tocOffset = AlignUp(offset, alignof(PakEntry));
+	header.namesOffset = header.tocOffset + entries.size() * sizeof(PakEntry);
+	header.namesSize = names.size();
+
+	pak.write(padding.data(), header.tocOffset - offset);
+	pak.write((const char*)entries.data(), entries.size() * sizeof(PakEntry));
+	pak.write(names.data(), names.size());
+	pak.seekp(0);
+	pak.write((const char*)&header, sizeof(PakHeader));
+	pak.close();
+
+	std::error_code error;
+	if (pak.fail())
+	{
+		WARN("Could not write pak file: " + absPath.generic_string());
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+	std::filesystem::rename(temporaryPath, absPath, error);
+	if (error)
+	{
+		WARN("Could not write pak file: " + absPath.generic_string() + ": " + error.message());
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <string_view>
+
+#include "common/types.h"
+#include "os.h"
+#include "thread.h"
+
+#define PAK_MAGIC 0x4b415052 // "RPAK"
+#define PAK_VERSION 2
+/// Entries at least this large start on a multiple of it, smaller entries never straddle one.
+#define PAK_ENTRY_ALIGNMENT (64 * 1024)
+/// Alignment of entries packed together inside one PAK_ENTRY_ALIGNMENT block.
+#define PAK_SMALL_ENTRY_ALIGNMENT 16
+#define PAK_EXTENSION ".rpak"
+/// Uncompressed bytes in each block of a compressed entry.
+#define PAK_BLOCK_SIZE (128 * 1024)
+
+/// Flags describing how a pak entry is stored.
+enum class PakEntryFlag : unsigned int
+{
+	None = 0,
+	/// A null character follows the contents, so they can be handed to parsers expecting C strings.
+	NullTerminated = 1 << 0
+};
+
+/// Compression of a pak entry. Entries are compressed in independent blocks, which are decompressed in parallel and
+/// can be read individually.
+enum class PakCodec : unsigned int
+{
+	None = 0,
+	/// XPRESS, fast to decompress. For data loaded often, such as textures.
+	Fast = 1,
+	/// LZMS, smaller but slower to decompress. For data loaded rarely.
+	Dense = 2
+};
+
+/// Header at the start of a pak file.
+struct PakHeader
+{
+	unsigned int magic;
+	unsigned int version;
+	unsigned int entryCount;
+	unsigned int reserved;
+	/// Offset of the entry table, sorted by path hash.
+	unsigned long long tocOffset;
+	/// Offset of the entry paths, concatenated.
+	unsigned long long namesOffset;
+	unsigned long long namesSize;
+};
+
+/// Table of contents entry of a pak file.
+struct PakEntry
+{
+	unsigned long long pathHash;
+	unsigned long long offset;
+	/// Size of the contents once decompressed.
+	unsigned long long size;
+	/// Bytes taken in the pak, including the block index of compressed entries.
+	unsigned long long storedSize;
+	unsigned int nameOffset;
+	unsigned int nameSize;
+	unsigned int flags;
+	PakCodec codec;
+
+	bool hasFlag(PakEntryFlag flag) const { return flags & (unsigned int)flag; }
+	bool isCompressed() const { return codec != PakCodec::None; }
+};
+
+/// Start of a compressed entry. Followed by blockCount + 1 offsets of the blocks from the start of the entry, so
+/// the size of a block is the difference of consecutive offsets. Blocks that did not compress are stored as is.
+struct PakBlockIndex
+{
+	unsigned int blockSize;
+	unsigned int blockCount;
+};
+
+/// Archive of files read in place from a memory mapping, or decompressed from it.
+class PakFile
+{
+	Ref<MappedFile> m_File;
+	FilePath m_Path;
+	const PakEntry* m_Entries = nullptr;
+	unsigned int m_EntryCount = 0;
+	const char* m_Names = nullptr;
+
+	bool isValidEntry(const PakEntry& entry, unsigned long long fileSize, unsigned long long namesSize) const;
+	const unsigned long long* getBlockOffsets(const PakEntry& entry) const;
+
+public:
+	/// Hash of a root relative path with forward slashes, as stored in the table of contents.
+	static unsigned long long HashPath(const String& path);
+
+	PakFile() = default;
+	PakFile(PakFile&) = delete;
+	~PakFile() = default;
+
+	/// Map the pak at absPath and validate its table of contents. Returns false if it is not a valid pak.
+	bool open(const FilePath& absPath);
+
+	/// Returns nullptr if there is no entry for path.
+	const PakEntry* find(const String& path) const;
+	std::string_view getName(const PakEntry& entry) const;
+	/// View of the contents of an uncompressed entry, valid for as long as the mapped file is alive.
+	std::string_view getContents(const PakEntry& entry) const;
+	/// Decompress a compressed entry into destination, which holds at least entry.size bytes.
+	/// Blocks are decompressed in parallel on threadPool if one is given. Returns false if a block is damaged.
+	bool decompress(const PakEntry& entry, char* destination, ThreadPool* threadPool) const;
+	/// Decompress a single block of a compressed entry into destination, which holds at least the block size.
+	bool decompressBlock(const PakEntry& entry, unsigned int block, char* destination) const;
+
+	const Ref<MappedFile>& getMappedFile() const { return m_File; }
+	const FilePath& getPath() const { return m_Path; }
+	unsigned int getEntryCount() const { return m_EntryCount; }
+	const PakEntry* getEntries() const { return m_Entries; }
+};
+
+/// Builds pak files out of loose files.
+class PakWriter
+{
+	struct Source
+	{
+		String path;
+		unsigned int flags;
+		PakCodec codec;
+	};
+
+	Vector<Source> m_Sources;
+
+public:
+	/// Add the file at the root relative path, to be stored under the same path.
+	void addFile(const String& path, unsigned int flags = (unsigned int)PakEntryFlag::None, PakCodec codec = PakCodec::None);
+	/// Write the pak to absPath, compressing blocks in parallel on threadPool if one is given.
+	/// Returns false if a source file could not be read or the pak could not be written.
+	bool save(const FilePath& absPath, ThreadPool* threadPool = nullptr);
+};
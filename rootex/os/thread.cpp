@@ -1,242 +1,425 @@
 #include "thread.h"
-#include <Windows.h>
+
+#include <algorithm>
+#include <cstdint>
 
 #include "Tracy/Tracy.hpp"
 
-/// The main function which runs on every thread.
-DWORD WINAPI MainLoop(LPVOID voidParameters);
+/// Pool and worker index of the calling thread, -1 for threads outside of any pool.
+static thread_local ThreadPool* s_CurrentPool = nullptr;
+static thread_local int s_CurrentWorker = -1;
 
-Task::Task(const Function<void()>& executionTask)
+Task::Task(const std::function<void()>& executionTask)
     : m_ExecutionTask(executionTask)
 {
 }
 
+void Task::precede(const std::shared_ptr<Task>& other)
+{
+	m_Permissions.push_back(other);
+	other->m_Dependencies++;
+}
+
 void Task::execute()
 {
+	ZoneScoped;
 	m_ExecutionTask();
 }
 
-void ThreadPool::initialize()
+WorkStealingQueue::Buffer::Buffer(long long capacity)
+    : m_Capacity(capacity)
+    , m_Items(new std::atomic<Task*>[capacity])
 {
-	SYSTEM_INFO sysInfo;
-	GetSystemInfo(&sysInfo);
-	m_Threads = sysInfo.dwNumberOfProcessors;
-	m_IsRunning = true;
+}
 
-	InitializeConditionVariable(&m_ConsumerVariable);
-	InitializeConditionVariable(&m_ProducerVariable);
-	InitializeCriticalSection(&m_CriticalSection);
+WorkStealingQueue::WorkStealingQueue(long long capacity)
+{
+	m_Buffers.push_back(std::make_unique<Buffer>(capacity));
+	m_Buffer.store(m_Buffers.back().get(), std::memory_order_relaxed);
+}
 
-	m_DefaultWorkerParameter.m_Thread = 0;
-	m_DefaultWorkerParameter.m_ThreadPool = NULL;
+void WorkStealingQueue::push(Task* task)
+{
+	long long bottom = m_Bottom.load(std::memory_order_relaxed);
+	long long top = m_Top.load(std::memory_order_acquire);
+	Buffer* buffer = m_Buffer.load(std::memory_order_relaxed);
 
+	if (bottom - top > buffer->m_Capacity - 1)
 	{
-		m_TaskQueue.m_Read = 0;
-		m_TaskQueue.m_Write = 0;
-		m_TaskQueue.m_Jobs = 0;
-		m_TasksFinished = 0;
-		m_TasksComplete.m_Jobs = 0;
+		std::unique_ptr<Buffer> grown = std::make_unique<Buffer>(buffer->m_Capacity * 2);
+		for (long long i = top; i < bottom; i++)
+		{
+			grown->put(i, buffer->get(i));
+		}
+		buffer = grown.get();
+		m_Buffers.push_back(std::move(grown));
+		m_Buffer.store(buffer, std::memory_order_release);
 	}
 
-	for (__int32 iThread = 0; iThread < m_Threads; iThread++)
+	buffer->put(bottom, task);
+	std::atomic_thread_fence(std::memory_order_release);
+	m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+}
+
+Task* WorkStealingQueue::pop()
+{
+	long long bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+	Buffer* buffer = m_Buffer.load(std::memory_order_relaxed);
+	m_Bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long top = m_Top.load(std::memory_order_relaxed);
+
+	if (top > bottom)
 	{
-		m_WorkerParameters.push_back(m_DefaultWorkerParameter);
-		m_Handles.push_back(m_DefaultHandle);
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
 	}
 
-	for (__int32 iThread = 0; iThread < m_Threads; iThread++)
+	Task* task = buffer->get(bottom);
+	if (top == bottom)
 	{
-		m_WorkerParameters[iThread].m_Thread = iThread;
-		m_WorkerParameters[iThread].m_ThreadPool = this;
-		m_Handles[iThread] = CreateThread(NULL, 0, MainLoop, &m_WorkerParameters[iThread], 0, 0);
+		// Last item, race against thieves for it
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			task = nullptr;
+		}
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
 	}
+	return task;
 }
 
-DWORD WINAPI MainLoop(LPVOID voidParameters)
+Task* WorkStealingQueue::steal()
 {
-	ZoneScoped;
-	const struct WorkerParameters* parameters = (struct WorkerParameters*)voidParameters;
+	long long top = m_Top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long bottom = m_Bottom.load(std::memory_order_acquire);
 
-	const __int32 iThread = parameters->m_Thread;
-	ThreadPool& threadPool = *parameters->m_ThreadPool;
-
-	__int32 taskId = -1;
-	__int32 increment = 0;
+	if (top >= bottom)
+	{
+		return nullptr;
+	}
 
-	while (true)
+	Buffer* buffer = m_Buffer.load(std::memory_order_acquire);
+	Task* task = buffer->get(top);
+	if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
 	{
-		ZoneNamedN(process, "Main Threadpool loop", true);
+		return nullptr;
+	}
+	return task;
+}
 
-		EnterCriticalSection(&threadPool.m_CriticalSection);
+bool WorkStealingQueue::isEmpty() const
+{
+	return m_Top.load(std::memory_order_relaxed) >= m_Bottom.load(std::memory_order_relaxed);
+}
 
-		/*if (m_ThreadPool.m_TasksComplete.m_Jobs > 0)
-		{
-			m_ThreadPool.m_TasksComplete.ids.push_back(taskId);
-			m_ThreadPool.m_TasksComplete.m_Jobs += increment;
-			m_ThreadPool.m_TasksFinished += increment;
-			increment++;
-			std::cout << increment;
-		}*/
+FrameArena::Block::Block(size_t capacity)
+    : m_Capacity(capacity)
+    , m_Memory(new char[capacity])
+{
+}
+
+FrameArena::FrameArena(size_t blockSize)
+    : m_BlockSize(blockSize)
+    , m_First(new Block(blockSize))
+    , m_Current(m_First)
+{
+}
 
-		WakeAllConditionVariable(&threadPool.m_ProducerVariable);
+FrameArena::~FrameArena()
+{
+	Block* block = m_First;
+	while (block)
+	{
+		Block* next = block->m_Next.load(std::memory_order_relaxed);
+		delete block;
+		block = next;
+	}
+}
 
-		while ((threadPool.m_TaskQueue.m_Jobs == 0) && threadPool.m_IsRunning)
+FrameArena::Block* FrameArena::advance(Block* block, size_t minimumSize)
+{
+	Block* next = block->m_Next.load(std::memory_order_acquire);
+	if (!next)
+	{
+		Block* created = new Block(std::max(m_BlockSize, minimumSize));
+		if (block->m_Next.compare_exchange_strong(next, created, std::memory_order_acq_rel))
 		{
-			SleepConditionVariableCS(&threadPool.m_ConsumerVariable, &threadPool.m_CriticalSection, INFINITE);
+			next = created;
 		}
+		else
+		{
+			// Another thread appended a block first
+			delete created;
+		}
+	}
 
-		if (threadPool.m_IsRunning == false)
+	// Fails harmlessly if another thread has already moved past this block
+	m_Current.compare_exchange_strong(block, next, std::memory_order_acq_rel);
+	return next;
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment)
+{
+	const size_t paddedSize = size + alignment - 1;
+	Block* block = m_Current.load(std::memory_order_acquire);
+	while (true)
+	{
+		if (paddedSize <= block->m_Capacity)
 		{
-			LeaveCriticalSection(&threadPool.m_CriticalSection);
-			return 0;
+			const size_t offset = block->m_Used.fetch_add(paddedSize, std::memory_order_relaxed);
+			if (offset + paddedSize <= block->m_Capacity)
+			{
+				uintptr_t address = (uintptr_t)(block->m_Memory.get() + offset);
+				address = (address + alignment - 1) & ~(uintptr_t)(alignment - 1);
+				return (void*)address;
+			}
 		}
+		block = advance(block, paddedSize);
+	}
+}
 
-		taskId = threadPool.m_TaskQueue.m_QueueJobs[threadPool.m_TaskQueue.m_Read]->m_ID;
-		__int32 readTemp = threadPool.m_TaskQueue.m_Read;
-		threadPool.m_TaskQueue.m_Jobs--;
-		threadPool.m_TaskQueue.m_Read++;
+void FrameArena::reset()
+{
+	for (Block* block = m_First; block; block = block->m_Next.load(std::memory_order_relaxed))
+	{
+		block->m_Used.store(0, std::memory_order_relaxed);
+	}
+	m_Current.store(m_First, std::memory_order_release);
+}
 
-		LeaveCriticalSection(&threadPool.m_CriticalSection);
+size_t FrameArena::getCapacity() const
+{
+	size_t capacity = 0;
+	for (Block* block = m_First; block; block = block->m_Next.load(std::memory_order_acquire))
+	{
+		capacity += block->m_Capacity;
+	}
+	return capacity;
+}
+
+ThreadPool::ThreadPool(int threads)
+{
+	initialize(threads);
+}
+
+ThreadPool::~ThreadPool()
+{
+	shutDown();
+}
 
-		threadPool.m_TaskQueue.m_QueueJobs[readTemp]->execute();
-		threadPool.m_TasksComplete.m_Jobs++;
+void ThreadPool::initialize(int threads)
+{
+	if (threads <= 0)
+	{
+		threads = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+	}
+	m_IsRunning = true;
+
+	for (int i = 0; i < threads; i++)
+	{
+		m_Workers.push_back(std::make_unique<Worker>());
+	}
+	for (int i = 0; i < threads; i++)
+	{
+		m_Workers[i]->m_Thread = std::thread(&ThreadPool::workerLoop, this, i);
 	}
-	return 0;
 }
 
-void ThreadPool::submit(Vector<Ref<Task>>& tasks)
+void ThreadPool::shutDown()
 {
 	join();
+	{
+		std::lock_guard<std::mutex> lock(m_WakeMutex);
+		m_IsRunning = false;
+	}
+	m_WakeCondition.notify_all();
 
-	MasterThread masterThread;
-	masterThread.m_TasksComplete.m_Jobs = 0;
-	masterThread.m_TasksReady.m_Jobs = 0;
-	masterThread.m_TasksReady.m_Read = 0;
-	masterThread.m_TasksReady.m_Write = 0;
-
-	bool isTasksRemaining = true;
+	for (auto& worker : m_Workers)
+	{
+		worker->m_Thread.join();
+	}
+	m_Workers.clear();
+}
 
-	m_TasksFinished = 0;
+void ThreadPool::workerLoop(int workerIndex)
+{
+	s_CurrentPool = this;
+	s_CurrentWorker = workerIndex;
 
+	while (true)
 	{
-		static __int32 idIndex = 0;
-		for (auto iJob : tasks)
+		if (Task* task = findTask())
 		{
-			iJob->m_Dependencies = 0;
-			m_TaskQueue.m_QueueJobs.push_back(iJob);
-			m_TaskQueue.m_QueueJobs[idIndex]->m_ID = idIndex;
-			idIndex++;
+			run(task);
+			continue;
 		}
 
-		/*for (__int32 i_Job = 0; i_Job < tasks.size(); i_Job++)
+		std::unique_lock<std::mutex> lock(m_WakeMutex);
+		m_WakeCondition.wait(lock, [this]() { return m_QueuedTasks.load() > 0 || !m_IsRunning; });
+		if (!m_IsRunning)
 		{
-			for (__int32 i_Permission = 0; i_Permission < tasks[i_Job]->m_Permisions; i_Permission++)
-			{
-				tasks[tasks[i_Job]->i_Permissions[i_Permission]]->m_Dependencies++;
-			}
-		}*/
+			return;
+		}
 	}
+}
 
-	while (isTasksRemaining)
+void ThreadPool::schedule(Task* task)
+{
+	if (s_CurrentPool == this && s_CurrentWorker != -1)
+	{
+		m_Workers[s_CurrentWorker]->m_Queue.push(task);
+	}
+	else
 	{
+		std::lock_guard<std::mutex> lock(m_InjectionMutex);
+		m_InjectionQueue.push_back(task);
+	}
 
-		/*{
-			const __int32 nJobs = master_thread.m_TasksComplete.m_Jobs;
-			for (__int32 i_job = 0; i_job < nJobs; i_job++)
-			{
-				__int32 taskId = master_thread.m_TasksComplete.ids[i_job];
+	m_QueuedTasks++;
+	{
+		// Pairs with the predicate check in workerLoop so a worker about to sleep cannot miss this task
+		std::lock_guard<std::mutex> lock(m_WakeMutex);
+	}
+	m_WakeCondition.notify_one();
+}
 
-				for (__int32 i_Permission = 0; i_Permission < tasks[taskId]->m_Permisions; i_Permission++)
-				{
-					tasks[tasks[taskId]->i_Permissions[i_Permission]]->m_Dependencies--;
-				}
-				master_thread.m_TasksComplete.m_Jobs--;
-			}
-		}*/
+Task* ThreadPool::findTask()
+{
+	Task* task = nullptr;
+	int self = (s_CurrentPool == this) ? s_CurrentWorker : -1;
+
+	if (self != -1)
+	{
+		task = m_Workers[self]->m_Queue.pop();
+	}
+
+	if (!task)
+	{
+		std::lock_guard<std::mutex> lock(m_InjectionMutex);
+		if (!m_InjectionQueue.empty())
 		{
-			__int32 iJob = 0;
-			while (iJob < tasks.size())
-			{
-				if (tasks[iJob]->m_Dependencies == 0)
-				{
-					masterThread.m_TasksReady.m_IDs.push_back(tasks[iJob]->m_ID);
-					masterThread.m_TasksReady.m_Write++;
-					masterThread.m_TasksReady.m_Jobs++;
-					tasks[iJob]->m_Dependencies--;
-				}
-				iJob++;
-			}
+			task = m_InjectionQueue.back();
+			m_InjectionQueue.pop_back();
 		}
+	}
 
-		EnterCriticalSection(&m_CriticalSection);
-
+	if (!task)
+	{
+		const int workerCount = m_Workers.size();
+		const int start = self == -1 ? 0 : self + 1;
+		for (int i = 0; i < workerCount && !task; i++)
 		{
-			__int32 nJobs = masterThread.m_TasksReady.m_Jobs;
-			for (__int32 i_Job = 0; i_Job < nJobs; i_Job++)
+			int victim = (start + i) % workerCount;
+			if (victim != self)
 			{
-				m_TaskQueue.m_QueueJobs[m_TaskQueue.m_Write]->m_ID = masterThread.m_TasksReady.m_IDs[masterThread.m_TasksReady.m_Read];
-				m_TaskQueue.m_Write++;
-				m_TaskQueue.m_Jobs++;
-				m_TasksFinished++;
-				masterThread.m_TasksReady.m_Read++;
-				masterThread.m_TasksReady.m_Jobs--;
+				task = m_Workers[victim]->m_Queue.steal();
 			}
 		}
+	}
+
+	if (task)
+	{
+		m_QueuedTasks--;
+	}
+	return task;
+}
 
-		WakeAllConditionVariable(&m_ConsumerVariable);
+void ThreadPool::run(Task* task)
+{
+	task->execute();
 
-		while ((m_TasksComplete.m_Jobs == 0) && m_IsRunning)
+	for (auto& permission : task->m_Permissions)
+	{
+		if (--permission->m_Dependencies == 0)
 		{
-			SleepConditionVariableCS(&m_ProducerVariable, &m_CriticalSection, INFINITE);
+			schedule(permission.get());
 		}
+	}
 
-		/*{
-			const __int32 nJobs = m_TasksComplete.m_Jobs;
-			for (__int32 i_Job = 0; i_Job < nJobs; i_Job++)
-			{
+	if (task->m_Counter)
+	{
+		task->m_Counter->m_Pending.fetch_sub(1, std::memory_order_acq_rel);
+	}
+	m_OutstandingTasks--;
 
-				master_thread.m_TasksComplete.ids[i_Job] = m_TasksComplete.ids[i_Job];
-				master_thread.m_TasksComplete.m_Jobs++;
-				m_TasksComplete.m_Jobs--;
-			}
-		}*/
+	// Releasing the last reference may destroy the task
+	std::shared_ptr<Task> self = std::move(task->m_Self);
+}
 
-		isTasksRemaining = m_TasksFinished < tasks.size();
+std::shared_ptr<TaskCounter> ThreadPool::submit(const std::vector<std::shared_ptr<Task>>& tasks)
+{
+	std::shared_ptr<TaskCounter> counter(new TaskCounter());
+	counter->m_Pending = tasks.size();
+	m_OutstandingTasks += tasks.size();
 
-		LeaveCriticalSection(&m_CriticalSection);
+	// Roots are found before any is scheduled, since a root finishing early schedules the tasks it was holding back
+	std::vector<Task*> roots;
+	for (auto& task : tasks)
+	{
+		task->m_Counter = counter;
+		task->m_Self = task;
+		if (task->m_Dependencies.load() == 0)
+		{
+			roots.push_back(task.get());
+		}
+	}
+	for (auto& root : roots)
+	{
+		schedule(root);
 	}
-}
 
-bool ThreadPool::isCompleted() const
-{
-	return m_TaskQueue.m_QueueJobs.size() >= m_TasksComplete.m_Jobs;
+	return counter;
 }
 
-void ThreadPool::join() const
+void ThreadPool::parallelFor(size_t first, size_t last, size_t grainSize, const std::function<void(size_t, size_t)>& body)
 {
-	while (!isCompleted())
+	if (first >= last)
+	{
+		return;
+	}
+	grainSize = std::max<size_t>(grainSize, 1);
+	if (last - first <= grainSize)
 	{
-		;
+		body(first, last);
+		return;
 	}
+
+	std::vector<std::shared_ptr<Task>> chunks;
+	for (size_t begin = first; begin < last; begin += grainSize)
+	{
+		size_t end = std::min(begin + grainSize, last);
+		chunks.push_back(std::make_shared<Task>([&body, begin, end]() { body(begin, end); }));
+	}
+	wait(submit(chunks));
 }
 
-void ThreadPool::shutDown()
+void ThreadPool::wait(const std::shared_ptr<TaskCounter>& counter)
+{
+	waitUntil([&counter]() { return counter->isDone(); });
+}
+
+void ThreadPool::waitUntil(const std::function<bool()>& condition)
 {
-	EnterCriticalSection(&this->m_CriticalSection);
+	while (!condition())
 	{
-		m_IsRunning = false;
+		if (Task* task = findTask())
+		{
+			run(task);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
 	}
-	LeaveCriticalSection(&this->m_CriticalSection);
-	WakeAllConditionVariable(&this->m_ConsumerVariable);
-	WaitForMultipleObjects(m_Threads, m_Handles.data(), TRUE, INFINITE);
 }
 
-ThreadPool::ThreadPool()
+bool ThreadPool::isCompleted() const
 {
-	initialize();
+	return m_OutstandingTasks.load() == 0;
 }
 
-ThreadPool::~ThreadPool()
+void ThreadPool::join()
 {
-	shutDown();
+	waitUntil([this]() { return isCompleted(); });
 }
@@ -1,98 +1,179 @@
 #pragma once
 
-#include "common/common.h"
+// Kept to the standard library so the job system builds on any platform
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
-#include <Windows.h>
-
-/// Interface for spawning and maintenance of threads.
 class ThreadPool;
 
-/// Defines jobs to be run on threads.
-class Task
+/// Number of tasks of a submission which have not finished yet. Reaches zero once all of them have run.
+class TaskCounter
 {
+	std::atomic<int> m_Pending = 0;
+
+	friend class ThreadPool;
+
 public:
-	__int32 m_ID;
-	__int32 m_Dependencies;
-	Vector<__int32> m_Permissions;
-	Function<void()> m_ExecutionTask;
+	TaskCounter() = default;
+	TaskCounter(TaskCounter&) = delete;
+	~TaskCounter() = default;
+
+	int getPending() const { return m_Pending.load(std::memory_order_acquire); }
+	bool isDone() const { return getPending() == 0; }
+};
+
+/// Defines jobs to be run on threads. Tasks form a graph through explicit dependencies and run once all the tasks
+/// they depend on have finished.
+class Task
+{
+	/// Number of unfinished tasks this task waits on.
+	std::atomic<int> m_Dependencies = 0;
+	/// Tasks which wait on this task to finish.
+	std::vector<std::shared_ptr<Task>> m_Permissions;
+	std::function<void()> m_ExecutionTask;
+	std::shared_ptr<TaskCounter> m_Counter;
+	/// Keeps the task alive from submission until it has run.
+	std::shared_ptr<Task> m_Self;
 
-	Task(const Function<void()>& executionTask);
-	Task(const Task&) = default;
+	friend class ThreadPool;
+
+public:
+	Task(const std::function<void()>& executionTask);
+	Task(const Task&) = delete;
 	~Task() = default;
 
+	/// Make other run only after this task has finished. Call before submitting either task.
+	void precede(const std::shared_ptr<Task>& other);
+
 	void execute();
 };
 
-/// Worker thread parameters.
-struct WorkerParameters
+/// Chase-Lev deque of tasks. The owning worker pushes and pops at the bottom, other threads steal from the top.
+class WorkStealingQueue
 {
-	__int32 m_Thread;
-	ThreadPool* m_ThreadPool;
-};
+	struct Buffer
+	{
+		long long m_Capacity;
+		std::unique_ptr<std::atomic<Task*>[]> m_Items;
 
-/// A queue of jobs.
-struct TaskQueue
-{
-	__int32 m_Jobs;
-	unsigned __int32 m_Write;
-	unsigned __int32 m_Read;
-	Vector<Ref<Task>> m_QueueJobs;
-};
+		Buffer(long long capacity);
 
-/// Contains the information of completed jobs.
-struct TaskComplete
-{
-	__int32 m_Jobs;
-	Vector<__int32> m_IDs;
-};
+		Task* get(long long index) const { return m_Items[index & (m_Capacity - 1)].load(std::memory_order_relaxed); }
+		void put(long long index, Task* task) { m_Items[index & (m_Capacity - 1)].store(task, std::memory_order_relaxed); }
+	};
 
-/// Contains information of jobs ready for execution.
-struct TaskReady
-{
-	__int32 m_Jobs;
-	unsigned __int32 m_Write;
-	unsigned __int32 m_Read;
-	Vector<__int32> m_IDs;
+	std::atomic<long long> m_Top = 0;
+	std::atomic<long long> m_Bottom = 0;
+	std::atomic<Buffer*> m_Buffer;
+	/// Buffers replaced on growth, kept alive since thieves may still be reading them.
+	std::vector<std::unique_ptr<Buffer>> m_Buffers;
+
+public:
+	WorkStealingQueue(long long capacity = 1024);
+	WorkStealingQueue(WorkStealingQueue&) = delete;
+	~WorkStealingQueue() = default;
+
+	/// Only to be called by the owning thread.
+	void push(Task* task);
+	/// Only to be called by the owning thread. Returns nullptr if empty.
+	Task* pop();
+	/// Safe to call from any thread. Returns nullptr if empty or if the steal lost a race.
+	Task* steal();
+	bool isEmpty() const;
 };
 
-/// Master thread to communicate with and maintain worker threads.
-struct MasterThread
+/// Lock-free bump allocator for memory that only lives until the next reset. Blocks are kept across resets so an arena
+/// which has warmed up stops allocating. Allocation is safe from any thread, reset is not.
+class FrameArena
 {
-	TaskComplete m_TasksComplete;
-	TaskReady m_TasksReady;
+	struct Block
+	{
+		size_t m_Capacity;
+		std::unique_ptr<char[]> m_Memory;
+		std::atomic<size_t> m_Used = 0;
+		std::atomic<Block*> m_Next = nullptr;
+
+		Block(size_t capacity);
+	};
+
+	size_t m_BlockSize;
+	Block* m_First;
+	std::atomic<Block*> m_Current;
+
+	/// Return the block after block, appending one of at least minimumSize bytes if there is none.
+	Block* advance(Block* block, size_t minimumSize);
+
+public:
+	FrameArena(size_t blockSize);
+	FrameArena(FrameArena&) = delete;
+	~FrameArena();
+
+	/// Returns uninitialized memory valid until the next reset. alignment should be a power of 2.
+	void* allocate(size_t size, size_t alignment);
+	/// Make all memory available again. Objects left in the arena are not destructed.
+	void reset();
+
+	/// Bytes reserved across all blocks.
+	size_t getCapacity() const;
 };
 
+/// Work stealing job system built on std::thread. Every worker owns a deque of tasks, idle workers steal from the others.
+/// Tasks submitted from outside the pool go through a shared injection queue.
 class ThreadPool
 {
-	bool m_IsRunning;
-	__int32 m_Threads;
-	Vector<WorkerParameters> m_WorkerParameters;
-	WorkerParameters m_DefaultWorkerParameter;
-	Vector<HANDLE> m_Handles;
-	HANDLE m_DefaultHandle = 0;
-	CONDITION_VARIABLE m_ConsumerVariable;
-	CONDITION_VARIABLE m_ProducerVariable;
-	CRITICAL_SECTION m_CriticalSection;
-
-	__int32 m_TasksFinished;
-	TaskQueue m_TaskQueue;
-	TaskComplete m_TasksComplete;
-
-	friend DWORD WINAPI MainLoop(LPVOID voidParameters);
-
-	void initialize();
+	struct Worker
+	{
+		WorkStealingQueue m_Queue;
+		std::thread m_Thread;
+	};
+
+	std::vector<std::unique_ptr<Worker>> m_Workers;
+	std::atomic<bool> m_IsRunning = false;
+
+	std::mutex m_InjectionMutex;
+	std::vector<Task*> m_InjectionQueue;
+
+	std::mutex m_WakeMutex;
+	std::condition_variable m_WakeCondition;
+	/// Tasks ready to run but not yet picked up by a thread.
+	std::atomic<int> m_QueuedTasks = 0;
+	/// Tasks submitted and not yet finished.
+	std::atomic<int> m_OutstandingTasks = 0;
+
+	void workerLoop(int workerIndex);
+	/// Queue a task whose dependencies have all finished.
+	void schedule(Task* task);
+	/// Find a ready task from the calling thread's own deque, the injection queue or other workers.
+	Task* findTask();
+	void run(Task* task);
+
+	void initialize(int threads);
 	void shutDown();
 
 public:
-	ThreadPool();
+	/// Passing 0 threads uses one worker per hardware thread, less the calling thread.
+	ThreadPool(int threads = 0);
 	ThreadPool(ThreadPool&) = delete;
 	~ThreadPool();
 
-	/// To submit a job to the jobs queue.
-	void submit(Vector<Ref<Task>>& tasks);
-
+	/// Submit a graph of tasks. Tasks wait on the tasks they were made to depend on through Task::precede().
+	/// Returns a counter which reaches zero once all submitted tasks have finished.
+	std::shared_ptr<TaskCounter> submit(const std::vector<std::shared_ptr<Task>>& tasks);
+	/// Run body(begin, end) over [first, last) in chunks of grainSize spread across the pool. Returns once all chunks are done.
+	void parallelFor(size_t first, size_t last, size_t grainSize, const std::function<void(size_t, size_t)>& body);
+	/// Block until counter reaches zero, running pending tasks on the calling thread meanwhile.
+	void wait(const std::shared_ptr<TaskCounter>& counter);
+	/// Block until condition returns true, running pending tasks on the calling thread meanwhile.
+	void waitUntil(const std::function<bool()>& condition);
+
+	int getWorkerCount() const { return m_Workers.size(); }
 	/// Returns true if all tasks have been completed
 	bool isCompleted() const;
 	/// Returns when all the tasks have been completed
-	void join() const;
+	void join();
 };
@@ -0,0 +1,143 @@
+#include "virtual_file_system.h"
+
+#include "common/common.h"
+
+FileView::FileView(const Ref<MappedFile>& file, std::string_view contents, bool isNullTerminated)
+    : m_File(file)
+    , m_Contents(contents)
+    , m_IsValid(true)
+    , m_IsNullTerminated(isNullTerminated)
+{
+}
+
+FileView::FileView(const Ref<FileBuffer>& buffer, size_t size, bool isNullTerminated)
+    : m_Buffer(buffer)
+    , m_Contents(buffer->data(), size)
+    , m_IsValid(true)
+    , m_IsNullTerminated(isNullTerminated)
+{
+}
+
+String VirtualFileSystem::NormalizePath(const String& path)
+{
+	FilePath normalizedPath = FilePath(path).lexically_normal();
+	if (normalizedPath.is_absolute())
+	{
+		normalizedPath = OS::GetRootRelativePath(normalizedPath.generic_string());
+	}
+	return normalizedPath.generic_string();
+}
+
+const PakFile* VirtualFileSystem::FindEntry(const String& normalizedPath, const PakEntry*& entry)
+{
+	for (auto pak = s_Paks.rbegin(); pak != s_Paks.rend(); pak++)
+	{
+		entry = (*pak)->find(normalizedPath);
+		if (entry)
+		{
+			return pak->get();
+		}
+	}
+	return nullptr;
+}
+
+void VirtualFileSystem::Initialize(ThreadPool* threadPool)
+{
+	s_ThreadPool = threadPool;
+
+	std::error_code error;
+	Vector<FilePath> pakPaths;
+	for (auto& file : std::filesystem::directory_iterator(OS::s_RootDirectory, error))
+	{
+		if (file.is_regular_file() && file.path().extension() == PAK_EXTENSION)
+		{
+			pakPaths.push_back(file.path());
+		}
+	}
+
+	std::sort(pakPaths.begin(), pakPaths.end());
+	for (auto& pakPath : pakPaths)
+	{
+		Mount(pakPath.generic_string());
+	}
+}
+
+bool VirtualFileSystem::Mount(const String& pakPath)
+{
+	Ptr<PakFile> pak(new PakFile());
+	if (!pak->open(OS::GetAbsolutePath(pakPath)))
+	{
+		return false;
+	}
+
+	PRINT("Mounted " + pakPath + " (" + std::to_string(pak->getEntryCount()) + " files)");
+	s_Paks.push_back(std::move(pak));
+	return true;
+}
+
+void VirtualFileSystem::UnmountAll()
+{
+	s_Paks.clear();
+}
+
+FileView VirtualFileSystem::LoadFile(const String& path)
+{
+	const String normalizedPath = NormalizePath(path);
+	const PakEntry* entry = nullptr;
+	if (const PakFile* pak = FindEntry(normalizedPath, entry))
+	{
+		const bool isNullTerminated = entry->hasFlag(PakEntryFlag::NullTerminated);
+		if (!entry->isCompressed())
+		{
+			return FileView(pak->getMappedFile(), pak->getContents(*entry), isNullTerminated);
+		}
+
+		// The terminator is not stored in compressed entries
+		Ref<FileBuffer> buffer(new FileBuffer(entry->size + (isNullTerminated ? 1 : 0), '\0'));
+		if (!pak->decompress(*entry, buffer->data(), s_ThreadPool))
+		{
+			ERR("OS: File IO error: " + normalizedPath + " could not be decompressed");
+			return FileView();
+		}
+		return FileView(buffer, entry->size, isNullTerminated);
+	}
+
+	if (!OS::IsExists(normalizedPath))
+	{
+		ERR("OS: File IO error: " + normalizedPath + " does not exist");
+		return FileView();
+	}
+
+	// Empty files cannot be mapped
+	Ref<MappedFile> looseFile = OS::MapFile(normalizedPath);
+	if (!looseFile)
+	{
+		std::error_code error;
+		if (std::filesystem::file_size(OS::GetAbsolutePath(normalizedPath), error) == 0 && !error)
+		{
+			return FileView(nullptr, std::string_view(), false);
+		}
+		ERR("OS: File IO error: " + normalizedPath + " could not be read");
+		return FileView();
+	}
+	return FileView(looseFile, std::string_view(looseFile->getData(), looseFile->getSize()), false);
+}
+
+bool VirtualFileSystem::IsExists(const String& path)
+{
+	const PakEntry* entry = nullptr;
+	return FindEntry(NormalizePath(path), entry) || OS::IsExists(path);
+}
+
+FileTimePoint VirtualFileSystem::GetFileLastChangedTime(const String& path)
+{
+	const PakEntry* entry = nullptr;
+	if (const PakFile* pak = FindEntry(NormalizePath(path), entry))
+	{
+		// Packed files change only when their pak is rebuilt
+		std::error_code error;
+		FileTimePoint pakTime = std::filesystem::last_write_time(pak->getPath(), error);
+		return error ? FileTimePoint::clock::now() : pakTime;
+	}
+	return OS::GetFileLastChangedTime(path);
+}
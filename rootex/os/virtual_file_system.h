@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string_view>
+
+#include "common/types.h"
+#include "os.h"
+#include "pak_file.h"
+
+/// Contents of a file read through the VirtualFileSystem. Views memory mapped from a pak or from the loose file,
+/// or the buffer a compressed pak entry was decompressed into, and keeps it alive for as long as the view exists.
+class FileView
+{
+	Ref<MappedFile> m_File;
+	Ref<FileBuffer> m_Buffer;
+	std::string_view m_Contents;
+	bool m_IsValid = false;
+	bool m_IsNullTerminated = false;
+
+public:
+	FileView() = default;
+	FileView(const Ref<MappedFile>& file, std::string_view contents, bool isNullTerminated);
+	/// View of the first size bytes of buffer.
+	FileView(const Ref<FileBuffer>& buffer, size_t size, bool isNullTerminated);
+
+	/// False if the file could not be found or read.
+	bool isValid() const { return m_IsValid; }
+	/// If a null character follows the contents.
+	bool isNullTerminated() const { return m_IsNullTerminated; }
+
+	std::string_view getContents() const { return m_Contents; }
+	const char* getData() const { return m_Contents.data(); }
+	size_t getSize() const { return m_Contents.size(); }
+};
+
+/// Resolves root relative paths against the mounted paks first, newest mount first, and then against loose files.
+/// Mount paks before any file is read through it, mounting is not synchronised with reads.
+class VirtualFileSystem
+{
+	static inline Vector<Ptr<PakFile>> s_Paks;
+	static inline ThreadPool* s_ThreadPool = nullptr;
+
+	static String NormalizePath(const String& path);
+	/// Returns the pak holding path and its entry in it, or nullptr.
+	static const PakFile* FindEntry(const String& normalizedPath, const PakEntry*& entry);
+
+public:
+	VirtualFileSystem() = delete;
+
+	/// Mount every pak found in the root directory. Compressed entries are decompressed on threadPool.
+	static void Initialize(ThreadPool* threadPool);
+	static bool Mount(const String& pakPath);
+	static void UnmountAll();
+
+	static FileView LoadFile(const String& path);
+	static bool IsExists(const String& path);
+	static FileTimePoint GetFileLastChangedTime(const String& path);
+};
@@ -5,6 +5,7 @@
 
 #include "scene.h"
 #include "scene_loader.h"
+#include "prefab_cache.h"
 #include "ecs_factory.h"
 #include "script.h"
 #include "components/audio/audio_component.h"
@@ -34,8 +35,16 @@
 #include "core/resource_files/collision_model_resource_file.h"
 #include "core/resource_files/text_resource_file.h"
 #include "core/resource_files/particle_effect_resource_file.h"
+#include "core/cooked_cache.h"
 #include "event_manager.h"
 
+#define LUA_CHUNK_COOKED_EXTENSION ".luac"
+#define LUA_CHUNK_COOKED_MAGIC 0x41554c52 // "RLUA"
+/// Bump when the way chunks are compiled changes. The Lua version is part of the key, bytecode does not carry over.
+#define LUA_CHUNK_COOKED_VERSION 1
+/// Chunk name of evaluated expressions, shown in their error messages.
+#define LUA_EXPRESSION_CHUNK_NAME "=expression"
+
 extern "C" int luaopen_lpeg(lua_State* L);
 
 int HandleLuaException(lua_State* L, sol::optional<const std::exception&> maybeException, sol::string_view description)
@@ -84,6 +93,160 @@ LuaInterpreter* LuaInterpreter::GetSingleton()
 	return &singleton;
 }
 
+/// The chunk name is compiled into the bytecode, so the same source loaded as different files is compiled once per file.
+static unsigned long long GetChunkKey(const String& source, const String& chunkName)
+{
+	return CookedCache::HashBuffer(source.data(), source.size()) ^ std::hash<String>()(chunkName);
+}
+
+bool LuaInterpreter::compile(const String& source, const String& chunkName, String& bytecode)
+{
+	sol::load_result loaded = m_Lua.load(source, chunkName, sol::load_mode::text);
+	if (!loaded.valid())
+	{
+		sol::error error = loaded;
+		WARN(error.what());
+		return false;
+	}
+
+	sol::protected_function dump = m_Lua["string"]["dump"];
+	sol::protected_function_result dumped = dump(loaded.get<sol::protected_function>());
+	if (!dumped.valid())
+	{
+		sol::error error = dumped;
+		WARN(error.what());
+		return false;
+	}
+	bytecode = dumped.get<String>();
+	return true;
+}
+
+sol::protected_function LuaInterpreter::loadBytecode(const String& bytecode, const String& chunkName)
+{
+	sol::load_result loaded = m_Lua.load(bytecode, chunkName, sol::load_mode::binary);
+	if (!loaded.valid())
+	{
+		sol::error error = loaded;
+		WARN(error.what());
+		return sol::lua_nil;
+	}
+	return loaded.get<sol::protected_function>();
+}
+
+sol::protected_function LuaInterpreter::loadFile(const String& path)
+{
+	Ref<LuaTextResourceFile> file = ResourceLoader::CreateLuaTextResourceFile(path);
+	if (!file)
+	{
+		WARN("Could not load Lua file: " + path);
+		return sol::lua_nil;
+	}
+
+	const String source = file->getString();
+	const String chunkName = "@" + path;
+	const unsigned long long key = GetChunkKey(source, chunkName);
+	auto&& found = m_Bytecode.find(key);
+	if (found == m_Bytecode.end())
+	{
+		const unsigned long long sourceHash = CookedCache::HashBuffer(source.data(), source.size());
+		String bytecode;
+		if (Ref<MappedFile> cookedFile = CookedCache::Open(path, LUA_CHUNK_COOKED_EXTENSION, LUA_CHUNK_COOKED_MAGIC, LUA_CHUNK_COOKED_VERSION, LUA_VERSION_NUM))
+		{
+			// The file may have been edited in memory since it was last saved
+			CookedReader reader = CookedCache::GetReader(*cookedFile);
+			if (reader.read<unsigned long long>() == sourceHash)
+			{
+				bytecode = reader.readString();
+			}
+			if (!reader.isValid())
+			{
+				bytecode.clear();
+			}
+		}
+
+		if (bytecode.empty())
+		{
+			if (!compile(source, chunkName, bytecode))
+			{
+				return sol::lua_nil;
+			}
+
+			// Files only found in packs are compiled again every run
+			if (OS::IsExists(path))
+			{
+				CookedWriter writer;
+				writer.write(sourceHash);
+				writer.writeString(bytecode);
+				CookedCache::Save(path, LUA_CHUNK_COOKED_EXTENSION, LUA_CHUNK_COOKED_MAGIC, LUA_CHUNK_COOKED_VERSION, LUA_VERSION_NUM, writer);
+			}
+		}
+		auto&& loaded = m_FileChunkKeys.find(path);
+		if (loaded != m_FileChunkKeys.end())
+		{
+			m_Bytecode.erase(loaded->second);
+		}
+		m_FileChunkKeys[path] = key;
+		found = m_Bytecode.emplace(key, bytecode).first;
+	}
+	return loadBytecode(found->second, chunkName);
+}
+
+sol::object LuaInterpreter::evaluate(const String& expression)
+{
+	const size_t first = expression.find_first_not_of(" \t\r\n");
+	if (first == String::npos)
+	{
+		return sol::make_object(m_Lua, sol::lua_nil);
+	}
+	const String literal = expression.substr(first, expression.find_last_not_of(" \t\r\n") - first + 1);
+
+	// Most expressions are plain literals, which are parsed the way Lua would without compiling a chunk
+	if (literal == "true" || literal == "false")
+	{
+		return sol::make_object(m_Lua, literal == "true");
+	}
+	if (literal == "nil")
+	{
+		return sol::make_object(m_Lua, sol::lua_nil);
+	}
+	if (lua_stringtonumber(m_Lua.lua_state(), literal.c_str()) != 0)
+	{
+		return sol::stack::pop<sol::object>(m_Lua.lua_state());
+	}
+	const char quote = literal.front();
+	if (literal.size() >= 2 && (quote == '"' || quote == '\'') && literal.back() == quote && literal.find_first_of(String("\\\n") + quote, 1) == literal.size() - 1)
+	{
+		return sol::make_object(m_Lua, literal.substr(1, literal.size() - 2));
+	}
+
+	const String source = "return " + expression;
+	const unsigned long long key = GetChunkKey(source, LUA_EXPRESSION_CHUNK_NAME);
+	auto&& found = m_Bytecode.find(key);
+	if (found == m_Bytecode.end())
+	{
+		String bytecode;
+		if (!compile(source, LUA_EXPRESSION_CHUNK_NAME, bytecode))
+		{
+			return sol::make_object(m_Lua, sol::lua_nil);
+		}
+		found = m_Bytecode.emplace(key, bytecode).first;
+	}
+
+	sol::protected_function chunk = loadBytecode(found->second, LUA_EXPRESSION_CHUNK_NAME);
+	if (!chunk.valid())
+	{
+		return sol::make_object(m_Lua, sol::lua_nil);
+	}
+	sol::protected_function_result result = chunk();
+	if (!result.valid())
+	{
+		sol::error error = result;
+		WARN(error.what());
+		return sol::make_object(m_Lua, sol::lua_nil);
+	}
+	return result.get<sol::object>();
+}
+
 void LuaInterpreter::runScripts()
 {
 	static bool called = false;
@@ -179,17 +342,25 @@ void LuaInterpreter::registerTypes()
 		matrix["Identity"] = sol::var(Matrix::Identity);
 	}
 	{
-		sol::usertype<Event> event = rootex.new_usertype<Event>("Event", sol::constructors<Event(const Event::Type, const Variant)>());
-		event["getType"] = &Event::getType;
+		sol::usertype<EventType> eventType = rootex.new_usertype<EventType>(
+		    "EventType",
+		    sol::constructors<EventType(const String&)>(),
+		    sol::meta_function::equal_to, [](const EventType& l, const EventType& r) { return l == r; },
+		    sol::meta_function::to_string, [](const EventType& type) { return String(type.getName()); });
+		eventType["getName"] = [](const EventType& type) { return String(type.getName()); };
+	}
+	{
+		sol::usertype<Event> event = rootex.new_usertype<Event>("Event", sol::constructors<Event(const String&, const Variant&)>());
+		event["getType"] = [](const Event* e) { return String(e->getType().getName()); };
 		event["getData"] = &Event::getData;
 	}
 	{
 		rootex["CallEvent"] = [](const Event& event) { EventManager::GetSingleton()->call(event); };
-		rootex["Call"] = [](const Event::Type& type, const Variant& data) { EventManager::GetSingleton()->call(type, data); };
+		rootex["Call"] = [](const String& type, const Variant& data) { EventManager::GetSingleton()->call(type, data); };
 		rootex["DeferredCallEvent"] = [](const Ref<Event>& event) { EventManager::GetSingleton()->deferredCall(event); };
 		rootex["ReturnCallEvent"] = [](const Event& event) { return EventManager::GetSingleton()->returnCall(event); };
-		rootex["Bind"] = [this](const Event::Type& event, sol::function function) { m_Binder.bind(event, function); };
-		rootex["Unbind"] = [this](const Event::Type& event) { m_Binder.unbind(event); };
+		rootex["Bind"] = [this](const String& event, sol::function function) { m_Binder.bind(event, function); };
+		rootex["Unbind"] = [this](const String& event) { m_Binder.unbind(event); };
 	}
 	{
 		sol::usertype<Atomic<int>> atomicInt = rootex.new_usertype<Atomic<int>>("AtomicInt", sol::constructors<Atomic<int>(), Atomic<int>(int)>());
@@ -198,19 +369,29 @@ void LuaInterpreter::registerTypes()
 		rootex["LoadScene"] = [](const String& sceneFile, const sol::table& arguments) { SceneLoader::GetSingleton()->loadScene(sceneFile, arguments.as<Vector<String>>()); };
 		rootex["PreloadScene"] = [](const String& sceneFile, Atomic<int>& progress) { return SceneLoader::GetSingleton()->preloadScene(sceneFile, progress); };
 		rootex["LoadPreloadedScene"] = [](const String& sceneFile, const sol::nested<Vector<String>>& arguments) { SceneLoader::GetSingleton()->loadPreloadedScene(sceneFile, arguments.value()); };
+		rootex["StreamScene"] = [](const String& sceneFile, Scene* parent) { SceneLoader::GetSingleton()->streamScene(sceneFile, parent); };
+		rootex["IsStreamingScenes"] = []() { return SceneLoader::GetSingleton()->isStreaming(); };
+		rootex["SetSceneStreamingBudget"] = [](float milliseconds) { SceneLoader::GetSingleton()->setStreamingBudget(milliseconds); };
+		rootex["SpawnMany"] = [](const String& sceneFile, Scene* parent, int count, const sol::nested<Vector<Matrix>>& transforms) { return PrefabCache::GetSingleton()->spawnMany(sceneFile, parent, count, transforms.value()); };
+		rootex["Spawn"] = [](const String& sceneFile, Scene* parent) -> Scene* {
+			const Vector<Scene*>& spawned = PrefabCache::GetSingleton()->spawnMany(sceneFile, parent, 1);
+			return spawned.empty() ? nullptr : spawned.front();
+		};
+		rootex["Despawn"] = [](Scene* scene) { PrefabCache::GetSingleton()->despawn(scene); };
 		rootex["GetSceneArguments"] = []() { return SceneLoader::GetSingleton()->getArguments(); };
 		rootex["GetCurrentScene"] = []() { return SceneLoader::GetSingleton()->getCurrentScene(); };
 	}
 	{
 		sol::usertype<InputManager> inputManager = rootex.new_usertype<InputManager>("Input");
 		inputManager["SetEnabled"] = &InputManager::SetEnabled;
-		inputManager["MapBool"] = &InputManager::MapBool;
-		inputManager["MapFloat"] = &InputManager::MapFloat;
-		inputManager["IsPressed"] = &InputManager::IsPressed;
-		inputManager["WasPressed"] = &InputManager::WasPressed;
-		inputManager["GetFloat"] = &InputManager::GetFloat;
-		inputManager["GetFloatDelta"] = &InputManager::GetFloatDelta;
-		inputManager["Unmap"] = &InputManager::Unmap;
+		inputManager["MapBool"] = [](const String& action, Device device, DeviceButtonID button) { InputManager::MapBool(action, device, button); };
+		inputManager["MapFloat"] = [](const String& action, Device device, DeviceButtonID button) { InputManager::MapFloat(action, device, button); };
+		// Queried every frame, so these also take an RTX.EventType made once to skip interning the name on each call
+		inputManager["IsPressed"] = sol::overload(&InputManager::IsPressed, [](const String& action) { return InputManager::IsPressed(action); });
+		inputManager["WasPressed"] = sol::overload(&InputManager::WasPressed, [](const String& action) { return InputManager::WasPressed(action); });
+		inputManager["GetFloat"] = sol::overload(&InputManager::GetFloat, [](const String& action) { return InputManager::GetFloat(action); });
+		inputManager["GetFloatDelta"] = sol::overload(&InputManager::GetFloatDelta, [](const String& action) { return InputManager::GetFloatDelta(action); });
+		inputManager["Unmap"] = [](const String& action) { InputManager::Unmap(action); };
 		inputManager["GetMousePosition"] = &InputManager::GetMousePosition;
 	}
 	{
@@ -228,7 +409,6 @@ void LuaInterpreter::registerTypes()
 	}
 	{
 		sol::usertype<ResourceFile> resourceFile = rootex.new_usertype<ResourceFile>("ResourceFile");
-		resourceFile["isDirty"] = &ResourceFile::isDirty;
 		resourceFile["getPath"] = [](ResourceFile& f) { return f.getPath().string(); };
 		resourceFile["getType"] = &ResourceFile::getType;
 	}
@@ -335,7 +515,7 @@ void LuaInterpreter::registerTypes()
 		entity["getScene"] = &Entity::getScene;
 		entity["getName"] = &Entity::getName;
 		entity["setScript"] = &Entity::setScript;
-		entity["bind"] = &Entity::bind;
+		entity["bind"] = [](Entity* entity, const String& event, const sol::function& function) { entity->bind(event, function); };
 	}
 	{
 		sol::usertype<Component> component = rootex.new_usertype<Component>("Component",
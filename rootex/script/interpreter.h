@@ -35,6 +35,10 @@ class LuaInterpreter
 	EventBinder<LuaInterpreter> m_Binder;
 
 	sol::state m_Lua;
+	/// Compiled chunks as string.dump bytecode, keyed by the hash of their chunk name and source.
+	HashMap<unsigned long long, String> m_Bytecode;
+	/// Key in m_Bytecode of the source each file was last loaded from, so edited files do not keep old versions.
+	HashMap<String, unsigned long long> m_FileChunkKeys;
 
 	LuaInterpreter();
 	LuaInterpreter(LuaInterpreter&) = delete;
@@ -43,8 +47,19 @@ class LuaInterpreter
 	void registerTypes();
 	void runScripts();
 
+	/// Compile source to bytecode. Returns false and logs the error if it does not compile.
+	bool compile(const String& source, const String& chunkName, String& bytecode);
+	sol::protected_function loadBytecode(const String& bytecode, const String& chunkName);
+
 public:
 	static LuaInterpreter* GetSingleton();
 
 	sol::state& getLuaState() { return m_Lua; }
+
+	/// Load the main chunk of a Lua file without running it, reusing bytecode compiled earlier from the same source
+	/// in memory or in the cooked cache. Returns nil if the file could not be loaded.
+	sol::protected_function loadFile(const String& path);
+	/// Evaluate a Lua expression. Plain literals are parsed directly and other expressions run cached chunks.
+	/// Returns nil if the expression could not be evaluated.
+	sol::object evaluate(const String& expression);
 };
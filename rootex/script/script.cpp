@@ -19,7 +19,18 @@ bool Script::setup(Entity* entity)
 	bool status = true;
 	try
 	{
-		sol::table scriptClass = LuaInterpreter::GetSingleton()->getLuaState().script_file(m_ScriptFile);
+		sol::protected_function chunk = LuaInterpreter::GetSingleton()->loadFile(m_ScriptFile);
+		if (!chunk.valid())
+		{
+			throw std::runtime_error("Could not load script: " + m_ScriptFile);
+		}
+		sol::protected_function_result result = chunk();
+		if (!result.valid())
+		{
+			sol::error e = result;
+			throw e;
+		}
+		sol::table scriptClass = result;
 		m_ScriptInstance = scriptClass["new"](scriptClass, entity);
 	}
 	catch (std::exception e)
@@ -66,7 +77,7 @@ void Script::evaluateOverrides()
 			sol::optional<sol::object> currVar = m_ScriptInstance["exports"][varName];
 			if (currVar)
 			{
-				m_ScriptInstance["exports"][varName] = LuaInterpreter::GetSingleton()->getLuaState().script("return " + lua);
+				m_ScriptInstance["exports"][varName] = LuaInterpreter::GetSingleton()->evaluate(lua);
 			}
 		}
 	}
@@ -0,0 +1,81 @@
+#include "thread.h"
+
+#include <iostream>
+
+/// Submissions made of tasks that do no work, so roots finish while the rest of the graph is still being submitted.
+#define THREAD_POOL_TEST_ITERATIONS 20000
+
+static int s_Failures = 0;
+
+static void Check(bool condition, const char* what, int iteration)
+{
+	if (!condition)
+	{
+		std::cerr << "Failed at iteration " << iteration << ": " << what << std::endl;
+		s_Failures++;
+	}
+}
+
+/// a before b before c, submitted together.
+static void TestChain(ThreadPool& pool, int iteration)
+{
+	std::atomic<int> runs[3] = { 0, 0, 0 };
+	std::vector<std::shared_ptr<Task>> tasks;
+	for (int i = 0; i < 3; i++)
+	{
+		tasks.push_back(std::make_shared<Task>([&runs, i]() { runs[i]++; }));
+	}
+	tasks[0]->precede(tasks[1]);
+	tasks[1]->precede(tasks[2]);
+
+	std::shared_ptr<TaskCounter> counter = pool.submit(tasks);
+	pool.wait(counter);
+	for (int i = 0; i < 3; i++)
+	{
+		Check(runs[i].load() == 1, "chained task did not run exactly once", iteration);
+	}
+	Check(counter->getPending() == 0, "counter did not end at zero", iteration);
+}
+
+/// Two roots both preceding one task, which may only run once both roots are done.
+static void TestJoin(ThreadPool& pool, int iteration)
+{
+	std::atomic<int> rootRuns = 0;
+	std::atomic<int> joinRuns = 0;
+	std::atomic<int> rootsSeenByJoin = 0;
+	std::shared_ptr<Task> first = std::make_shared<Task>([&rootRuns]() { rootRuns++; });
+	std::shared_ptr<Task> second = std::make_shared<Task>([&rootRuns]() { rootRuns++; });
+	std::shared_ptr<Task> join = std::make_shared<Task>([&]() {
+		rootsSeenByJoin = rootRuns.load();
+		joinRuns++;
+	});
+	first->precede(join);
+	second->precede(join);
+
+	std::shared_ptr<TaskCounter> counter = pool.submit({ first, second, join });
+	pool.wait(counter);
+	Check(rootRuns.load() == 2, "root did not run exactly once", iteration);
+	Check(joinRuns.load() == 1, "joining task did not run exactly once", iteration);
+	Check(rootsSeenByJoin.load() == 2, "joining task ran before its roots", iteration);
+	Check(counter->getPending() == 0, "counter did not end at zero", iteration);
+}
+
+int main()
+{
+	ThreadPool pool(4);
+	for (int i = 0; i < THREAD_POOL_TEST_ITERATIONS && !s_Failures; i++)
+	{
+		TestChain(pool, i);
+		TestJoin(pool, i);
+	}
+	pool.join();
+	Check(pool.isCompleted(), "pool has outstanding tasks after join", THREAD_POOL_TEST_ITERATIONS);
+
+	if (s_Failures)
+	{
+		std::cerr << s_Failures << " thread pool checks failed" << std::endl;
+		return 1;
+	}
+	std::cout << "Thread pool checks passed" << std::endl;
+	return 0;
+}